@@ -318,6 +318,9 @@ macro(_gt_setup_targets _config_mode clang_cuda_mode)
         _gt_add_library(${_config_mode} reduction_cpu)
         target_link_libraries(${_gt_namespace}reduction_cpu INTERFACE ${_gt_namespace}gridtools OpenMP::OpenMP_CXX)
 
+        _gt_add_library(${_config_mode} fn_cpu)
+        target_link_libraries(${_gt_namespace}fn_cpu INTERFACE ${_gt_namespace}gridtools OpenMP::OpenMP_CXX)
+
         if(MPI_CXX_FOUND)
             _gt_add_library(${_config_mode} gcl_cpu)
             target_link_libraries(${_gt_namespace}gcl_cpu INTERFACE ${_gt_namespace}gridtools OpenMP::OpenMP_CXX MPI::MPI_CXX)
@@ -332,6 +335,7 @@ macro(_gt_setup_targets _config_mode clang_cuda_mode)
             # workaround for undefind _OPENMP in HIP device code even when OpenMP is enabled
             target_compile_definitions(${_gt_namespace}stencil_cpu_kfirst INTERFACE -DGT_HIP_OPENMP_WORKAROUND)
             target_compile_definitions(${_gt_namespace}stencil_cpu_ifirst INTERFACE -DGT_HIP_OPENMP_WORKAROUND)
+            target_compile_definitions(${_gt_namespace}fn_cpu INTERFACE -DGT_HIP_OPENMP_WORKAROUND)
             if(MPI_CXX_FOUND)
                 target_compile_definitions(${_gt_namespace}gcl_cpu INTERFACE -DGT_HIP_OPENMP_WORKAROUND)
             endif()
@@ -345,6 +349,8 @@ macro(_gt_setup_targets _config_mode clang_cuda_mode)
 
         list(APPEND GT_REDUCTIONS cpu)
 
+        list(APPEND GT_FN_BACKENDS cpu)
+
     endif()
 
     find_package(HPX 1.5.0 QUIET NO_MODULE)
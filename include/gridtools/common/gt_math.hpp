@@ -83,6 +83,16 @@ namespace gridtools {
             return val0 > min(val1, vals...) ? min(val1, vals...) : val0;
         }
 
+        /**
+         * @brief `lhs` if `cond` holds, `rhs` otherwise. Takes the place of the conditional operator in functors that
+         * are also executed on vectors (see stencil/cpu_ifirst/simd.hpp).
+         */
+        template <typename Value0, typename Value1>
+        GT_FUNCTION constexpr std::common_type_t<Value0, Value1> select(
+            bool cond, Value0 const &lhs, Value1 const &rhs) {
+            return cond ? lhs : rhs;
+        }
+
 #if defined(GT_CUDACC) && defined(__NVCC__)
         // providing the same overload pattern as the std library
         // auto return type to ensure that we do not accidentally cast
@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -90,6 +91,40 @@ namespace gridtools {
             return value;
         }
 
+        /**
+         * @brief NUMA node to bind huge page allocations to, from the environment variable GT_HUGEPAGE_NUMA_NODE.
+         * Returns -1 (no binding, pages are placed on first touch) if the variable is not set.
+         */
+        inline int numa_node_from_env() {
+            static const int value = [] {
+                const char *env_value = std::getenv("GT_HUGEPAGE_NUMA_NODE");
+                if (!env_value || !*env_value)
+                    return -1;
+                char *end;
+                long node = std::strtol(env_value, &end, 10);
+                if (*end || node < 0 || node >= 1024) {
+                    std::fprintf(
+                        stderr, "warning: env variable GT_HUGEPAGE_NUMA_NODE set to invalid value '%s'\n", env_value);
+                    return -1;
+                }
+                return (int)node;
+            }();
+            return value;
+        }
+
+        inline void bind_to_numa_node(void *ptr, std::size_t size, int node) {
+#ifdef SYS_mbind
+            if (node < 0)
+                return;
+            constexpr int mpol_bind = 2;
+            constexpr std::size_t bits = 8 * sizeof(unsigned long);
+            unsigned long mask[1024 / bits] = {};
+            mask[node / bits] = 1ul << (node % bits);
+            // like madvise, this is only a hint: on failure the pages are placed on first touch
+            syscall(SYS_mbind, ptr, size, mpol_bind, mask, 1024ul, 0u);
+#endif
+        }
+
         inline std::pair<void *, std::size_t> allocate(std::size_t size, hugepage_mode mode) {
             void *ptr;
             switch (mode) {
@@ -108,6 +143,7 @@ namespace gridtools {
                 if (ptr == MAP_FAILED)
                     throw std::bad_alloc();
                 madvise(ptr, size, MADV_HUGEPAGE);
+                bind_to_numa_node(ptr, size, numa_node_from_env());
                 break;
             case hugepage_mode::explicit_allocation:
                 // here we force huge page allocation (fails with a bus error if none are available)
@@ -120,6 +156,7 @@ namespace gridtools {
                     0);
                 if (ptr == MAP_FAILED)
                     throw std::bad_alloc();
+                bind_to_numa_node(ptr, size, numa_node_from_env());
                 break;
             }
             return {ptr, size};
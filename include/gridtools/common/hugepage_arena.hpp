@@ -0,0 +1,258 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hugepage_alloc.hpp"
+
+namespace gridtools {
+    namespace hugepage_arena_impl_ {
+        /**
+         * @brief Upper bound of the offset by which `hugepage_alloc` shifts its allocations.
+         */
+        inline std::size_t max_allocation_offset() {
+            return hugepage_alloc_impl_::cache_sets() * hugepage_alloc_impl_::cache_line_size();
+        }
+
+        /**
+         * @brief Size of the blocks that serve an allocation of `size` bytes: powers of two from the cache line size
+         * up to half the huge page size. Larger blocks are sized such that, together with the `hugepage_alloc`
+         * offset, they fill a whole number of huge pages.
+         */
+        inline std::size_t bucket_size(std::size_t size) {
+            std::size_t hugepage = hugepage_alloc_impl_::hugepage_size();
+            if (size > hugepage / 2) {
+                std::size_t offset = max_allocation_offset();
+                return (size + offset + hugepage - 1) / hugepage * hugepage - offset;
+            }
+            std::size_t res = hugepage_alloc_impl_::cache_line_size();
+            while (res < size)
+                res *= 2;
+            return res;
+        }
+
+        /**
+         * @brief Whether blocks of the given bucket are carved out of shared huge pages.
+         */
+        inline bool is_small_bucket(std::size_t bucket) { return bucket <= hugepage_alloc_impl_::hugepage_size() / 2; }
+
+        /**
+         * @brief Gap left after a small block to shift the following one to another cache set.
+         */
+        inline std::size_t block_padding(std::size_t bucket) {
+            return bucket >= hugepage_alloc_impl_::page_size() ? hugepage_alloc_impl_::cache_line_size() : 0;
+        }
+
+        /**
+         * @brief Bytes that `hugepage_alloc` mapped for the given pointer.
+         */
+        inline std::size_t mapped_size(void const *ptr) {
+            return static_cast<hugepage_alloc_impl_::ptr_metadata const *>(ptr)[-1].full_size;
+        }
+
+        /**
+         * @brief Pool of huge page memory blocks, bucketed by size.
+         *
+         * Small blocks are carved out of shared huge pages (slabs), larger ones are allocated separately and fill
+         * whole huge pages. Released blocks are kept and reused by the following allocations of the same bucket, thus
+         * repeated allocation patterns (like the temporaries of a stencil run in a time loop) touch the system
+         * allocator only in the first iteration. The memory is not initialized. The blocks are returned to the system
+         * by `trim()` (slabs only once all their blocks are released) or on destruction. All members are thread safe.
+         */
+        class hugepage_arena {
+            struct slab_info {
+                std::size_t blocks = 0;
+                std::size_t free_blocks = 0;
+            };
+
+            mutable std::mutex m_mutex;
+            std::map<std::size_t, std::vector<void *>> m_free_blocks;
+            std::map<char *, slab_info> m_slabs;
+            char *m_slab = nullptr;
+            std::size_t m_slab_used = 0;
+            std::size_t m_usage = 0;
+            std::size_t m_peak_usage = 0;
+            std::size_t m_reserved = 0;
+            std::size_t m_system_allocations = 0;
+
+            static std::size_t slab_size() {
+                return hugepage_alloc_impl_::hugepage_size() - max_allocation_offset();
+            }
+
+            static std::size_t footprint(void *ptr, std::size_t bucket) {
+                return is_small_bucket(bucket) ? bucket + block_padding(bucket) : mapped_size(ptr);
+            }
+
+            slab_info &slab_of(void *ptr) { return std::prev(m_slabs.upper_bound(static_cast<char *>(ptr)))->second; }
+
+            // the following members expect m_mutex to be locked
+
+            void *carve(std::size_t bucket) {
+                std::size_t size = bucket + block_padding(bucket);
+                assert(size <= slab_size());
+                if (!m_slab || m_slab_used + size > slab_size()) {
+                    m_slab = static_cast<char *>(hugepage_alloc(slab_size()));
+                    m_slab_used = 0;
+                    m_slabs.emplace(m_slab, slab_info());
+                    m_reserved += mapped_size(m_slab);
+                    ++m_system_allocations;
+                }
+                void *ptr = m_slab + m_slab_used;
+                m_slab_used += size;
+                ++m_slabs[m_slab].blocks;
+                return ptr;
+            }
+
+            void *use(void *ptr, std::size_t bucket) {
+                m_usage += footprint(ptr, bucket);
+                m_peak_usage = std::max(m_peak_usage, m_usage);
+                return ptr;
+            }
+
+            void release(void *ptr, std::size_t bucket) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free_blocks[bucket].push_back(ptr);
+                m_usage -= footprint(ptr, bucket);
+            }
+
+          public:
+            struct deleter_f {
+                hugepage_arena *m_arena;
+                std::size_t m_size;
+
+                void operator()(char *ptr) const {
+                    if (ptr)
+                        m_arena->release(ptr, m_size);
+                }
+            };
+
+            using ptr_t = std::unique_ptr<char[], deleter_f>;
+
+            hugepage_arena() = default;
+            hugepage_arena(hugepage_arena const &) = delete;
+            hugepage_arena &operator=(hugepage_arena const &) = delete;
+
+            ~hugepage_arena() { trim(); }
+
+            ptr_t allocate(std::size_t size) {
+                std::size_t bucket = bucket_size(size);
+                void *ptr = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto &free_blocks = m_free_blocks[bucket];
+                    if (!free_blocks.empty()) {
+                        ptr = use(free_blocks.back(), bucket);
+                        free_blocks.pop_back();
+                    } else if (is_small_bucket(bucket)) {
+                        ptr = use(carve(bucket), bucket);
+                    }
+                }
+                if (!ptr) {
+                    ptr = hugepage_alloc(bucket);
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_reserved += mapped_size(ptr);
+                    ++m_system_allocations;
+                    use(ptr, bucket);
+                }
+                return {static_cast<char *>(ptr), {this, bucket}};
+            }
+
+            /**
+             * @brief Frees the large blocks that are not in use and the slabs none of whose blocks is in use.
+             */
+            void trim() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto &slab : m_slabs)
+                    slab.second.free_blocks = 0;
+                for (auto &bucket : m_free_blocks) {
+                    if (is_small_bucket(bucket.first))
+                        for (void *ptr : bucket.second)
+                            ++slab_of(ptr).free_blocks;
+                }
+                auto is_unused = [](slab_info const &slab) { return slab.free_blocks == slab.blocks; };
+                for (auto &bucket : m_free_blocks) {
+                    auto &blocks = bucket.second;
+                    if (is_small_bucket(bucket.first)) {
+                        blocks.erase(std::remove_if(blocks.begin(),
+                                         blocks.end(),
+                                         [&](void *ptr) { return is_unused(slab_of(ptr)); }),
+                            blocks.end());
+                        continue;
+                    }
+                    for (void *ptr : blocks) {
+                        m_reserved -= mapped_size(ptr);
+                        hugepage_free(ptr);
+                    }
+                    blocks.clear();
+                }
+                for (auto it = m_slabs.begin(); it != m_slabs.end();) {
+                    if (!is_unused(it->second)) {
+                        ++it;
+                        continue;
+                    }
+                    if (it->first == m_slab)
+                        m_slab = nullptr;
+                    m_reserved -= mapped_size(it->first);
+                    hugepage_free(it->first);
+                    it = m_slabs.erase(it);
+                }
+            }
+
+            /**
+             * @brief Bytes of the blocks that are currently in use, including the padding of small blocks and the
+             * whole huge pages of the large ones.
+             */
+            std::size_t usage() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_usage;
+            }
+
+            /**
+             * @brief Maximum of `usage()` since construction or the last call to `reset_peak_usage()`.
+             */
+            std::size_t peak_usage() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_peak_usage;
+            }
+
+            void reset_peak_usage() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_peak_usage = m_usage;
+            }
+
+            /**
+             * @brief Bytes mapped from the system, used or not.
+             */
+            std::size_t reserved() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_reserved;
+            }
+
+            /**
+             * @brief Number of slabs and large blocks that were allocated from the system.
+             */
+            std::size_t system_allocations() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_system_allocations;
+            }
+        };
+    } // namespace hugepage_arena_impl_
+
+    using hugepage_arena_impl_::hugepage_arena;
+} // namespace gridtools
@@ -92,10 +92,21 @@ namespace gridtools {
             using type = layout_map<Layout::at(Is)...>;
         };
 
+        template <class>
+        struct append_innermost;
+
+        template <int... Is>
+        struct append_innermost<layout_map<Is...>> {
+            using type = layout_map<Is..., (int)layout_map<Is...>::unmasked_length>;
+        };
+
     } // namespace layout_map_impl
     using layout_map_impl::layout_map;
     template <class T>
     using reverse_map = typename layout_map_impl::reverse_map<T>::type;
     template <class T, class U>
     using layout_transform = typename layout_map_impl::layout_transform<T, U>::type;
+    /** @brief The layout `T` with an extra trailing dimension that is the innermost one (stride one). */
+    template <class T>
+    using append_innermost = typename layout_map_impl::append_innermost<T>::type;
 } // namespace gridtools
@@ -0,0 +1,24 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+namespace gridtools {
+    /**
+     * @brief Size in bytes of the vector registers of the host target.
+     */
+    constexpr int vector_register_bytes =
+#if defined(__AVX512F__)
+        64;
+#elif defined(__AVX__)
+        32;
+#else
+        16;
+#endif
+} // namespace gridtools
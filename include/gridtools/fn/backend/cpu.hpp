@@ -0,0 +1,482 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/for_each.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/int_vector.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../common/vector_register_bytes.hpp"
+#include "../../meta.hpp"
+#include "../../sid/allocator.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/contiguous.hpp"
+#include "../../sid/multi_shift.hpp"
+#include "../../sid/unknown_kind.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/dummy.hpp"
+#include "../../thread_pool/omp.hpp"
+#include "../column_stage.hpp"
+#include "../extents.hpp"
+#include "./common.hpp"
+#include "./tmp_arena.hpp"
+
+namespace gridtools::fn::backend {
+    namespace cpu_impl_ {
+        template <class KeyValuePair, class = void>
+        struct is_valid_size_key_value_pair : std::false_type {};
+
+        template <template <class...> class List, class Key, class Value>
+        struct is_valid_size_key_value_pair<List<Key, Value>,
+            std::enable_if_t<is_integral_constant<Value>::value && (Value::value > 0)>> : std::true_type {};
+
+        template <class Sizes>
+        using is_valid_sizes =
+            std::bool_constant<meta::is_list<Sizes>::value &&
+                               meta::all<meta::transform<is_valid_size_key_value_pair, Sizes>>::value>;
+
+        using default_thread_pool =
+#if defined(_OPENMP) || defined(GT_HIP_OPENMP_WORKAROUND)
+            thread_pool::omp;
+#else
+            thread_pool::dummy;
+#endif
+
+        /*
+         * LoopBlockSizes and UnrollFactors must be meta maps, mapping dimensions to integral constants.
+         *
+         * LoopBlockSizes defines the size of the blocks into which the domain is decomposed along each dimension, the
+         * blocks are distributed to the threads of the ThreadPool. Dimensions without block size are not blocked.
+         * UnrollFactors defines how many times the loops inside of a block are unrolled along each dimension, the
+         * default is no unrolling.
+         *
+         * Inside of a block, the loop along the last dimension of the domain is the innermost one. For stencil stages
+         * it is a vector loop, thus the last dimension should have unit stride (as with the cpu_kfirst storage
+         * layout). Unroll factors apply to the other loops only.
+         *
+         * For example, meta::list<meta::list<dim::i, integral_constant<int, 8>>,
+         *                         meta::list<dim::j, integral_constant<int, 8>>>;
+         * When using a cartesian grid.
+         *
+         * Column stages compute groups of ColumnWidth neighbouring columns in lock-step, the vector loop goes over the
+         * columns of a group. The columns of a group are taken along the first horizontal dimension along which all
+         * data has unit (or zero) stride known at compile time, like i with the cpu_ifirst storage layout. Without
+         * such a dimension (as with the cpu_kfirst layout, where the vertical dimension has unit stride) and for
+         * the columns that don't fill a group, the columns are computed one after the other. The default
+         * ColumnWidth of zero stands for the number of the largest accumulator values that fit in four vector
+         * registers: a single register per scan is bound by the latency of the vertical dependency chain, some
+         * independent registers hide it. One gives scalar columns.
+         */
+        template <class LoopBlockSizes = meta::list<>,
+            class UnrollFactors = meta::list<>,
+            class ThreadPool = default_thread_pool,
+            int ColumnWidth = 0>
+        struct cpu {
+            using loop_block_sizes_t = LoopBlockSizes;
+            using unroll_factors_t = UnrollFactors;
+            using thread_pool_t = ThreadPool;
+            static constexpr int column_width = ColumnWidth;
+
+            static_assert(is_valid_sizes<LoopBlockSizes>::value, "invalid loop block sizes");
+            static_assert(is_valid_sizes<UnrollFactors>::value, "invalid unroll factors");
+            static_assert(ColumnWidth >= 0, "invalid column width");
+        };
+
+        // dimensions that are missing in the map get the default value; block size zero stands for no blocking
+        template <class Map, int Default>
+        struct value_at_dim {
+            template <class Dim>
+            using apply = meta::mp_find<Map, Dim, meta::list<Dim, integral_constant<int, Default>>>;
+        };
+
+        template <class Map, int Default, class Dims>
+        using values_for_dims =
+            hymap::from_meta_map<meta::transform<value_at_dim<Map, Default>::template apply, Dims>>;
+
+        struct num_blocks_f {
+            template <class BlockSize, class Size>
+            int operator()(BlockSize, Size size) const {
+                if constexpr (BlockSize::value == 0)
+                    return 1;
+                else
+                    return (size + BlockSize::value - 1) / BlockSize::value;
+            }
+        };
+
+        struct block_offset_f {
+            template <class BlockSize>
+            int operator()(int block, BlockSize) const {
+                return block * BlockSize::value;
+            }
+        };
+
+        struct block_size_f {
+            template <class BlockSize, class Size>
+            int operator()(int offset, BlockSize, Size size) const {
+                if constexpr (BlockSize::value == 0)
+                    return size;
+                else
+                    return std::min(int(BlockSize::value), size - offset);
+            }
+        };
+
+        // loop with unit step along `Dim`, written out to be vectorized
+        template <class Dim, class Fun>
+        struct vector_loop_f {
+            Fun m_fun;
+            int m_size;
+
+            template <class Ptr, class Strides>
+            GT_FORCE_INLINE void operator()(Ptr &ptr, Strides const &strides) const {
+                using namespace literals;
+                auto &&stride = sid::get_stride<Dim>(strides);
+#pragma omp simd
+                for (int i = 0; i < m_size; ++i) {
+                    m_fun(ptr, strides);
+                    sid::shift(ptr, stride, 1_c);
+                }
+                sid::shift(ptr, stride, -m_size);
+            }
+        };
+
+        /*
+         * Calls `fun(ptr, strides)` for every point of a block of the given sizes. The loop along the last dimension
+         * is a vector loop if `Vectorize` is set.
+         */
+        template <bool Vectorize, class UnrollFactors, class Dims, class Sizes, class Fun, class Ptr, class Strides>
+        GT_FORCE_INLINE void block_loops(Sizes const &sizes, Fun const &fun, Ptr &ptr, Strides const &strides) {
+            using unroll_factors_t = values_for_dims<UnrollFactors, 1, Dims>;
+            if constexpr (Vectorize) {
+                using inner_dim_t = meta::last<Dims>;
+                auto inner = vector_loop_f<inner_dim_t, Fun>{fun, int(at_key<inner_dim_t>(sizes))};
+                common::make_unrolled_loops<meta::pop_back<Dims>>(sizes, unroll_factors_t())(inner)(ptr, strides);
+            } else {
+                common::make_unrolled_loops<Dims>(sizes, unroll_factors_t())(fun)(ptr, strides);
+            }
+        }
+
+        /*
+         * Decomposes the domain given by `sizes` into blocks of `LoopBlockSizes`, which are processed in parallel:
+         * `fun(offsets, block_sizes)` is called for every block.
+         */
+        template <class LoopBlockSizes, class ThreadPool, class Sizes, class Fun>
+        void parallel_blocks(Sizes const &sizes, Fun const &fun) {
+            using dims_t = get_keys<Sizes>;
+            using keys_t = meta::rename<hymap::keys, dims_t>;
+            using block_sizes_t = values_for_dims<LoopBlockSizes, 0, dims_t>;
+            static_assert(meta::length<dims_t>::value > 0);
+
+            auto block_loop = [&](auto... blocks) {
+                auto offsets = tuple_util::transform(block_offset_f(), keys_t::make_values(blocks...), block_sizes_t());
+                auto block_sizes = tuple_util::transform(block_size_f(), offsets, block_sizes_t(), sizes);
+                fun(offsets, block_sizes);
+            };
+            tuple_util::apply(
+                [&](auto... num_blocks) { thread_pool::parallel_for_loop(ThreadPool(), block_loop, num_blocks...); },
+                tuple_util::transform(num_blocks_f(), block_sizes_t(), sizes));
+        }
+
+        template <class LoopBlockSizes,
+            class UnrollFactors,
+            class ThreadPool,
+            bool Vectorize,
+            class Sizes,
+            class Ptr,
+            class Strides,
+            class Fun>
+        void blocked_loops(Sizes const &sizes, Ptr const &ptr, Strides const &strides, Fun const &fun) {
+            using dims_t = get_keys<Sizes>;
+            if constexpr (meta::length<dims_t>::value == 0) {
+                auto local_ptr = ptr;
+                fun(local_ptr, strides);
+            } else {
+                parallel_blocks<LoopBlockSizes, ThreadPool>(sizes, [&](auto const &offsets, auto const &block_sizes) {
+                    auto local_ptr = ptr;
+                    sid::multi_shift(local_ptr, strides, offsets);
+                    block_loops<Vectorize, UnrollFactors, dims_t>(block_sizes, fun, local_ptr, strides);
+                });
+            }
+        }
+
+        template <class StencilStage, class Iterator>
+        struct stencil_fun_f {
+            Iterator m_make_iterator;
+
+            template <class Ptr, class Strides>
+            GT_FORCE_INLINE void operator()(Ptr &ptr, Strides const &strides) const {
+                StencilStage()(m_make_iterator, ptr, strides);
+            }
+        };
+
+        template <class LoopBlockSizes,
+            class UnrollFactors,
+            class ThreadPool,
+            int ColumnWidth,
+            class Sizes,
+            class StencilStage,
+            class MakeIterator,
+            class Composite>
+        void apply_stencil_stage(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>,
+            Sizes const &sizes,
+            StencilStage,
+            MakeIterator &&make_iterator,
+            Composite &&composite) {
+            auto ptr = sid::get_origin(std::forward<Composite>(composite))();
+            auto strides = sid::get_strides(std::forward<Composite>(composite));
+            blocked_loops<LoopBlockSizes, UnrollFactors, ThreadPool, true>(
+                sizes, ptr, strides, stencil_fun_f<StencilStage, decltype(make_iterator())>{make_iterator()});
+        }
+
+        template <class ColumnStage, class Iterator, class Seed>
+        struct column_fun_f {
+            Iterator m_make_iterator;
+            Seed m_seed;
+            int m_v_size;
+
+            template <class Ptr, class Strides>
+            void operator()(Ptr const &ptr, Strides const &strides) const {
+                ColumnStage()(m_seed, m_v_size, m_make_iterator, ptr, strides);
+            }
+        };
+
+        template <class T, class = void>
+        struct max_value_size : std::integral_constant<std::size_t, sizeof(T)> {};
+
+        template <class... Ts>
+        struct max_value_size<meta::list<Ts...>>
+            : std::integral_constant<std::size_t, std::max({std::size_t(1), max_value_size<Ts>::value...})> {};
+
+        template <class T>
+        struct max_value_size<T, std::enable_if_t<tuple_util::is_tuple_like<T>::value>>
+            : max_value_size<meta::rename<meta::list, tuple_util::traits::to_types<T>>> {};
+
+        // the number of columns that are computed in lock-step, see `cpu`
+        template <int ColumnWidth, class Seed>
+        constexpr int column_width =
+            ColumnWidth ? ColumnWidth : std::max(1, int(4 * vector_register_bytes / max_value_size<Seed>::value));
+
+        template <class Ptr, class Strides>
+        struct is_lane_dim_f {
+            template <class Dim>
+            struct stride_f {
+                template <class Key>
+                using apply =
+                    std::decay_t<decltype(sid::get_stride_element<Key, Dim>(std::declval<Strides const &>()))>;
+            };
+
+            template <class Stride>
+            using is_unit = is_integral_constant_of<Stride, 1>;
+
+            template <class Stride>
+            using is_unit_or_zero = std::disjunction<is_integral_constant_of<Stride, 0>, is_unit<Stride>>;
+
+            // all data has unit or zero stride along `Dim`, some has unit stride
+            template <class Dim, class DimStrides = meta::transform<stride_f<Dim>::template apply, get_keys<Ptr>>>
+            using apply =
+                std::conjunction<meta::all_of<is_unit_or_zero, DimStrides>, meta::any_of<is_unit, DimStrides>>;
+        };
+
+        template <class Dim>
+        struct is_not_dim_f {
+            template <class T>
+            using apply = std::negation<std::is_same<T, Dim>>;
+        };
+
+        // loop along `Dim` over groups of `Width` columns that are computed in lock-step, the remaining columns are
+        // computed one by one
+        template <int Width, class Dim, class ColumnStage, class Iterator, class Seed>
+        struct column_group_loop_f {
+            Iterator m_make_iterator;
+            Seed m_seed;
+            int m_v_size;
+            int m_size;
+
+            template <class Ptr, class Strides>
+            void operator()(Ptr const &ptr, Strides const &strides) const {
+                using namespace literals;
+                auto &&stride = sid::get_stride<Dim>(strides);
+                auto seeds = fill_lanes<Width>(m_seed);
+                auto group_ptr = ptr;
+                int i = 0;
+                for (; i + Width <= m_size; i += Width) {
+                    ColumnStage().template columns<Width, Dim>(seeds, m_v_size, m_make_iterator, group_ptr, strides);
+                    sid::shift(group_ptr, stride, integral_constant<int, Width>());
+                }
+                for (; i < m_size; ++i) {
+                    ColumnStage()(m_seed, m_v_size, m_make_iterator, group_ptr, strides);
+                    sid::shift(group_ptr, stride, 1_c);
+                }
+            }
+        };
+
+        template <class LoopBlockSizes,
+            class UnrollFactors,
+            class ThreadPool,
+            int ColumnWidth,
+            class Sizes,
+            class ColumnStage,
+            class MakeIterator,
+            class Composite,
+            class Vertical,
+            class Seed>
+        void apply_column_stage(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>,
+            Sizes const &sizes,
+            ColumnStage,
+            MakeIterator &&make_iterator,
+            Composite &&composite,
+            Vertical,
+            Seed seed) {
+            auto ptr = sid::get_origin(std::forward<Composite>(composite))();
+            auto strides = sid::get_strides(std::forward<Composite>(composite));
+            int v_size = at_key<Vertical>(sizes);
+            // the vertical dimension is never blocked
+            auto h_sizes = hymap::canonicalize_and_remove_key<Vertical>(sizes);
+            using dims_t = get_keys<decltype(h_sizes)>;
+            using lane_dims_t = meta::filter<is_lane_dim_f<decltype(ptr), decltype(strides)>::template apply, dims_t>;
+            constexpr int width = column_width<ColumnWidth, Seed>;
+            if constexpr (width == 1 || meta::length<lane_dims_t>::value == 0) {
+                blocked_loops<LoopBlockSizes, UnrollFactors, ThreadPool, false>(h_sizes,
+                    ptr,
+                    strides,
+                    column_fun_f<ColumnStage, decltype(make_iterator()), Seed>{
+                        make_iterator(), std::move(seed), v_size});
+            } else {
+                using lane_dim_t = meta::first<lane_dims_t>;
+                using outer_dims_t = meta::filter<is_not_dim_f<lane_dim_t>::template apply, dims_t>;
+                parallel_blocks<LoopBlockSizes, ThreadPool>(h_sizes, [&](auto const &offsets, auto const &block_sizes) {
+                    auto local_ptr = ptr;
+                    sid::multi_shift(local_ptr, strides, offsets);
+                    block_loops<false, UnrollFactors, outer_dims_t>(block_sizes,
+                        column_group_loop_f<width, lane_dim_t, ColumnStage, decltype(make_iterator()), Seed>{
+                            make_iterator(), seed, v_size, int(at_key<lane_dim_t>(block_sizes))},
+                        local_ptr,
+                        strides);
+                });
+            }
+        }
+
+        // the dimension along which the tile temporaries of the threads are stored
+        struct tile_thread_dim {};
+
+        struct max_block_size_f {
+            template <class BlockSize, class Size>
+            int operator()(BlockSize, Size size) const {
+                if constexpr (BlockSize::value == 0)
+                    return size;
+                else
+                    return std::min(int(BlockSize::value), int(size));
+            }
+        };
+
+        // a tile temporary holds one block plus extents per thread
+        template <class LoopBlockSizes,
+            class UnrollFactors,
+            class ThreadPool,
+            int ColumnWidth,
+            class Allocator,
+            class Sizes,
+            class T,
+            class Extents>
+        auto allocate_tile_tmp(
+            std::tuple<cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>, Allocator> &alloc,
+            Sizes const &sizes,
+            data_type<T>,
+            Extents) {
+            using block_sizes_t = values_for_dims<LoopBlockSizes, 0, get_keys<Sizes>>;
+            auto tile_sizes = extend_sizes<Extents>(tuple_util::transform(max_block_size_f(), block_sizes_t(), sizes));
+            return sid::make_contiguous<T, int_t, sid::unknown_kind>(std::get<1>(alloc),
+                hymap::concat(std::move(tile_sizes),
+                    hymap::keys<tile_thread_dim>::make_values(thread_pool::get_max_threads(ThreadPool()))));
+        }
+
+        /*
+         * Computes all the stages block by block. `Stages` pairs the stages with the extents of the region around the
+         * block on which they are computed, `TileTmps` maps the tile temporaries to their extents. The tile
+         * temporaries of a thread start at the first point of the block extended by their extents.
+         */
+        template <class LoopBlockSizes,
+            class UnrollFactors,
+            class ThreadPool,
+            int ColumnWidth,
+            class Sizes,
+            class Stages,
+            class TileTmps,
+            class MakeIterator,
+            class Composite>
+        void apply_tiled_stencil_stages(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>,
+            Sizes const &sizes,
+            Stages,
+            TileTmps,
+            MakeIterator const &make_iterator,
+            Composite &composite) {
+            using dims_t = get_keys<Sizes>;
+            auto origin = sid::get_origin(composite)();
+            auto strides = sid::get_strides(composite);
+            auto iterator = make_iterator();
+            parallel_blocks<LoopBlockSizes, ThreadPool>(sizes, [&](auto const &offsets, auto const &block_sizes) {
+                int thread = thread_pool::get_thread_num(ThreadPool());
+                for_each<Stages>([&](auto stage) {
+                    using namespace int_vector::arithmetic;
+                    using extents_t = meta::second<decltype(stage)>;
+                    auto ptr = origin;
+                    sid::multi_shift(ptr, strides, extend_offsets<extents_t>(offsets));
+                    for_each<TileTmps>([&](auto tmp) {
+                        using key_t = meta::first<decltype(tmp)>;
+                        auto tmp_ptr = origin;
+                        sid::shift(tmp_ptr, sid::get_stride<tile_thread_dim>(strides), thread);
+                        sid::multi_shift(
+                            tmp_ptr, strides, extents_t::offsets() - meta::second<decltype(tmp)>::offsets());
+                        at_key<key_t>(ptr) = at_key<key_t>(tmp_ptr);
+                    });
+                    block_loops<true, UnrollFactors, dims_t>(extend_sizes<extents_t>(block_sizes),
+                        stencil_fun_f<meta::first<decltype(stage)>, decltype(iterator)>{iterator},
+                        ptr,
+                        strides);
+                });
+            });
+        }
+
+        template <class LoopBlockSizes, class UnrollFactors, class ThreadPool, int ColumnWidth>
+        auto tmp_allocator(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth> be) {
+            return std::make_tuple(be, make_arena_allocator());
+        }
+
+        template <class LoopBlockSizes,
+            class UnrollFactors,
+            class ThreadPool,
+            int ColumnWidth,
+            class Allocator,
+            class Sizes,
+            class T>
+        auto allocate_global_tmp(
+            std::tuple<cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>, Allocator> &alloc,
+            Sizes const &sizes,
+            data_type<T>) {
+            return sid::make_contiguous<T, int_t, sid::unknown_kind>(std::get<1>(alloc), sizes);
+        }
+    } // namespace cpu_impl_
+
+    using cpu_impl_::cpu;
+
+    using cpu_impl_::apply_column_stage;
+    using cpu_impl_::apply_stencil_stage;
+
+    using cpu_impl_::apply_tiled_stencil_stages;
+
+    using cpu_impl_::allocate_global_tmp;
+    using cpu_impl_::allocate_tile_tmp;
+    using cpu_impl_::tmp_allocator;
+} // namespace gridtools::fn::backend
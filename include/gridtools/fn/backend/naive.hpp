@@ -21,6 +21,7 @@
 #include "../../thread_pool/dummy.hpp"
 #include "../../thread_pool/omp.hpp"
 #include "./common.hpp"
+#include "./tmp_arena.hpp"
 
 namespace gridtools::fn::backend {
     namespace naive_impl_ {
@@ -90,7 +91,7 @@ namespace gridtools::fn::backend {
 
         template <class ThreadPool>
         inline auto tmp_allocator(naive_with_threadpool<ThreadPool> be) {
-            return std::make_tuple(be, sid::allocator(&std::make_unique<char[]>));
+            return std::make_tuple(be, make_arena_allocator());
         }
 
         template <class ThreadPool, class Allocator, class Sizes, class T>
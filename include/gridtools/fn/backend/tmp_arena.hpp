@@ -0,0 +1,38 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "../../common/hugepage_arena.hpp"
+#include "../../sid/allocator.hpp"
+
+namespace gridtools::fn::backend {
+    namespace tmp_arena_impl_ {
+        /*
+         * The arena from which the host backends allocate their temporaries. The temporaries of a run go back to the
+         * arena at the end of the run, thus the following runs of the same stencils don't allocate from the system.
+         * Its `peak_usage()` is the memory footprint of the temporaries.
+         */
+        inline hugepage_arena &tmp_arena() {
+            static hugepage_arena arena;
+            return arena;
+        }
+
+        struct arena_allocation_f {
+            auto operator()(std::size_t size) const { return tmp_arena().allocate(size); }
+        };
+
+        inline auto make_arena_allocator() { return sid::allocator(arena_allocation_f()); }
+    } // namespace tmp_arena_impl_
+
+    using tmp_arena_impl_::make_arena_allocator;
+    using tmp_arena_impl_::tmp_arena;
+} // namespace gridtools::fn::backend
@@ -33,6 +33,51 @@ namespace gridtools::fn {
         template <class T>
         using is_scan_pass = meta::is_instantiation_of<scan_pass, T>;
 
+        /*
+         * The accumulators of `Width` columns, stored as structure of arrays: tuple-like accumulators are kept as a
+         * tuple of `lanes`, the others as an array. The values of one element thus are contiguous and the vector loop
+         * over the columns loads and stores them as a vector. `set` takes its argument by value: a temporary that is
+         * bound to a reference in the body of an `omp simd` loop gets privatized into an array of structures, which
+         * GCC fails to vectorize.
+         */
+        template <class T, int Width, class = void>
+        struct lanes {
+            T m_values[Width];
+
+            GT_FORCE_INLINE T get(int i) const { return m_values[i]; }
+            GT_FORCE_INLINE void set(int i, T value) { m_values[i] = value; }
+        };
+
+        template <int Width>
+        struct make_lanes_f {
+            template <class T>
+            lanes<T, Width> operator()(T const &) const;
+        };
+
+        template <class T, int Width>
+        struct lanes<T, Width, std::enable_if_t<tuple_util::is_tuple_like<T>::value>> {
+            decltype(tuple_util::transform(make_lanes_f<Width>(), std::declval<T const &>())) m_elements;
+
+            template <std::size_t... Is>
+            GT_FORCE_INLINE T get(int i, std::index_sequence<Is...>) const {
+                return {tuple_util::get<Is>(m_elements).get(i)...};
+            }
+            GT_FORCE_INLINE T get(int i) const {
+                return get(i, std::make_index_sequence<tuple_util::size<T>::value>());
+            }
+            GT_FORCE_INLINE void set(int i, T value) {
+                tuple_util::for_each([i](auto &element, auto const &v) { element.set(i, v); }, m_elements, value);
+            }
+        };
+
+        template <int Width, class T>
+        lanes<T, Width> fill_lanes(T const &value) {
+            lanes<T, Width> res;
+            for (int i = 0; i < Width; ++i)
+                res.set(i, value);
+            return res;
+        }
+
         template <bool IsBackward>
         struct base : std::bool_constant<IsBackward> {
             static GT_FUNCTION constexpr auto prologue() { return tuple<>(); }
@@ -44,6 +89,23 @@ namespace gridtools::fn {
 
         template <class Vertical, class ScanOrFold, int Out, int... Ins>
         struct column_stage {
+            template <class Acc, class Pass, class MakeIterator, class Ptr, class Strides>
+            static GT_FUNCTION auto apply_pass(
+                Acc acc, Pass const &pass, MakeIterator &&make_iterator, Ptr const &ptr, Strides const &strides) {
+                if constexpr (is_scan_pass<Pass>()) {
+                    // scan
+                    auto res = pass.m_f(std::move(acc), make_iterator(integral_constant<int, Ins>(), ptr, strides)...);
+                    *host_device::at_key<integral_constant<int, Out>>(ptr) = pass.m_p(res);
+                    return res;
+                } else {
+                    // fold
+                    return pass(std::move(acc), make_iterator(integral_constant<int, Ins>(), ptr, strides)...);
+                }
+                // disable incorrect warning "missing return statement at end of non-void function"
+                GT_NVCC_DIAG_PUSH_SUPPRESS(940)
+            }
+            GT_NVCC_DIAG_POP_SUPPRESS(940)
+
             template <class Seed, class MakeIterator, class Ptr, class Strides>
             GT_FUNCTION auto operator()(
                 Seed seed, std::size_t size, MakeIterator &&make_iterator, Ptr ptr, Strides const &strides) const {
@@ -54,25 +116,11 @@ namespace gridtools::fn {
                 GT_NVCC_DIAG_POP_SUPPRESS(186)
                 using step_t = integral_constant<int, ScanOrFold::value ? -1 : 1>;
                 auto const &v_stride = sid::get_stride<Vertical>(strides);
-                auto inc = [&] { sid::shift(ptr, v_stride, step_t()); };
                 auto next = [&](auto acc, auto pass) {
-                    if constexpr (is_scan_pass<decltype(pass)>()) {
-                        // scan
-                        auto res =
-                            pass.m_f(std::move(acc), make_iterator(integral_constant<int, Ins>(), ptr, strides)...);
-                        *host_device::at_key<integral_constant<int, Out>>(ptr) = pass.m_p(res);
-                        inc();
-                        return res;
-                    } else {
-                        // fold
-                        auto res = pass(std::move(acc), make_iterator(integral_constant<int, Ins>(), ptr, strides)...);
-                        inc();
-                        return res;
-                    }
-                    // disable incorrect warning "missing return statement at end of non-void function"
-                    GT_NVCC_DIAG_PUSH_SUPPRESS(940)
+                    auto res = apply_pass(std::move(acc), pass, make_iterator, ptr, strides);
+                    sid::shift(ptr, v_stride, step_t());
+                    return res;
                 };
-                GT_NVCC_DIAG_POP_SUPPRESS(940)
                 if constexpr (ScanOrFold::value)
                     sid::shift(ptr, v_stride, size - 1);
                 auto acc = tuple_util::host_device::fold(next, std::move(seed), ScanOrFold::prologue());
@@ -81,6 +129,42 @@ namespace gridtools::fn {
                     acc = next(std::move(acc), ScanOrFold::body());
                 return tuple_util::host_device::fold(next, std::move(acc), ScanOrFold::epilogue());
             }
+
+            /*
+             * Computes `Width` neighbouring columns along `Lane` in lock-step. One level of all columns is a vector
+             * loop over the columns, which runs along contiguous memory if `Lane` has unit stride.
+             */
+            template <int Width, class Lane, class Seed, class MakeIterator, class Ptr, class Strides>
+            auto columns(lanes<Seed, Width> const &seeds,
+                std::size_t size,
+                MakeIterator &&make_iterator,
+                Ptr ptr,
+                Strides const &strides) const {
+                constexpr std::size_t prologue_size = std::tuple_size_v<decltype(ScanOrFold::prologue())>;
+                constexpr std::size_t epilogue_size = std::tuple_size_v<decltype(ScanOrFold::epilogue())>;
+                assert(size >= prologue_size + epilogue_size);
+                using step_t = integral_constant<int, ScanOrFold::value ? -1 : 1>;
+                auto const &v_stride = sid::get_stride<Vertical>(strides);
+                auto const &lane_stride = sid::get_stride<Lane>(strides);
+                auto next = [&](auto const &accs, auto pass) {
+                    lanes<decltype(apply_pass(accs.get(0), pass, make_iterator, ptr, strides)), Width> res;
+#pragma omp simd
+                    for (int i = 0; i < Width; ++i) {
+                        res.set(i, apply_pass(accs.get(i), pass, make_iterator, ptr, strides));
+                        sid::shift(ptr, lane_stride, integral_constant<int, 1>());
+                    }
+                    sid::shift(ptr, lane_stride, integral_constant<int, -Width>());
+                    sid::shift(ptr, v_stride, step_t());
+                    return res;
+                };
+                if constexpr (ScanOrFold::value)
+                    sid::shift(ptr, v_stride, size - 1);
+                auto accs = tuple_util::fold(next, seeds, ScanOrFold::prologue());
+                std::size_t n = size - prologue_size - epilogue_size;
+                for (std::size_t i = 0; i < n; ++i)
+                    accs = next(accs, ScanOrFold::body());
+                return tuple_util::fold(next, std::move(accs), ScanOrFold::epilogue());
+            }
         };
 
         template <class... ColumnStages>
@@ -95,12 +179,29 @@ namespace gridtools::fn {
                     std::move(seed),
                     tuple(ColumnStages()...));
             }
+
+            template <int Width, class Lane, class Seed, class MakeIterator, class Ptr, class Strides>
+            auto columns(lanes<Seed, Width> const &seeds,
+                std::size_t size,
+                MakeIterator &&make_iterator,
+                Ptr const &ptr,
+                Strides const &strides) const {
+                return tuple_util::fold(
+                    [&](auto const &accs, auto stage) {
+                        return stage.template columns<Width, Lane>(
+                            accs, size, std::forward<MakeIterator>(make_iterator), ptr, strides);
+                    },
+                    seeds,
+                    tuple(ColumnStages()...));
+            }
         };
     } // namespace column_stage_impl_
 
     using column_stage_impl_::bwd;
     using column_stage_impl_::column_stage;
+    using column_stage_impl_::fill_lanes;
     using column_stage_impl_::fwd;
+    using column_stage_impl_::lanes;
     using column_stage_impl_::merged_column_stage;
 
 #if GT_NVCC_WORKAROUND_1766
@@ -36,10 +36,19 @@ namespace gridtools::fn {
             using arg_offset_t = std::integral_constant<int, ArgOffset>;
             using specs_t = Specs;
 
+            // tile temporaries are allocated by the backend on the domain, thus they are not shifted
+            template <class Arg>
+            auto shifted(Arg &&arg) const {
+                if constexpr (is_tile_tmp_arg<std::decay_t<Arg>>::value)
+                    return arg;
+                else
+                    return sid::shift_sid_origin(std::forward<Arg>(arg), m_offsets);
+            }
+
             template <class Arg>
             auto arg(Arg &&arg) && {
-                auto args = tuple_util::deep_copy(
-                    tuple_util::push_back(std::move(m_args), sid::shift_sid_origin(std::forward<Arg>(arg), m_offsets)));
+                auto args =
+                    tuple_util::deep_copy(tuple_util::push_back(std::move(m_args), shifted(std::forward<Arg>(arg))));
                 return executor_data<Backend, ArgOffset, Sizes, Offsets, MakeIterator, decltype(args), Specs>{
                     std::move(m_backend),
                     std::move(m_sizes),
@@ -78,12 +87,20 @@ namespace gridtools::fn {
                 return stencil_executor<decltype(data)>{std::move(data)};
             }
 
+            // consecutive assignments are fused into one sweep where possible, see fuse_stencil_stages
             void execute() && {
-                run_stencil_stages(std::move(m_data.m_backend),
-                    typename Data::specs_t(),
-                    std::move(m_data.m_make_iterator),
-                    std::move(m_data.m_sizes),
-                    std::move(m_data.m_args));
+                if constexpr (has_tile_tmps<decltype(m_data.m_args)>::value)
+                    run_tiled_stencil_stages(std::move(m_data.m_backend),
+                        typename Data::specs_t(),
+                        std::move(m_data.m_make_iterator),
+                        std::move(m_data.m_sizes),
+                        std::move(m_data.m_args));
+                else
+                    run_stencil_stages(std::move(m_data.m_backend),
+                        fuse_stencil_stages<typename Data::specs_t>(),
+                        std::move(m_data.m_make_iterator),
+                        std::move(m_data.m_sizes),
+                        std::move(m_data.m_args));
             }
         };
 
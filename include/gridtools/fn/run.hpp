@@ -9,9 +9,16 @@
  */
 #pragma once
 
+#include <type_traits>
+#include <utility>
+
+#include "../common/int_vector.hpp"
 #include "../common/tuple_util.hpp"
 #include "../meta.hpp"
 #include "../sid/composite.hpp"
+#include "../sid/sid_shift_origin.hpp"
+#include "./backend/common.hpp"
+#include "./extents.hpp"
 #include "./stencil_stage.hpp"
 
 namespace gridtools::fn {
@@ -56,8 +63,183 @@ namespace gridtools::fn {
                 meta::rename<std::tuple, StageSpecs>(),
                 std::forward<Seeds>(seeds));
         }
+
+        /*
+         * Tile temporaries
+         *
+         * A tile temporary is an argument of a stencil executor that is written and read by the stages of the same
+         * execution only. The stages that write it are computed on the domain extended by `Extents`, which has to
+         * enclose the offsets at which the later stages read the temporary (including the extents of later
+         * temporaries that are computed from it). The other stages are computed on the domain.
+         *
+         * Backends with support for tiles (cpu) compute all the stages tile by tile, with tile temporaries in
+         * per-thread scratch buffers of the size of a tile plus extents; the points of the extents are computed
+         * redundantly by neighbouring tiles. The other backends compute them stage by stage into temporaries of the
+         * size of the extended domain. So do the backends with tiles if a stage reads the output of another stage
+         * (other than a tile temporary) outside of its tile, see `is_tiling_safe`.
+         */
+        template <class T, class Extents>
+        struct tile_tmp_arg {
+            static_assert(is_extents<Extents>::value);
+            using type = T;
+            using extents_t = Extents;
+        };
+
+        /*
+         * A tile temporary of type T to be passed to `arg` of a stencil executor, the stages that write it are
+         * computed on the domain extended by `Extents`:
+         *
+         *     executor().arg(out).arg(in).arg(tile_tmp<double>(extents<extent<dim::i, -1, 1>>())) ...
+         */
+        template <class T, class Extents = extents<>>
+        tile_tmp_arg<T, Extents> tile_tmp(Extents = {}) {
+            return {};
+        }
+
+        template <class>
+        struct is_tile_tmp_arg : std::false_type {};
+
+        template <class T, class Extents>
+        struct is_tile_tmp_arg<tile_tmp_arg<T, Extents>> : std::true_type {};
+
+        template <class Arg>
+        using is_tile_tmp_arg_item = is_tile_tmp_arg<meta::second<Arg>>;
+
+        template <class Arg>
+        using tile_tmp_extents_item = meta::list<meta::first<Arg>, meta::second<meta::second<Arg>>>;
+
+        template <class Args>
+        using has_tile_tmps = meta::any_of<is_tile_tmp_arg, tuple_util::traits::to_types<std::decay_t<Args>>>;
+
+        // maps the composite keys of the tile temporaries to their extents
+        template <class Args,
+            class Types = tuple_util::traits::to_types<std::decay_t<Args>>,
+            class Keys = meta::iseq_to_list<std::make_integer_sequence<int, meta::length<Types>::value>,
+                meta::list,
+                integral_constant>>
+        using tile_tmps_extents =
+            meta::transform<tile_tmp_extents_item, meta::filter<is_tile_tmp_arg_item, meta::zip<Keys, Types>>>;
+
+        // pairs a stage with the extents of the domain on which it is computed
+        template <class TileTmps, class Stage>
+        struct stage_with_extents;
+
+        template <class TileTmps, class Stencil, int Out, int... Ins>
+        struct stage_with_extents<TileTmps, stencil_stage<Stencil, Out, Ins...>> {
+            using type = meta::list<stencil_stage<Stencil, Out, Ins...>,
+                meta::second<meta::mp_find<TileTmps, integral_constant<int, Out>, meta::list<void, extents<>>>>>;
+        };
+
+        template <class TileTmps>
+        struct stage_with_extents_f {
+            template <class Stage>
+            using apply = typename stage_with_extents<TileTmps, Stage>::type;
+        };
+
+        // true if the stage reads its inputs at the points of the tile only
+        template <class StageWithExtents>
+        using reads_within_tile = std::conjunction<typename stencil_stage_impl_::stage_info<
+                                                       meta::first<StageWithExtents>>::is_pointwise_t,
+            std::is_same<meta::second<StageWithExtents>, extents<>>>;
+
+        template <class TileTmpKeys, class Outs, class OutsideIns, class Stages>
+        struct check_tiling : std::true_type {};
+
+        template <class TileTmpKeys, class Outs, class OutsideIns, class Stage, class... Stages>
+        struct check_tiling<TileTmpKeys, Outs, OutsideIns, meta::list<Stage, Stages...>> {
+            using stage_t = meta::first<Stage>;
+            using out_t = stencil_stage_impl_::stage_out<stage_t>;
+            using ins_t = stencil_stage_impl_::stage_ins<stage_t>;
+            using is_tile_tmp_t = stencil_stage_impl_::contains<TileTmpKeys, out_t>;
+
+            // the earlier outputs (except tile temporaries) are computed tile by tile, thus the neighbouring tiles
+            // might not be done yet; and the inputs that the earlier stages read outside of their tile can't be
+            // overwritten
+            static constexpr bool is_safe =
+                (reads_within_tile<Stage>::value || !stencil_stage_impl_::contains_any<Outs, ins_t>::value) &&
+                (is_tile_tmp_t::value || !stencil_stage_impl_::contains<OutsideIns, out_t>::value);
+
+            static constexpr bool value = is_safe && check_tiling<TileTmpKeys,
+                                                         meta::if_<is_tile_tmp_t, Outs, meta::push_back<Outs, out_t>>,
+                                                         meta::if_<reads_within_tile<Stage>,
+                                                             OutsideIns,
+                                                             meta::concat<OutsideIns, ins_t>>,
+                                                         meta::list<Stages...>>::value;
+        };
+
+        /*
+         * The stages (paired with their extents) can be computed tile by tile if no stage reads outside of its tile
+         * an argument (other than a tile temporary) that is written by another stage of the execution.
+         */
+        template <class StagesWithExtents, class TileTmps>
+        using is_tiling_safe = std::bool_constant<
+            check_tiling<meta::transform<meta::first, TileTmps>, meta::list<>, meta::list<>, StagesWithExtents>::value>;
+
+        // fallback for backends without tiles: a temporary of the size of the extended domain
+        template <class Allocator, class Sizes, class T, class Extents>
+        auto allocate_tile_tmp(Allocator &alloc, Sizes const &sizes, backend::data_type<T>, Extents) {
+            using namespace int_vector::arithmetic;
+            return sid::shift_sid_origin(
+                allocate_global_tmp(alloc, extend_sizes<Extents>(sizes), backend::data_type<T>()), -Extents::offsets());
+        }
+
+        // fallback for backends without tiles: each stage is computed on its extended domain
+        template <class Backend, class Sizes, class Stages, class TileTmps, class MakeIterator, class Composite>
+        void apply_tiled_stencil_stages(Backend const &backend,
+            Sizes const &sizes,
+            Stages,
+            TileTmps,
+            MakeIterator const &make_iterator,
+            Composite &composite) {
+            tuple_util::for_each(
+                [&](auto stage) {
+                    using extents_t = meta::second<decltype(stage)>;
+                    auto extended = sid::shift_sid_origin(composite, extents_t::offsets());
+                    apply_stencil_stage(backend,
+                        extend_sizes<extents_t>(sizes),
+                        meta::first<decltype(stage)>(),
+                        make_iterator,
+                        extended);
+                },
+                meta::rename<std::tuple, Stages>());
+        }
+
+        template <class Backend, class StageSpecs, class MakeIterator, class Domain, class Sids>
+        void run_tiled_stencil_stages(
+            Backend const &backend, StageSpecs, MakeIterator const &make_iterator, Domain const &domain, Sids &&sids) {
+            using tile_tmps_t = tile_tmps_extents<Sids>;
+            using stages_t = meta::transform<stage_with_extents_f<tile_tmps_t>::template apply, StageSpecs>;
+            // otherwise the stages are computed one after the other on the whole (extended) domain, as by the
+            // backends without tiles
+            constexpr bool tiled = is_tiling_safe<stages_t, tile_tmps_t>::value;
+            auto alloc = tmp_allocator(backend);
+            auto composite = make_composite(tuple_util::transform(
+                [&](auto &&arg) {
+                    using arg_t = std::decay_t<decltype(arg)>;
+                    if constexpr (is_tile_tmp_arg<arg_t>::value && tiled)
+                        return allocate_tile_tmp(
+                            alloc, domain, backend::data_type<typename arg_t::type>(), typename arg_t::extents_t());
+                    else if constexpr (is_tile_tmp_arg<arg_t>::value)
+                        return run_impl_::allocate_tile_tmp(
+                            alloc, domain, backend::data_type<typename arg_t::type>(), typename arg_t::extents_t());
+                    else
+                        return std::forward<decltype(arg)>(arg);
+                },
+                std::forward<Sids>(sids)));
+            if constexpr (tiled)
+                apply_tiled_stencil_stages(backend, domain, stages_t(), tile_tmps_t(), make_iterator, composite);
+            else
+                run_impl_::apply_tiled_stencil_stages(
+                    backend, domain, stages_t(), tile_tmps_t(), make_iterator, composite);
+        }
     } // namespace run_impl_
 
+    using run_impl_::has_tile_tmps;
+    using run_impl_::is_tile_tmp_arg;
+    using run_impl_::is_tiling_safe;
     using run_impl_::run_column_stages;
     using run_impl_::run_stencil_stages;
+    using run_impl_::run_tiled_stencil_stages;
+    using run_impl_::tile_tmp;
+    using run_impl_::tile_tmp_arg;
 } // namespace gridtools::fn
@@ -9,9 +9,12 @@
  */
 #pragma once
 
+#include <type_traits>
+
 #include "../common/hymap.hpp"
 #include "../common/integral_constant.hpp"
 #include "../common/tuple_util.hpp"
+#include "../meta.hpp"
 
 namespace gridtools::fn {
 
@@ -32,4 +35,112 @@ namespace gridtools::fn {
         }
     };
 
+    namespace stencil_stage_impl_ {
+        /*
+         * A stencil is pointwise if it dereferences its arguments only at the current point, which is declared with
+         *
+         *     struct scale {
+         *         static constexpr bool pointwise = true;
+         *         constexpr auto operator()() const { return [](auto const &in) { return 2 * deref(in); }; }
+         *     };
+         */
+        template <class Stencil, class = void>
+        struct is_pointwise : std::false_type {};
+
+        template <class Stencil>
+        struct is_pointwise<Stencil, std::enable_if_t<Stencil::pointwise>> : std::true_type {};
+
+        template <class>
+        struct is_stencil_stage : std::false_type {};
+
+        template <class Stencil, int Out, int... Ins>
+        struct is_stencil_stage<stencil_stage<Stencil, Out, Ins...>> : std::true_type {};
+
+        template <class>
+        struct stage_info;
+
+        template <class Stencil, int Out, int... Ins>
+        struct stage_info<stencil_stage<Stencil, Out, Ins...>> {
+            using out_t = integral_constant<int, Out>;
+            using ins_t = meta::list<integral_constant<int, Ins>...>;
+            using is_pointwise_t = is_pointwise<Stencil>;
+        };
+
+        template <class Stage>
+        using stage_out = typename stage_info<Stage>::out_t;
+
+        template <class Stage>
+        using stage_ins = typename stage_info<Stage>::ins_t;
+
+        template <class List, class T>
+        struct contains;
+
+        template <class... Ts, class T>
+        struct contains<meta::list<Ts...>, T> : std::disjunction<std::is_same<Ts, T>...> {};
+
+        template <class List, class Ts>
+        struct contains_any;
+
+        template <class List, class... Ts>
+        struct contains_any<List, meta::list<Ts...>> : std::disjunction<contains<List, Ts>...> {};
+
+        /*
+         * Within one sweep, the stages of a group are applied one after the other at every point. Thus `Stage` can
+         * join the group if it doesn't overwrite an argument that the group reads (at some offset), and if it reads
+         * outputs of the group only at the current point, which is then computed already.
+         */
+        template <class Group, class Stage>
+        struct is_hazard_free
+            : std::bool_constant<!contains<meta::flatten<meta::transform<stage_ins, Group>>, stage_out<Stage>>::value &&
+                                 (stage_info<Stage>::is_pointwise_t::value ||
+                                     !contains_any<meta::transform<stage_out, Group>, stage_ins<Stage>>::value)> {};
+
+        template <class Group, class Stage>
+        using can_join = std::conjunction<meta::all_of<is_stencil_stage, meta::push_back<Group, Stage>>,
+            is_hazard_free<Group, Stage>>;
+
+        template <class Done, class Group, class Stages>
+        struct group_stages;
+
+        template <class... Done, class Group>
+        struct group_stages<meta::list<Done...>, Group, meta::list<>> {
+            using type = meta::list<Done..., Group>;
+        };
+
+        template <class... Done, class... Group, class Stage, class... Stages>
+        struct group_stages<meta::list<Done...>, meta::list<Group...>, meta::list<Stage, Stages...>>
+            : std::conditional_t<can_join<meta::list<Group...>, Stage>::value,
+                  group_stages<meta::list<Done...>, meta::list<Group..., Stage>, meta::list<Stages...>>,
+                  group_stages<meta::list<Done..., meta::list<Group...>>, meta::list<Stage>, meta::list<Stages...>>> {};
+
+        template <class Group>
+        struct merge_group {
+            using type = meta::rename<merged_stencil_stage, Group>;
+        };
+
+        template <class Stage>
+        struct merge_group<meta::list<Stage>> {
+            using type = Stage;
+        };
+
+        template <class Stages>
+        struct fuse_stencil_stages {
+            using type = meta::list<>;
+        };
+
+        template <class Stage, class... Stages>
+        struct fuse_stencil_stages<meta::list<Stage, Stages...>> {
+            using type = meta::transform<meta::force<merge_group>::apply,
+                typename group_stages<meta::list<>, meta::list<Stage>, meta::list<Stages...>>::type>;
+        };
+    } // namespace stencil_stage_impl_
+
+    using stencil_stage_impl_::is_pointwise;
+
+    /*
+     * Merges the consecutive stencil stages that can be applied in one sweep over the domain, see above.
+     */
+    template <class Stages>
+    using fuse_stencil_stages = typename stencil_stage_impl_::fuse_stencil_stages<Stages>::type;
+
 } // namespace gridtools::fn
@@ -9,8 +9,14 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <numeric>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "../common/defs.hpp"
 #include "../common/for_each.hpp"
 #include "../common/host_device.hpp"
 #include "../common/hymap.hpp"
@@ -18,6 +24,8 @@
 #include "../common/tuple_util.hpp"
 #include "../meta.hpp"
 #include "../sid/concept.hpp"
+#include "../thread_pool/concept.hpp"
+#include "common/caches.hpp"
 #include "common/dim.hpp"
 #include "common/extent.hpp"
 #include "core/execution_types.hpp"
@@ -411,6 +419,379 @@ namespace gridtools {
             using make_split_view = meta::rename<aggregated_view,
                 meta::transform<make_split_view_item, meta::flatten<meta::transform<fuse_stage_rows, Matrices>>>>;
 
+            template <class Plh>
+            struct has_plh_f {
+                template <class Item>
+                using apply = meta::st_contains<typename Item::plhs_t, Plh>;
+            };
+
+            template <class Plh>
+            struct is_plh_f {
+                template <class PlhInfo>
+                using apply = std::is_same<typename PlhInfo::plh_t, Plh>;
+            };
+
+            /**
+             *  Metafunction class that checks if a placeholder of the split view item `Stage` is a k-cached temporary
+             *  that lives only within this stage: it has no fill/flush policies, is not used by any other item of
+             *  `Stages`, is accessed without horizontal offsets and the current k-level is within its k-extent.
+             *  Such a temporary does not need any storage beyond the k-cache window of a column.
+             */
+            template <class Stages, class Stage>
+            struct is_local_k_cache_f {
+                template <class PlhInfo, class Plh = typename PlhInfo::plh_t, class Extent = typename PlhInfo::extent_t>
+                using apply = std::bool_constant<
+                    std::is_same_v<typename PlhInfo::caches_t, meta::list<cache_type::k>> &&
+                    meta::is_empty<typename PlhInfo::cache_io_policies_t>::value && PlhInfo::is_tmp_t::value &&
+                    !PlhInfo::is_const_t::value && Extent::kminus::value <= 0 && Extent::kplus::value >= 0 &&
+                    std::is_same_v<to_horizontal_extent<Extent>, to_horizontal_extent<typename Stage::extent_t>> &&
+                    meta::length<meta::filter<has_plh_f<Plh>::template apply, Stages>>::value == 1 &&
+                    meta::length<meta::filter<is_plh_f<Plh>::template apply, typename Stage::plh_map_t>>::value == 1>;
+            };
+
+            namespace inlined_tmp_impl_ {
+                template <class PlhInfo, class Users>
+                struct is_inlined_tmp : std::false_type {};
+
+                template <class PlhInfo, class Stage>
+                struct is_inlined_tmp<PlhInfo, meta::list<Stage>>
+                    : std::bool_constant<PlhInfo::is_tmp_t::value &&
+                                         meta::is_empty<typename PlhInfo::caches_t>::value &&
+                                         meta::is_empty<typename PlhInfo::cache_io_policies_t>::value &&
+                                         PlhInfo::num_colors_t::value == 1 &&
+                                         std::is_same_v<typename PlhInfo::extent_t, typename Stage::extent_t>> {};
+
+                template <class Plhs, class Expected>
+                struct is_in_f {
+                    template <class PlhInfo>
+                    using apply = std::bool_constant<meta::st_contains<Plhs, typename PlhInfo::plh_t>::value ==
+                                                     Expected::value>;
+                };
+            } // namespace inlined_tmp_impl_
+
+            /**
+             *  Metafunction class that checks if a temporary of the split view `Stages` is computed on the fly: it is
+             *  used by a single item of `Stages`, it is accessed without offsets (its extent is the extent of the
+             *  item), it is not cached and has a single color.
+             *  The stages of an item are executed one after the other at each point, so the value of such a temporary
+             *  is consumed at the point where it is produced. The backends that execute the items that way store it
+             *  per point (or per the points they process at once) instead of in a buffer.
+             */
+            template <class Stages>
+            struct is_inlined_tmp_f {
+                template <class PlhInfo>
+                using apply = typename inlined_tmp_impl_::is_inlined_tmp<PlhInfo,
+                    meta::filter<has_plh_f<typename PlhInfo::plh_t>::template apply,
+                        meta::rename<meta::list, Stages>>>::type;
+            };
+
+            template <class Stages>
+            using inlined_tmp_plhs = meta::transform<get_plh,
+                meta::filter<is_inlined_tmp_f<Stages>::template apply, typename Stages::tmp_plh_map_t>>;
+
+            /**
+             *  The part of `PlhMap` with the temporaries that are computed on the fly.
+             */
+            template <class Stages, class PlhMap>
+            using inlined_tmp_plh_map =
+                meta::filter<inlined_tmp_impl_::is_in_f<inlined_tmp_plhs<Stages>, std::true_type>::template apply,
+                    PlhMap>;
+
+            /**
+             *  The part of `PlhMap` with the temporaries that need a buffer.
+             */
+            template <class Stages, class PlhMap>
+            using buffered_tmp_plh_map =
+                meta::filter<inlined_tmp_impl_::is_in_f<inlined_tmp_plhs<Stages>, std::false_type>::template apply,
+                    PlhMap>;
+
+            namespace tmp_slots_impl_ {
+                template <class Stages, class Plh>
+                struct uses_plh_f {
+                    template <class I>
+                    using apply = meta::st_contains<typename meta::at<Stages, I>::plhs_t, Plh>;
+                };
+
+                // the positions of the stages that access the placeholder
+                template <class Stages, class Plh>
+                using use_positions =
+                    meta::filter<uses_plh_f<Stages, Plh>::template apply, meta::make_indices_for<Stages>>;
+
+                template <class Info, class Last, class Plhs>
+                struct tmp_slot {
+                    using info_t = Info;
+                    using last_t = Last;
+                    using plhs_t = Plhs;
+                };
+
+                template <class Slot>
+                using get_info = typename Slot::info_t;
+
+                template <class L, class R>
+                using are_compatible = std::conjunction<std::is_same<typename L::data_t, typename R::data_t>,
+                    std::is_same<typename L::num_colors_t, typename R::num_colors_t>>;
+
+                template <class Info, class Extent>
+                struct widen_extent;
+
+                template <class Key,
+                    class IsTmp,
+                    class Data,
+                    class NumColors,
+                    class IsConst,
+                    class Extent,
+                    class CacheIoPolicies,
+                    class Other>
+                struct widen_extent<plh_info<Key, IsTmp, Data, NumColors, IsConst, Extent, CacheIoPolicies>, Other> {
+                    using type = plh_info<Key,
+                        IsTmp,
+                        Data,
+                        NumColors,
+                        IsConst,
+                        enclosing_extent<Extent, Other>,
+                        CacheIoPolicies>;
+                };
+
+                template <class Slots, class Info, class First>
+                struct can_reuse_f {
+                    template <class I, class Slot = meta::at<Slots, I>>
+                    using apply = std::bool_constant<are_compatible<typename Slot::info_t, Info>::value &&
+                                                     (Slot::last_t::value < First::value)>;
+                };
+
+                template <class Slots, class Info, class Last, class Candidates>
+                struct add_to_slots {
+                    using type = meta::push_back<Slots, tmp_slot<Info, Last, meta::list<typename Info::plh_t>>>;
+                };
+
+                template <class Slots, class Info, class Last, class I, class... Is>
+                struct add_to_slots<Slots, Info, Last, meta::list<I, Is...>> {
+                    using slot_t = meta::at<Slots, I>;
+                    using type = meta::replace_at<Slots,
+                        I,
+                        tmp_slot<typename widen_extent<typename slot_t::info_t, typename Info::extent_t>::type,
+                            Last,
+                            meta::push_back<typename slot_t::plhs_t, typename Info::plh_t>>>;
+                };
+
+                template <class Stages>
+                struct assign_slot_f {
+                    template <class Slots,
+                        class Info,
+                        class Positions = use_positions<Stages, typename Info::plh_t>,
+                        class Candidates = meta::filter<
+                            can_reuse_f<Slots, Info, meta::first<Positions>>::template apply,
+                            meta::make_indices_for<Slots>>>
+                    using apply = typename add_to_slots<Slots, Info, meta::last<Positions>, Candidates>::type;
+                };
+
+                template <class Stages, class PlhMap>
+                struct first_used_at_f {
+                    template <class I>
+                    struct is_first_used_f {
+                        template <class Info>
+                        using apply =
+                            std::is_same<meta::first<use_positions<Stages, typename Info::plh_t>>, I>;
+                    };
+
+                    template <class I>
+                    using apply = meta::filter<is_first_used_f<I>::template apply, PlhMap>;
+                };
+
+                template <class Stages, class PlhMap>
+                using order_by_first_use = meta::flatten<
+                    meta::transform<first_used_at_f<Stages, PlhMap>::template apply, meta::make_indices_for<Stages>>>;
+
+                template <class Plh>
+                struct slot_has_plh_f {
+                    template <class Slot>
+                    using apply = meta::st_contains<typename Slot::plhs_t, Plh>;
+                };
+
+                template <class Slots, class Plh>
+                using slot_position =
+                    meta::st_position<Slots, meta::first<meta::filter<slot_has_plh_f<Plh>::template apply, Slots>>>;
+            } // namespace tmp_slots_impl_
+
+            /**
+             *  Liveness analysis of the temporaries of the split view `Stages`.
+             *
+             *  The live range of a temporary spans the stages from the first to the last one that accesses it. The
+             *  temporaries from `PlhMap` are assigned greedily in the order of their first use to storage slots,
+             *  a slot is reused if its previous temporaries are not live anymore and it has the same data type and
+             *  number of colors. The result is a list of slots, each of them has the `info_t` that is used to
+             *  allocate the storage (its extent encloses the extents of all temporaries of the slot) and the `plhs_t`
+             *  that share it.
+             *
+             *  This is only valid for the backends that execute the stages in the order of the split view, each of
+             *  them for the whole domain (or the whole block of a thread) before the next one starts.
+             */
+            template <class Stages, class PlhMap>
+            using make_tmp_slots = meta::foldl<tmp_slots_impl_::assign_slot_f<Stages>::template apply,
+                meta::list<>,
+                tmp_slots_impl_::order_by_first_use<Stages, PlhMap>>;
+
+            /**
+             *  Like `make_data_stores`, but the temporaries that are never live at the same time share the storage,
+             *  see `make_tmp_slots`. `fun` is called once per slot.
+             */
+            template <class Stages, class PlhMap, class Fun>
+            auto make_aliased_data_stores(Stages, PlhMap, Fun &&fun) {
+                using slots_t = make_tmp_slots<Stages, PlhMap>;
+                auto slot_data_stores = tuple_util::transform(std::forward<Fun>(fun),
+                    meta::rename<tuple, meta::transform<tmp_slots_impl_::get_info, slots_t>>());
+                return tuple_util::transform(
+                    [&](auto info) {
+                        using plh_t = decltype(info.plh());
+                        return tuple_util::get<tmp_slots_impl_::slot_position<slots_t, plh_t>::value>(
+                            slot_data_stores);
+                    },
+                    hymap::from_keys_values<meta::transform<get_plh, PlhMap>, PlhMap>());
+            }
+
+            namespace pass_groups_impl_ {
+                template <class Pass, class PlhMap = typename Pass::plh_map_t>
+                struct pass_info {
+                    using plhs_t = meta::transform<get_plh, PlhMap>;
+                    using written_plhs_t =
+                        meta::transform<get_plh, meta::filter<meta::not_<get_is_const>::apply, PlhMap>>;
+                };
+
+                template <class Plhs>
+                struct is_in_f {
+                    template <class Plh>
+                    using apply = meta::st_contains<Plhs, Plh>;
+                };
+
+                // the passes conflict if one of them writes a placeholder that the other one accesses
+                template <class L, class R>
+                using conflict = std::bool_constant<
+                    meta::any_of<is_in_f<typename R::plhs_t>::template apply, typename L::written_plhs_t>::value ||
+                    meta::any_of<is_in_f<typename L::plhs_t>::template apply, typename R::written_plhs_t>::value>;
+
+                template <class PassInfos, class I>
+                struct conflicts_with_f {
+                    template <class J>
+                    using apply = conflict<meta::at<PassInfos, J>, meta::at<PassInfos, I>>;
+                };
+
+                template <class PassInfos>
+                struct get_dependencies_f {
+                    template <class I>
+                    using apply = meta::filter<conflicts_with_f<PassInfos, I>::template apply,
+                        meta::take_c<I::value, meta::make_indices_for<PassInfos>>>;
+                };
+
+                template <class Dependencies>
+                struct intersects_f {
+                    template <class Group>
+                    using apply = meta::any_of<is_in_f<Dependencies>::template apply, Group>;
+                };
+
+                template <class Dependencies>
+                struct add_pass_f {
+                    template <class Groups,
+                        class I,
+                        class IsDependent = intersects_f<meta::at<Dependencies, I>>,
+                        class Merged = meta::flatten<meta::push_back<
+                            meta::filter<IsDependent::template apply, Groups>,
+                            meta::list<I>>>>
+                    using apply = meta::push_back<
+                        meta::filter<meta::not_<IsDependent::template apply>::template apply, Groups>,
+                        Merged>;
+                };
+
+                template <class I, class Matrix>
+                using pass_of_stages = meta::repeat<meta::length<fuse_stage_rows<Matrix>>, meta::list<I>>;
+
+                template <class StagePasses, class Group>
+                struct in_group_f {
+                    template <class I>
+                    using apply = meta::st_contains<Group, meta::at<StagePasses, I>>;
+                };
+
+                template <class StagePasses>
+                struct get_stages_f {
+                    template <class Group>
+                    using apply = meta::filter<in_group_f<StagePasses, Group>::template apply,
+                        meta::make_indices_for<StagePasses>>;
+                };
+            } // namespace pass_groups_impl_
+
+            /**
+             *  The dependence DAG of `Passes` (the items of the fused view): the `i`-th element is the list of the
+             *  indices of the preceding passes that the `i`-th pass depends on. Two passes depend on each other if
+             *  one of them writes a placeholder that the other one reads or writes.
+             */
+            template <class Passes, class PassInfos = meta::transform<pass_groups_impl_::pass_info, Passes>>
+            using make_pass_dependencies =
+                meta::transform<pass_groups_impl_::get_dependencies_f<PassInfos>::template apply,
+                    meta::make_indices_for<PassInfos>>;
+
+            /**
+             *  `Passes` split into the groups that are independent of each other (the weakly connected components of
+             *  the dependence DAG), each group is the list of the pass indices.
+             */
+            template <class Passes, class Dependencies = make_pass_dependencies<Passes>>
+            using make_pass_groups = meta::foldl<pass_groups_impl_::add_pass_f<Dependencies>::template apply,
+                meta::list<>,
+                meta::make_indices_for<Dependencies>>;
+
+            /**
+             *  The groups of independent passes of `Spec` as the lists of the (ascending) indices of the split view
+             *  items that belong to them.
+             *
+             *  The groups share no temporaries and no field that one of them writes. The backends that execute
+             *  the split view items one after the other for each block of the domain may thus execute the blocks
+             *  of different groups concurrently, while the items of a group are still executed in order.
+             */
+            template <class Spec,
+                class StagePasses = meta::flatten<
+                    meta::transform<pass_groups_impl_::pass_of_stages, meta::make_indices_for<Spec>, Spec>>>
+            using make_stage_groups = meta::transform<pass_groups_impl_::get_stages_f<StagePasses>::template apply,
+                make_pass_groups<meta::rename<meta::list, make_fused_view<Spec>>>>;
+
+            /**
+             *  Calls `fun` with the element of the tuple `groups` at the run time index `i`.
+             */
+            template <class Groups, class Fun>
+            void visit_group(Groups &&groups, int_t i, Fun &&fun) {
+                int_t n = 0;
+                tuple_util::for_each(
+                    [&](auto &&group) {
+                        if (n++ == i)
+                            fun(std::forward<decltype(group)>(group));
+                    },
+                    std::forward<Groups>(groups));
+            }
+
+            /**
+             *  Calls `fun` with every member of a batch (see `core::batch_member`), concurrently on the threads of
+             *  `ThreadPool`. Each thread takes the next member as soon as it is done with the previous one, the
+             *  largest members first. This way members of different sizes don't leave threads idle, which a static
+             *  partition of the members does.
+             */
+            template <class ThreadPool, class Members, class Fun>
+            void parallel_for_each_member(ThreadPool, Members const &members, Fun const &fun) {
+                std::vector<std::size_t> order(members.size());
+                std::iota(order.begin(), order.end(), 0);
+                auto volume = [&](std::size_t i) {
+                    auto const &grid = members[i].grid;
+                    return (std::size_t)grid.i_size() * grid.j_size() * grid.k_size();
+                };
+                std::stable_sort(
+                    order.begin(), order.end(), [&](std::size_t l, std::size_t r) { return volume(l) > volume(r); });
+                std::atomic<std::size_t> next(0);
+                int_t num_threads = std::min<int_t>(thread_pool::get_max_threads(ThreadPool()), order.size());
+                thread_pool::parallel_for_loop(
+                    ThreadPool(),
+                    [&](auto) {
+                        for (std::size_t i = next++; i < order.size(); i = next++)
+                            fun(members[order[i]]);
+                    },
+                    num_threads);
+            }
+
             using core::is_backward;
             using core::is_forward;
             using core::is_parallel;
@@ -0,0 +1,103 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../common/defs.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace activity_mask_impl_ {
+            /**
+             *  A rectangle of the horizontal compute domain, the ends are exclusive.
+             */
+            struct region {
+                int_t i_begin;
+                int_t i_end;
+                int_t j_begin;
+                int_t j_end;
+            };
+
+            /**
+             *  The active points of the horizontal compute domain, see run_masked.hpp. The point (0, 0) is the first
+             *  point of the compute domain.
+             *
+             *  The mask is stored as the running count of active points, thus the backends can test whether a block
+             *  of any size contains an active point in constant time.
+             */
+            class activity_mask {
+                int_t m_i_size;
+                int_t m_j_size;
+                std::vector<int_t> m_counts;
+
+                int_t &prefix(int_t i, int_t j) { return m_counts[j * (m_i_size + 1) + i]; }
+                int_t prefix(int_t i, int_t j) const { return m_counts[j * (m_i_size + 1) + i]; }
+
+                template <class Pred>
+                void init(Pred const &pred) {
+                    for (int_t j = 0; j < m_j_size; ++j)
+                        for (int_t i = 0; i < m_i_size; ++i)
+                            prefix(i + 1, j + 1) =
+                                prefix(i, j + 1) + prefix(i + 1, j) - prefix(i, j) + (pred(i, j) ? 1 : 0);
+                }
+
+              public:
+                /**
+                 *  The points for which `pred(i, j)` is true are active.
+                 */
+                template <class Pred,
+                    std::enable_if_t<std::is_invocable_r_v<bool, Pred const &, int_t, int_t>, int> = 0>
+                activity_mask(int_t i_size, int_t j_size, Pred const &pred)
+                    : m_i_size(i_size), m_j_size(j_size), m_counts((i_size + 1) * (j_size + 1), 0) {
+                    assert(i_size >= 0 && j_size >= 0);
+                    init(pred);
+                }
+
+                /**
+                 *  The points of the given regions are active.
+                 */
+                activity_mask(int_t i_size, int_t j_size, std::vector<region> const &regions)
+                    : activity_mask(i_size, j_size, [&regions](int_t i, int_t j) {
+                          return std::any_of(regions.begin(), regions.end(), [=](region const &r) {
+                              return i >= r.i_begin && i < r.i_end && j >= r.j_begin && j < r.j_end;
+                          });
+                      }) {}
+
+                int_t i_size() const { return m_i_size; }
+                int_t j_size() const { return m_j_size; }
+
+                /**
+                 *  Number of active points in the given rectangle, which is clamped to the compute domain.
+                 */
+                int_t count(region r) const {
+                    int_t i_begin = std::clamp(r.i_begin, int_t(0), m_i_size);
+                    int_t i_end = std::clamp(r.i_end, i_begin, m_i_size);
+                    int_t j_begin = std::clamp(r.j_begin, int_t(0), m_j_size);
+                    int_t j_end = std::clamp(r.j_end, j_begin, m_j_size);
+                    return prefix(i_end, j_end) - prefix(i_begin, j_end) - prefix(i_end, j_begin) +
+                           prefix(i_begin, j_begin);
+                }
+
+                /**
+                 *  Whether the given rectangle contains an active point.
+                 */
+                bool any(region r) const { return count(r) > 0; }
+            };
+        } // namespace activity_mask_impl_
+
+        using activity_mask_impl_::activity_mask;
+        using activity_mask_impl_::region;
+    } // namespace stencil
+} // namespace gridtools
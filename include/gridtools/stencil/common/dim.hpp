@@ -20,6 +20,9 @@ namespace gridtools {
             using k = integral_constant<int, 2>;
             using c = integral_constant<int, 3>;
 
+            // the members of an ensemble, see run_ensemble.hpp
+            struct e;
+
             struct thread;
         } // namespace dim
     }     // namespace stencil
@@ -9,6 +9,8 @@
  */
 #pragma once
 
+#include <utility>
+
 #include "../../common/host_device.hpp"
 
 namespace gridtools {
@@ -49,7 +51,7 @@ namespace gridtools {
 
         template <intent Intent, class T, class Res = typename apply_intent_type<Intent, T>::type>
         GT_FUNCTION Res apply_intent(T &&obj) {
-            return static_cast<Res>(obj);
+            return static_cast<Res>(std::forward<T>(obj));
         }
     } // namespace stencil
 } // namespace gridtools
@@ -12,13 +12,18 @@
 #include <cassert>
 #include <functional>
 #include <utility>
+#include <vector>
 
+#include "../../common/defs.hpp"
 #include "../../common/for_each.hpp"
 #include "../../common/hymap.hpp"
 #include "../../common/tuple.hpp"
 #include "../../common/tuple_util.hpp"
 #include "../../sid/sid_shift_origin.hpp"
+#include "../../thread_pool/dummy.hpp"
 #include "../be_api.hpp"
+#include "../common/activity_mask.hpp"
+#include "../common/dim.hpp"
 #include "convert_fe_to_be_spec.hpp"
 
 namespace gridtools {
@@ -33,24 +38,183 @@ namespace gridtools {
                         std::move(data_stores));
                 }
 
+                template <class BeSpec, class Grid>
+                void check_k_sizes(Grid const &grid) {
+#ifndef NDEBUG
+                    for_each<be_api::make_fused_view<BeSpec>>([&](auto matrix) {
+                        for_each<decltype(matrix)>([&](auto info) {
+                            assert(((void)"domain k-size is too small", grid.k_size(info.interval()) >= 0));
+                        });
+                    });
+#endif
+                }
+
                 template <class Spec>
                 struct call_entry_point_f {
                     template <class Backend, class Grid, class DataStores>
                     void operator()(Backend &&be, Grid const &grid, DataStores data_stores) const {
                         using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
-#ifndef NDEBUG
-                        for_each<be_api::make_fused_view<be_spec_t>>([&](auto matrix) {
-                            for_each<decltype(matrix)>([&](auto info) {
-                                assert(((void)"domain k-size is too small", grid.k_size(info.interval()) >= 0));
-                            });
-                        });
-#endif
+                        check_k_sizes<be_spec_t>(grid);
                         gridtools_backend_entry_point(
                             std::forward<Backend>(be), be_spec_t(), grid, shift_origin(grid, std::move(data_stores)));
                     }
                 };
+
+                /**
+                 *  Fallback for the backends that don't separate the setup of a stencil from its execution: the
+                 *  prepared stencil just calls the entry point.
+                 *
+                 *  Backends can overload `gridtools_backend_prepare` to do the setup that only depends on the types
+                 *  of the data stores and on the grid (allocation of temporaries, block decomposition, ...) once. It
+                 *  returns a callable that executes the stencil on the data stores it is given.
+                 */
+                template <class Backend, class Spec, class Grid, class DataStores>
+                auto gridtools_backend_prepare(Backend be, Spec, Grid const &grid, DataStores const &) {
+                    return [be = std::move(be), grid](DataStores data_stores) {
+                        gridtools_backend_entry_point(be, Spec(), grid, std::move(data_stores));
+                    };
+                }
+
+                template <class Spec>
+                struct prepare_entry_point_f {
+                    template <class Backend, class Grid, class DataStores>
+                    auto operator()(Backend &&be, Grid const &grid, DataStores const &data_stores) const {
+                        using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
+                        check_k_sizes<be_spec_t>(grid);
+                        auto prepared = gridtools_backend_prepare(
+                            std::forward<Backend>(be), be_spec_t(), grid, shift_origin(grid, DataStores(data_stores)));
+                        return [prepared = std::move(prepared), grid](DataStores data_stores) {
+                            prepared(shift_origin(grid, std::move(data_stores)));
+                        };
+                    }
+                };
+
+                /**
+                 *  A member of a batch: the grid and the data stores of one execution of the stencil.
+                 */
+                template <class Grid, class DataStores>
+                struct batch_member {
+                    Grid grid;
+                    DataStores data_stores;
+                };
+
+                /**
+                 *  Fallback for the backends without support for batches: the members are executed one after the
+                 *  other.
+                 *
+                 *  Backends can overload `gridtools_backend_batch_entry_point` to execute the members of `members`,
+                 *  a `std::vector` of `batch_member`s, concurrently.
+                 */
+                template <class Backend, class Spec, class Members>
+                void gridtools_backend_batch_entry_point(Backend const &be, Spec, Members const &members) {
+                    for (auto const &member : members)
+                        gridtools_backend_entry_point(be, Spec(), member.grid, member.data_stores);
+                }
+
+                template <class Spec>
+                struct call_batch_entry_point_f {
+                    template <class Backend, class Grid, class DataStores>
+                    void operator()(Backend &&be, std::vector<batch_member<Grid, DataStores>> const &members) const {
+                        using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
+                        using shifted_t =
+                            decltype(shift_origin(std::declval<Grid const &>(), std::declval<DataStores>()));
+                        std::vector<batch_member<Grid, shifted_t>> shifted;
+                        shifted.reserve(members.size());
+                        for (auto const &member : members) {
+                            check_k_sizes<be_spec_t>(member.grid);
+                            shifted.push_back({member.grid, shift_origin(member.grid, member.data_stores)});
+                        }
+                        gridtools_backend_batch_entry_point(std::forward<Backend>(be), be_spec_t(), shifted);
+                    }
+                };
+
+                /**
+                 *  Fallback for the backends that can't be split: the independent runs of a caller are executed one
+                 *  after the other (on `thread_pool::dummy`), each of them by the backend itself.
+                 *
+                 *  Backends can overload `gridtools_backend_split` to return their thread pool and a single threaded
+                 *  variant of themselves, such that independent runs on small grids can be executed concurrently on
+                 *  the threads of the pool.
+                 */
+                template <class Backend>
+                std::pair<thread_pool::dummy, Backend> gridtools_backend_split(Backend const &be) {
+                    return {{}, be};
+                }
+
+                template <class Backend>
+                auto split_backend(Backend const &be) {
+                    return gridtools_backend_split(be);
+                }
+
+                /**
+                 *  Fallback for the backends without support for ensembles: the members are executed one after the
+                 *  other, each of them on the data stores shifted to the member along `dim::e`.
+                 *
+                 *  Backends can overload `gridtools_backend_ensemble_entry_point` to execute all `members` members
+                 *  in one sweep.
+                 */
+                template <class Backend, class Spec, class Grid, class DataStores>
+                void gridtools_backend_ensemble_entry_point(
+                    Backend const &be, Spec, Grid const &grid, int_t members, DataStores const &data_stores) {
+                    for (int_t m = 0; m < members; ++m)
+                        gridtools_backend_entry_point(be,
+                            Spec(),
+                            grid,
+                            tuple_util::transform(
+                                [offsets = hymap::keys<dim::e>::make_values(m)](
+                                    auto const &src) { return sid::shift_sid_origin(src, offsets); },
+                                data_stores));
+                }
+
+                template <class Spec>
+                struct call_ensemble_entry_point_f {
+                    template <class Backend, class Grid, class DataStores>
+                    void operator()(Backend &&be, Grid const &grid, int_t members, DataStores data_stores) const {
+                        using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
+                        check_k_sizes<be_spec_t>(grid);
+                        gridtools_backend_ensemble_entry_point(std::forward<Backend>(be),
+                            be_spec_t(),
+                            grid,
+                            members,
+                            shift_origin(grid, std::move(data_stores)));
+                    }
+                };
+
+                /**
+                 *  Fallback for the backends without support for activity masks: the whole grid is computed, which
+                 *  includes the active points.
+                 *
+                 *  Backends can overload `gridtools_backend_masked_entry_point` to skip the blocks of the grid that
+                 *  have no active point.
+                 */
+                template <class Backend, class Spec, class Grid, class DataStores>
+                void gridtools_backend_masked_entry_point(
+                    Backend const &be, Spec, Grid const &grid, activity_mask const &, DataStores data_stores) {
+                    gridtools_backend_entry_point(be, Spec(), grid, std::move(data_stores));
+                }
+
+                template <class Spec>
+                struct call_masked_entry_point_f {
+                    template <class Backend, class Grid, class DataStores>
+                    void operator()(
+                        Backend &&be, Grid const &grid, activity_mask const &mask, DataStores data_stores) const {
+                        using be_spec_t = convert_fe_to_be_spec<Spec, typename Grid::interval_t, DataStores>;
+                        check_k_sizes<be_spec_t>(grid);
+                        gridtools_backend_masked_entry_point(std::forward<Backend>(be),
+                            be_spec_t(),
+                            grid,
+                            mask,
+                            shift_origin(grid, std::move(data_stores)));
+                    }
+                };
             } // namespace backend_impl_
+            using backend_impl_::batch_member;
+            using backend_impl_::call_batch_entry_point_f;
+            using backend_impl_::call_ensemble_entry_point_f;
             using backend_impl_::call_entry_point_f;
+            using backend_impl_::call_masked_entry_point_f;
+            using backend_impl_::prepare_entry_point_f;
+            using backend_impl_::split_backend;
         } // namespace core
     }     // namespace stencil
 } // namespace gridtools
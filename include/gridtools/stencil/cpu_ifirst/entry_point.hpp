@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
@@ -21,23 +22,41 @@
 #include "../../sid/block.hpp"
 #include "../../sid/composite.hpp"
 #include "../../sid/concept.hpp"
+#include "../../thread_pool/dummy.hpp"
 #include "../../thread_pool/omp.hpp"
 #include "../be_api.hpp"
+#include "../common/activity_mask.hpp"
 #include "../common/dim.hpp"
 #include "execinfo.hpp"
+#include "ij_cache.hpp"
+#include "k_cache.hpp"
 #include "loops.hpp"
 #include "pos3.hpp"
+#include "segments.hpp"
 #include "tmp_storage_sid.hpp"
+#include "tuning.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_ifirst_backend {
-            template <class ThreadPool = thread_pool::omp>
-            struct cpu_ifirst {
-                template <class Spec, class Grid, class DataStores>
-                friend void gridtools_backend_entry_point(
-                    cpu_ifirst, Spec, Grid const &grid, DataStores external_data_stores) {
-                    using thread_pool_t = ThreadPool; // workaround needed for nvc++ at least up to 23.3
+            namespace entry_point_impl_ {
+                template <class Segment>
+                using is_serial_segment = std::is_same<typename Segment::mode_t, std::false_type>;
+
+                template <class Stages>
+                struct segment_stages_f {
+                    template <class Segment>
+                    using apply = segment_stages<Stages, Segment>;
+                };
+
+                template <class Stages>
+                struct stage_k_cache_infos_f {
+                    template <class Stage>
+                    using apply = stage_k_cache_infos<Stages, Stage>;
+                };
+
+                template <class Spec, bool Ensemble = false>
+                struct stencil_traits {
                     using stages_t = be_api::make_split_view<Spec>;
                     using all_parrallel_t = typename meta::all_of<be_api::is_parallel,
                         meta::transform<be_api::get_execution, stages_t>>::type;
@@ -47,50 +66,315 @@ namespace gridtools {
                         std::bool_constant<all_parrallel_t::value && enclosing_extent_t::kminus::value == 0 &&
                                            enclosing_extent_t::kplus::value == 0>;
 
-                    tmp_allocator alloc;
+                    // in the k-parallel mode the blocks are shrunk to fit the ij-cached temporaries into the cache
+                    using ij_cache_plh_map_t =
+                        meta::if_<fuse_all_t, ij_cache_plh_map<typename stages_t::tmp_plh_map_t>, meta::list<>>;
+
+                    using segments_t = make_segments<meta::rename<meta::list, stages_t>,
+                        meta::transform<be_api::get_plh, typename stages_t::tmp_plh_map_t>,
+                        fuse_all_t>;
+
+                    // only the k-serial stages use k-caches, the stages of an ensemble don't use them at all
+                    using serial_stages_t = meta::flatten<meta::transform<segment_stages_f<stages_t>::template apply,
+                        meta::filter<is_serial_segment, segments_t>>>;
+                    using k_cache_infos_t = meta::if_c<Ensemble,
+                        meta::list<>,
+                        meta::flatten<
+                            meta::transform<stage_k_cache_infos_f<stages_t>::template apply, serial_stages_t>>>;
+
+                    using tmp_plh_map_t = remove_rolling_k_caches<
+                        be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>,
+                        k_cache_infos_t>;
+
+                    using inlined_tmp_plh_map_t = be_api::inlined_tmp_plh_map<stages_t, tmp_plh_map_t>;
+                    using buffered_tmp_plh_map_t = be_api::buffered_tmp_plh_map<stages_t, tmp_plh_map_t>;
+                };
+
+                template <class ThreadPool, class Spec, class Grid>
+                execinfo make_stencil_execinfo(Grid const &grid) {
+                    return make_execinfo<ThreadPool, typename stencil_traits<Spec>::ij_cache_plh_map_t>(grid);
+                }
+
+                template <class Spec>
+                struct fit_ij_caches_f {
+                    void operator()(execinfo &info) const {
+                        fit_ij_caches<typename stencil_traits<Spec>::ij_cache_plh_map_t>(info);
+                    }
+                };
 
-                    execinfo info(thread_pool_t(), grid);
+                /**
+                 *  The default decomposition refined to blocks of at most 64 x 8 points, which is fine enough to skip
+                 *  most of the inactive points of a sparse mask.
+                 */
+                template <class ThreadPool, class Spec, class Grid>
+                execinfo make_masked_execinfo(Grid const &grid, activity_mask const &mask) {
+                    execinfo info = make_stencil_execinfo<ThreadPool, Spec>(grid);
+                    execinfo res(
+                        grid, std::min(info.i_block_size(), int_t(64)), std::min(info.j_block_size(), int_t(8)));
+                    res.set_mask(mask);
+                    return res;
+                }
+
+                template <class>
+                struct is_ensemble_loop : std::false_type {};
+
+                template <class Simd>
+                struct is_ensemble_loop<ensemble_loop<Simd>> : std::true_type {};
+
+                template <class T, class Extent, bool AllParallel, class ThreadPool, class Simd>
+                auto make_tmp(Simd, tmp_allocator &alloc, pos3<size_t> const &block_size) {
+                    return make_tmp_storage<T, Extent, AllParallel, ThreadPool>(alloc, block_size);
+                }
+
+                template <class T, class Extent, bool AllParallel, class ThreadPool, class Simd>
+                auto make_tmp(ensemble_loop<Simd> simd, tmp_allocator &alloc, pos3<size_t> const &block_size) {
+                    return make_ensemble_tmp_storage<T, Extent, AllParallel, ThreadPool>(
+                        alloc, block_size, simd.members);
+                }
+
+                template <class T, class Extent, class ThreadPool, class Simd>
+                auto make_inlined_tmp(Simd, tmp_allocator &alloc, size_t i_block_size) {
+                    return make_inlined_tmp_storage<T, Extent, ThreadPool>(alloc, i_block_size);
+                }
+
+                template <class T, class Extent, class ThreadPool, class Simd>
+                auto make_inlined_tmp(ensemble_loop<Simd> simd, tmp_allocator &alloc, size_t i_block_size) {
+                    return make_ensemble_inlined_tmp_storage<T, Extent, ThreadPool>(
+                        alloc, i_block_size, simd.members);
+                }
+
+                template <class Mode, class Stages, class PlhMap>
+                struct segment_tmp_plh_map {
+                    using type = PlhMap;
+                };
 
-                    using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
-                    auto temporaries = be_api::make_data_stores(tmp_plh_map_t(),
+                template <class Stages, class PlhMap>
+                struct segment_tmp_plh_map<k_blocked, Stages, PlhMap> {
+                    using type = k_blocked_plh_map<Stages, PlhMap>;
+                };
+
+                /**
+                 *  Allocates the buffered temporaries of the stages of `Segment`: with one k-level in the mode
+                 *  `std::true_type`, with the levels of a k-block in the mode `k_blocked` and with all the levels
+                 *  otherwise. The temporaries of an ensemble hold all its members.
+                 */
+                template <class ThreadPool, class Traits, class Segment, class Simd, class Grid>
+                auto make_segment_temporaries(
+                    tmp_allocator &alloc, Grid const &grid, execinfo const &info, Segment, Simd simd) {
+                    using mode_t = typename Segment::mode_t;
+                    using stages_t = segment_stages<typename Traits::stages_t, Segment>;
+                    using plh_map_t = typename segment_tmp_plh_map<mode_t,
+                        stages_t,
+                        segment_plh_map<typename Traits::stages_t, Segment, typename Traits::buffered_tmp_plh_map_t>>::
+                        type;
+                    size_t k_size = std::is_same_v<mode_t, k_blocked>
+                                        ? (size_t)k_blocking(ThreadPool(), grid, info).k_block_size()
+                                        : (size_t)grid.k_size();
+                    return be_api::make_aliased_data_stores(stages_t(),
+                        plh_map_t(),
                         [&alloc,
-                            block_size = make_pos3(
-                                (size_t)info.i_block_size(), (size_t)info.j_block_size(), (size_t)grid.k_size())](
+                            simd,
+                            block_size = make_pos3((size_t)info.i_block_size(), (size_t)info.j_block_size(), k_size)](
                             auto info) {
-                            return make_tmp_storage<decltype(info.data()),
+                            return make_tmp<decltype(info.data()),
                                 decltype(info.extent()),
-                                fuse_all_t::value,
-                                thread_pool_t>(alloc, block_size);
+                                std::is_same_v<mode_t, std::true_type>,
+                                ThreadPool>(simd, alloc, block_size);
+                        });
+                }
+
+                /**
+                 *  Allocates the temporaries and the k-caches for the given block decomposition and returns the
+                 *  function that executes the stencil on the external data stores.
+                 *
+                 *  The segments of the stencil (see `make_segments`) are executed one after the other.
+                 *
+                 *  `simd` is the loop mode of the i-loop: `std::bool_constant<Simd>` (see simd.hpp) or an
+                 *  `ensemble_loop`.
+                 */
+                template <class ThreadPool, class Spec, class Simd, class Grid>
+                auto make_stencil(Grid const &grid, execinfo info, Simd simd) {
+                    using traits_t = stencil_traits<Spec, is_ensemble_loop<Simd>::value>;
+                    using stages_t = typename traits_t::stages_t;
+                    using segments_t = typename traits_t::segments_t;
+
+                    tmp_allocator alloc;
+
+                    auto temporaries = tuple_util::apply(
+                        [](auto &&...data_stores) { return hymap::concat(std::move(data_stores)...); },
+                        tuple_util::transform(
+                            [&](auto segment) {
+                                return make_segment_temporaries<ThreadPool, traits_t>(
+                                    alloc, grid, info, segment, simd);
+                            },
+                            meta::rename<tuple, segments_t>()));
+
+                    auto inlined_temporaries = be_api::make_data_stores(typename traits_t::inlined_tmp_plh_map_t(),
+                        [&alloc, simd, i_block_size = (size_t)info.i_block_size()](auto info) {
+                            return make_inlined_tmp<decltype(info.data()), decltype(info.extent()), ThreadPool>(
+                                simd, alloc, i_block_size);
                         });
 
-                    auto blocked_externals = tuple_util::transform(
-                        [block_size = hymap::keys<dim::i, dim::j>::make_values(
-                             info.i_block_size(), info.j_block_size())](auto &&data_store) {
-                            return sid::block(std::forward<decltype(data_store)>(data_store), block_size);
-                        },
+                    auto k_caches = be_api::make_data_stores(typename traits_t::k_cache_infos_t(),
+                        [&alloc, &grid, i_block_size = (size_t)info.i_block_size()](auto info) {
+                            return make_k_cache_storage<ThreadPool>(info, alloc, grid, i_block_size);
+                        });
+
+                    return [alloc = std::move(alloc),
+                               grid,
+                               info,
+                               simd,
+                               k_block_size = k_blocking(ThreadPool(), grid, info).k_block_size(),
+                               temporaries = std::move(temporaries),
+                               inlined_temporaries = std::move(inlined_temporaries),
+                               k_caches = std::move(k_caches)](auto external_data_stores) {
+                        tuple_util::for_each(
+                            [&](auto segment) {
+                                using segment_t = decltype(segment);
+                                using mode_t = typename segment_t::mode_t;
+
+                                // the k-blocked segments block the externals along k as well
+                                auto block_size = [&] {
+                                    if constexpr (std::is_same_v<mode_t, k_blocked>)
+                                        return hymap::keys<dim::i, dim::j, dim::k>::make_values(
+                                            info.i_block_size(), info.j_block_size(), k_block_size);
+                                    else
+                                        return hymap::keys<dim::i, dim::j>::make_values(
+                                            info.i_block_size(), info.j_block_size());
+                                }();
+                                auto blocked_externals = tuple_util::transform(
+                                    [&](auto &data_store) { return sid::block(data_store, block_size); },
+                                    external_data_stores);
+
+                                auto data_stores = hymap::concat(
+                                    std::move(blocked_externals), temporaries, inlined_temporaries, k_caches);
+
+                                auto make_stage_loop = [&](auto i) {
+                                    using stage_t = meta::at<stages_t, decltype(i)>;
+                                    auto k_sizes = tuple_util::transform(
+                                        [&](auto cell) { return grid.k_size(cell.interval()); }, stage_t::cells());
+
+                                    using plh_map_t = typename stage_t::plh_map_t;
+                                    using keys_t =
+                                        meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
+                                    auto composite = tuple_util::convert_to<keys_t::template values>(
+                                        tuple_util::transform(
+                                            [&](auto info) {
+                                                return sid::add_const(
+                                                    info.is_const(), at_key<decltype(info.plh())>(data_stores));
+                                            },
+                                            stage_t::plh_map()));
+                                    using stage_k_cache_infos_t =
+                                        meta::if_c<is_serial_segment<segment_t>::value &&
+                                                       !is_ensemble_loop<decltype(simd)>::value,
+                                            stage_k_cache_infos<stages_t, stage_t>,
+                                            meta::list<>>;
+                                    if constexpr (std::is_same_v<mode_t, k_blocked>) {
+                                        using k_extent_t =
+                                            meta::at_c<stage_k_extents<segment_stages<stages_t, segment_t>>,
+                                                meta::st_position<typename segment_t::indices_t, decltype(i)>::value>;
+                                        return make_loop<ThreadPool, stage_t, stage_k_cache_infos_t, Simd>(mode_t(),
+                                            simd,
+                                            grid,
+                                            std::move(composite),
+                                            std::move(k_sizes),
+                                            k_extent_t());
+                                    } else {
+                                        return make_loop<ThreadPool, stage_t, stage_k_cache_infos_t, Simd>(
+                                            mode_t(), simd, grid, std::move(composite), std::move(k_sizes));
+                                    }
+                                };
+
+                                // the loops of the stages grouped by the independent passes
+                                auto loops = tuple_util::transform(
+                                    [&](auto group) {
+                                        return tuple_util::transform(
+                                            make_stage_loop, meta::rename<tuple, decltype(group)>());
+                                    },
+                                    meta::rename<tuple, segment_groups<be_api::make_stage_groups<Spec>, segment_t>>());
+
+                                run_loops<ThreadPool>(mode_t(), grid, info, std::move(loops));
+                            },
+                            meta::rename<tuple, segments_t>());
+                    };
+                }
+            } // namespace entry_point_impl_
+
+            /**
+             *  With `Simd` set, the stages are executed with explicit SIMD vectors along i, see simd.hpp.
+             */
+            template <class ThreadPool = thread_pool::omp, bool Simd = false>
+            struct cpu_ifirst {
+                template <class Spec, class Grid, class DataStores>
+                friend void gridtools_backend_entry_point(
+                    cpu_ifirst, Spec, Grid const &grid, DataStores external_data_stores) {
+                    using thread_pool_t = ThreadPool; // workaround needed for nvc++ at least up to 23.3
+                    execinfo info = entry_point_impl_::make_stencil_execinfo<thread_pool_t, Spec>(grid);
+                    block_tuner tuner(
+                        Spec(), thread_pool_t(), grid, info, entry_point_impl_::fit_ij_caches_f<Spec>());
+                    entry_point_impl_::make_stencil<thread_pool_t, Spec>(grid, info, std::bool_constant<Simd>())(
+                        std::move(external_data_stores));
+                }
+
+                /**
+                 *  The members of an ensemble are computed point by point: the i-loop is replaced by a loop over the
+                 *  members of every point along i, vectorized across the members if `Simd` is set. The block sizes
+                 *  are not tuned.
+                 */
+                template <class Spec, class Grid, class DataStores>
+                friend void gridtools_backend_ensemble_entry_point(
+                    cpu_ifirst, Spec, Grid const &grid, int_t members, DataStores external_data_stores) {
+                    using thread_pool_t = ThreadPool;
+                    execinfo info = entry_point_impl_::make_stencil_execinfo<thread_pool_t, Spec>(grid);
+                    entry_point_impl_::make_stencil<thread_pool_t, Spec>(
+                        grid, info, ensemble_loop<std::bool_constant<Simd>>{members})(std::move(external_data_stores));
+                }
+
+                /**
+                 *  The blocks without active point are skipped. The blocks are kept small for that (see
+                 *  `make_masked_execinfo`) and the block sizes are not tuned.
+                 */
+                template <class Spec, class Grid, class DataStores>
+                friend void gridtools_backend_masked_entry_point(
+                    cpu_ifirst, Spec, Grid const &grid, activity_mask const &mask, DataStores external_data_stores) {
+                    using thread_pool_t = ThreadPool;
+                    execinfo info = entry_point_impl_::make_masked_execinfo<thread_pool_t, Spec>(grid, mask);
+                    entry_point_impl_::make_stencil<thread_pool_t, Spec>(grid, info, std::bool_constant<Simd>())(
                         std::move(external_data_stores));
+                }
+
+                /**
+                 *  If there are at least as many members as threads, every member is executed by a single thread,
+                 *  blocked for one thread and without tuning. The members are handed out dynamically, the largest
+                 *  first (see `be_api::parallel_for_each_member`).
+                 */
+                template <class Spec, class Members>
+                friend void gridtools_backend_batch_entry_point(cpu_ifirst, Spec spec, Members const &members) {
+                    using thread_pool_t = ThreadPool;
+                    int_t size = members.size();
+                    if (size < thread_pool::get_max_threads(thread_pool_t())) {
+                        for (auto const &member : members)
+                            gridtools_backend_entry_point(cpu_ifirst(), spec, member.grid, member.data_stores);
+                        return;
+                    }
+                    be_api::parallel_for_each_member(thread_pool_t(), members, [&](auto const &member) {
+                        execinfo info = entry_point_impl_::make_stencil_execinfo<thread_pool::dummy, Spec>(member.grid);
+                        entry_point_impl_::make_stencil<thread_pool::dummy, Spec>(
+                            member.grid, info, std::bool_constant<Simd>())(member.data_stores);
+                    });
+                }
+
+                friend std::pair<ThreadPool, cpu_ifirst<thread_pool::dummy, Simd>> gridtools_backend_split(cpu_ifirst) {
+                    return {};
+                }
 
-                    auto data_stores = hymap::concat(std::move(blocked_externals), std::move(temporaries));
-
-                    auto loops = tuple_util::transform(
-                        [&](auto stage) {
-                            using stage_t = decltype(stage);
-                            auto k_sizes = tuple_util::transform(
-                                [&](auto cell) { return grid.k_size(cell.interval()); }, stage_t::cells());
-
-                            using plh_map_t = typename stage_t::plh_map_t;
-                            using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
-                            auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
-                                [&](auto info) {
-                                    return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
-                                },
-                                stage_t::plh_map()));
-                            return make_loop<thread_pool_t, stage_t>(
-                                fuse_all_t(), grid, std::move(composite), std::move(k_sizes));
-                        },
-                        meta::rename<tuple, stages_t>());
-
-                    run_loops<thread_pool_t>(fuse_all_t(), grid, std::move(loops));
+                template <class Spec, class Grid, class DataStores>
+                friend auto gridtools_backend_prepare(cpu_ifirst, Spec, Grid const &grid, DataStores const &) {
+                    using thread_pool_t = ThreadPool;
+                    execinfo info = entry_point_impl_::make_stencil_execinfo<thread_pool_t, Spec>(grid);
+                    apply_tuned_block_sizes(
+                        Spec(), thread_pool_t(), grid, info, entry_point_impl_::fit_ij_caches_f<Spec>());
+                    return entry_point_impl_::make_stencil<thread_pool_t, Spec>(grid, info, std::bool_constant<Simd>());
                 }
             };
         } // namespace cpu_ifirst_backend
@@ -10,9 +10,13 @@
 
 #pragma once
 
+#include <cassert>
+#include <cstddef>
+
 #include "../../common/defs.hpp"
 #include "../../common/host_device.hpp"
 #include "../../thread_pool/concept.hpp"
+#include "../common/activity_mask.hpp"
 
 namespace gridtools {
     namespace stencil {
@@ -40,6 +44,20 @@ namespace gridtools {
                 int_t j_block_size; /** Size of block along j-axis. */
             };
 
+            /**
+             *  @brief Execution info class for MC backend.
+             *  Used for parallel stages that are executed on blocks of several k-levels, see `k_blocking`.
+             */
+            struct execinfo_block_kblocked {
+                int_t i_block;
+                int_t j_block;
+                int_t k_block;
+                int_t k_start;      /** First k-level of the block. */
+                int_t k_size;       /** Number of k-levels of the block. */
+                int_t i_block_size; /** Size of block along i-axis. */
+                int_t j_block_size; /** Size of block along j-axis. */
+            };
+
             /**
              * @brief Helper class for block handling.
              */
@@ -47,6 +65,7 @@ namespace gridtools {
                 int_t m_i_grid_size, m_j_grid_size;
                 int_t m_i_block_size, m_j_block_size;
                 int_t m_i_blocks, m_j_blocks;
+                activity_mask const *m_mask = nullptr;
 
                 GT_FORCE_INLINE static int_t clamped_block_size(
                     int_t grid_size, int_t block_index, int_t block_size, int_t blocks) {
@@ -71,6 +90,45 @@ namespace gridtools {
                     assert(m_i_block_size > 0 && m_j_block_size > 0);
                 }
 
+                /**
+                 * @brief Same as above, but the blocks are shrunk until `tile_bytes(i_block_size, j_block_size)` does
+                 * not exceed `max_tile_bytes`. The i-blocks are kept up to four times longer than the j-blocks.
+                 */
+                template <class ThreadPool, class Grid, class TileBytes>
+                execinfo(ThreadPool thread_pool, const Grid &grid, TileBytes tile_bytes, std::size_t max_tile_bytes)
+                    : execinfo(thread_pool, grid) {
+                    shrink(tile_bytes, max_tile_bytes);
+                }
+
+                /**
+                 * @brief Block decomposition with the given (unclamped) block sizes.
+                 */
+                template <class Grid>
+                execinfo(const Grid &grid, int_t i_block_size, int_t j_block_size)
+                    : m_i_grid_size(grid.i_size()), m_j_grid_size(grid.j_size()), m_i_block_size(i_block_size),
+                      m_j_block_size(j_block_size), m_i_blocks((m_i_grid_size + m_i_block_size - 1) / m_i_block_size),
+                      m_j_blocks((m_j_grid_size + m_j_block_size - 1) / m_j_block_size) {
+                    assert(m_i_block_size > 0 && m_j_block_size > 0);
+                }
+
+                /**
+                 * @brief Shrinks the blocks until `tile_bytes(i_block_size, j_block_size)` does not exceed
+                 * `max_tile_bytes`, see above.
+                 */
+                template <class TileBytes>
+                void shrink(TileBytes tile_bytes, std::size_t max_tile_bytes) {
+                    while (tile_bytes(m_i_block_size, m_j_block_size) > max_tile_bytes) {
+                        if (m_j_block_size > 1 && 4 * m_j_block_size >= m_i_block_size)
+                            m_j_block_size = (m_j_block_size + 1) / 2;
+                        else if (m_i_block_size > 1)
+                            m_i_block_size = (m_i_block_size + 1) / 2;
+                        else
+                            break;
+                    }
+                    m_i_blocks = (m_i_grid_size + m_i_block_size - 1) / m_i_block_size;
+                    m_j_blocks = (m_j_grid_size + m_j_block_size - 1) / m_j_block_size;
+                }
+
                 /**
                  * @brief Computes the effective (clamped) block size and position for k-serial stencils.
                  *
@@ -104,6 +162,20 @@ namespace gridtools {
                         clamped_block_size(m_j_grid_size, j_block_index, m_j_block_size, m_j_blocks)};
                 }
 
+                /**
+                 * @brief Restricts the execution to the blocks with active points of `mask`, which has to outlive the
+                 * execution.
+                 */
+                void set_mask(activity_mask const &mask) { m_mask = &mask; }
+
+                /** @brief Whether the block has to be executed: it has an active point or there is no mask. */
+                GT_FORCE_INLINE bool is_active(int_t i_block_index, int_t j_block_index) const {
+                    return !m_mask || m_mask->any({i_block_index * m_i_block_size,
+                                          (i_block_index + 1) * m_i_block_size,
+                                          j_block_index * m_j_block_size,
+                                          (j_block_index + 1) * m_j_block_size});
+                }
+
                 /** @brief Number of blocks along i-axis. */
                 GT_FORCE_INLINE int_t i_blocks() const { return m_i_blocks; }
                 /** @brief Number of blocks along j-axis. */
@@ -114,6 +186,45 @@ namespace gridtools {
                 /** @brief Unclamped block size along j-axis. */
                 GT_FORCE_INLINE int_t j_block_size() const { return m_j_block_size; }
             };
+
+            /**
+             * @brief Split of the k-axis for the parallel stages that read neighbouring k-levels of temporaries. The
+             * k-axis is split into as many blocks as needed to give every thread at least one (i, j, k)-block.
+             */
+            class k_blocking {
+                int_t m_k_grid_size;
+                int_t m_k_block_size;
+                int_t m_k_blocks;
+
+              public:
+                template <class ThreadPool, class Grid>
+                k_blocking(ThreadPool, Grid const &grid, execinfo const &info) : m_k_grid_size(grid.k_size()) {
+                    int_t ij_blocks = info.i_blocks() * info.j_blocks();
+                    int_t k_blocks = (thread_pool::get_max_threads(ThreadPool()) + ij_blocks - 1) / ij_blocks;
+                    m_k_block_size = (m_k_grid_size + k_blocks - 1) / k_blocks;
+                    if (m_k_block_size < 1)
+                        m_k_block_size = 1;
+                    m_k_blocks = (m_k_grid_size + m_k_block_size - 1) / m_k_block_size;
+                }
+
+                /**
+                 * @brief Computes the effective (clamped) block sizes and position for k-blocked stencils.
+                 */
+                GT_FORCE_INLINE execinfo_block_kblocked block(
+                    execinfo const &info, int_t i_block_index, int_t j_block_index, int_t k_block_index) const {
+                    auto ij = info.block(i_block_index, j_block_index);
+                    int_t k_start = k_block_index * m_k_block_size;
+                    int_t k_size = k_block_index == m_k_blocks - 1 ? m_k_grid_size - k_start : m_k_block_size;
+                    return {
+                        i_block_index, j_block_index, k_block_index, k_start, k_size, ij.i_block_size, ij.j_block_size};
+                }
+
+                /** @brief Number of blocks along k-axis. */
+                GT_FORCE_INLINE int_t k_blocks() const { return m_k_blocks; }
+
+                /** @brief Unclamped block size along k-axis. */
+                GT_FORCE_INLINE int_t k_block_size() const { return m_k_block_size; }
+            };
         } // namespace cpu_ifirst_backend
     }     // namespace stencil
 } // namespace gridtools
@@ -0,0 +1,121 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+
+#include "../../common/defs.hpp"
+#include "../../meta.hpp"
+#include "../be_api.hpp"
+#include "../common/caches.hpp"
+#include "execinfo.hpp"
+#include "pos3.hpp"
+#include "tmp_storage_sid.hpp"
+
+/**
+ *   @file
+ *
+ *   IJ-caches for the k-parallel execution of cpu_ifirst.
+ *
+ *   In the k-parallel mode the temporaries are per-thread tiles without k-dimension, so an ij-cached temporary is
+ *   just a regular temporary. What makes the cache effective is the size of the tile: the i/j-blocks are shrunk until
+ *   all ij-cached temporaries of a thread fit into the per-core cache together. By default half of the L2 cache is
+ *   used, the budget (in bytes) can be overridden by the environment variable `GT_CPU_IFIRST_IJ_CACHE_SIZE`.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace ij_cache_impl_ {
+                template <class PlhInfo>
+                using is_ij_cached = meta::st_contains<typename PlhInfo::caches_t, cache_type::ij>;
+
+                /**
+                 *  The plh infos of the ij-cached temporaries.
+                 */
+                template <class PlhMap>
+                using ij_cache_plh_map = meta::filter<is_ij_cached, meta::rename<meta::list, PlhMap>>;
+
+                inline std::size_t l2_cache_size() {
+                    std::size_t res = 256 * 1024;
+                    if (auto *fp = std::fopen("/sys/devices/system/cpu/cpu0/cache/index2/size", "r")) {
+                        std::size_t kb;
+                        if (std::fscanf(fp, "%zuK", &kb) == 1)
+                            res = kb * 1024;
+                        std::fclose(fp);
+                    }
+                    return res;
+                }
+
+                /**
+                 *  Budget for the ij-cached temporaries of a single thread in bytes.
+                 */
+                inline std::size_t ij_cache_size() {
+                    static const std::size_t value = [] {
+                        if (const char *env_value = std::getenv("GT_CPU_IFIRST_IJ_CACHE_SIZE"))
+                            return (std::size_t)std::atoll(env_value);
+                        return l2_cache_size() / 2;
+                    }();
+                    return value;
+                }
+
+                template <class T, class Extent>
+                std::size_t tile_bytes(pos3<std::size_t> const &block_size) {
+                    auto bs = _impl_tmp::full_block_size<T, Extent>(block_size);
+                    return bs.i * bs.j * bs.k * sizeof(T);
+                }
+
+                template <class PlhInfos>
+                struct tile_bytes_f;
+
+                /**
+                 *  Size in bytes of the tiles of the given temporaries for the given block size.
+                 */
+                template <class... PlhInfos>
+                struct tile_bytes_f<meta::list<PlhInfos...>> {
+                    std::size_t operator()(int_t i_block_size, int_t j_block_size) const {
+                        auto block_size = make_pos3<std::size_t>(i_block_size, j_block_size, 1);
+                        return (tile_bytes<typename PlhInfos::data_t, typename PlhInfos::extent_t>(block_size) + ...);
+                    }
+                };
+
+                template <class ThreadPool, class PlhInfos, class Grid>
+                std::enable_if_t<meta::is_empty<PlhInfos>::value, execinfo> make_execinfo(Grid const &grid) {
+                    return {ThreadPool(), grid};
+                }
+
+                /**
+                 *  Block decomposition such that the ij-cached temporaries `PlhInfos` fit into the cache budget.
+                 */
+                template <class ThreadPool, class PlhInfos, class Grid>
+                std::enable_if_t<!meta::is_empty<PlhInfos>::value, execinfo> make_execinfo(Grid const &grid) {
+                    return {ThreadPool(), grid, tile_bytes_f<PlhInfos>(), ij_cache_size()};
+                }
+
+                /**
+                 *  Shrinks the blocks of `info` such that the ij-cached temporaries `PlhInfos` fit into the cache
+                 *  budget, used for block sizes that don't come from `make_execinfo`.
+                 */
+                template <class PlhInfos>
+                void fit_ij_caches(execinfo &info) {
+                    if constexpr (!meta::is_empty<PlhInfos>::value)
+                        info.shrink(tile_bytes_f<PlhInfos>(), ij_cache_size());
+                }
+            } // namespace ij_cache_impl_
+
+            using ij_cache_impl_::fit_ij_caches;
+            using ij_cache_impl_::ij_cache_plh_map;
+            using ij_cache_impl_::ij_cache_size;
+            using ij_cache_impl_::make_execinfo;
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+} // namespace gridtools
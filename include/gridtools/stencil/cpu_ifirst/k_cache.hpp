@@ -0,0 +1,248 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+
+#include "../../common/defs.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/synthetic.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../be_api.hpp"
+#include "../common/dim.hpp"
+#include "tmp_storage_sid.hpp"
+
+/**
+ *   @file
+ *
+ *   K-caches for the k-serial execution of cpu_ifirst.
+ *
+ *   In the k-serial mode a stage is executed row by row: for every j-row of a block the k-levels are visited in order
+ *   and each level is an i-loop. A k-cached temporary that is local to a single stage (no fill/flush policy, not used
+ *   by any other stage, accessed without horizontal offsets) therefore only needs the levels of the k-cache window of
+ *   the current row. Such temporaries are allocated as per-thread rolling buffers of `window - 1 + period` i-rows.
+ *   The pointer advances by one row per k-level; every `period` levels the live part of the window is copied back to
+ *   the start of the buffer and the pointer is rewound.
+ *
+ *   The buffer is laid out in the direction of the execution (the k-stride is negative for backward stages), this
+ *   way the pointer always moves forward in memory.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace k_cache_impl_ {
+                // minimal number of k-levels between two rewinds of a rolling buffer
+                using min_rewind_period_t = integral_constant<int_t, 8>;
+
+                template <class Stage, class PlhInfo, class RewindPeriod>
+                struct k_cache_info {
+                    using plh_t = typename PlhInfo::plh_t;
+                    using key_t = typename PlhInfo::key_t;
+                    using data_t = typename PlhInfo::data_t;
+                    using extent_t = typename PlhInfo::extent_t;
+                    using stage_t = Stage;
+
+                    static constexpr bool is_backward = be_api::is_backward<typename Stage::execution_t>::value;
+
+                    // number of levels behind and in front of the current one in the direction of the execution
+                    using lag_t =
+                        integral_constant<int_t, is_backward ? extent_t::kplus::value : -extent_t::kminus::value>;
+                    using lead_t =
+                        integral_constant<int_t, is_backward ? -extent_t::kminus::value : extent_t::kplus::value>;
+                    using window_t = integral_constant<int_t, lag_t::value + lead_t::value + 1>;
+                    using levels_t =
+                        integral_constant<int_t, window_t::value == 1 ? 1 : window_t::value - 1 + RewindPeriod::value>;
+                    using k_step_t = integral_constant<int_t, window_t::value == 1 ? 0 : is_backward ? -1 : 1>;
+                    using rewind_period_t = RewindPeriod;
+
+                    static plh_t plh() { return {}; }
+                    static key_t key() { return {}; }
+                    static data_t data();
+                };
+
+                template <class PlhInfos>
+                struct rewind_period;
+
+                template <class... PlhInfos>
+                struct rewind_period<meta::list<PlhInfos...>> {
+                    static constexpr int_t max_lag_and_lead() {
+                        int_t res = 0;
+                        ((res = std::max(res, PlhInfos::extent_t::kplus::value - PlhInfos::extent_t::kminus::value)),
+                            ...);
+                        return res;
+                    }
+                    using type = integral_constant<int_t, std::max(min_rewind_period_t::value, max_lag_and_lead())>;
+                };
+
+                template <class Stages, class Stage>
+                struct make_stage_k_cache_infos {
+                    using plh_infos_t = meta::filter<be_api::is_local_k_cache_f<Stages, Stage>::template apply,
+                        meta::rename<meta::list, typename Stage::plh_map_t>>;
+                    using period_t = typename rewind_period<plh_infos_t>::type;
+
+                    template <class PlhInfo>
+                    using make_info = k_cache_info<Stage, PlhInfo, period_t>;
+
+                    using type = meta::transform<make_info, plh_infos_t>;
+                };
+
+                template <class Stages>
+                struct stage_k_cache_infos_f {
+                    template <class Stage>
+                    using apply = typename make_stage_k_cache_infos<Stages, Stage>::type;
+                };
+
+                /**
+                 *  The list of `k_cache_info`s of the given stage.
+                 */
+                template <class Stages, class Stage>
+                using stage_k_cache_infos = typename make_stage_k_cache_infos<meta::rename<meta::list, Stages>,
+                    Stage>::type;
+
+                /**
+                 *  The list of `k_cache_info`s of all stages.
+                 */
+                template <class Stages, class StageList = meta::rename<meta::list, Stages>>
+                using k_cache_infos =
+                    meta::flatten<meta::transform<stage_k_cache_infos_f<StageList>::template apply, StageList>>;
+
+                template <class Infos>
+                struct is_not_rolling_f {
+                    template <class PlhInfo>
+                    using apply = std::negation<
+                        meta::st_contains<meta::transform<be_api::get_plh, Infos>, typename PlhInfo::plh_t>>;
+                };
+
+                /**
+                 *  Removes the temporaries that are held in rolling buffers from the plh map.
+                 */
+                template <class PlhMap, class Infos>
+                using remove_rolling_k_caches = meta::filter<is_not_rolling_f<Infos>::template apply, PlhMap>;
+
+                template <class Info>
+                struct strides_kind {};
+
+                template <class Info>
+                std::size_t row_size(std::size_t i_block_size) {
+                    return _impl_tmp::pad<typename Info::data_t>(Info::extent_t::extend(dim::i(), i_block_size));
+                }
+
+                /**
+                 *  Rolling buffer SID for the k-cached temporary described by `Info`.
+                 *
+                 *  The origin is placed such that the pointer lands on the first row of the window after the
+                 *  stage loop shifted it to the first computed point of the stage interval.
+                 */
+                template <class ThreadPool, class Info, class Allocator, class Grid>
+                auto make_k_cache_storage(Info, Allocator &allocator, Grid const &grid, std::size_t i_block_size) {
+                    using data_t = typename Info::data_t;
+                    using stage_t = typename Info::stage_t;
+                    int_t row = row_size<Info>(i_block_size);
+                    int_t thread_stride = _impl_tmp::pad<data_t>(row * Info::levels_t::value);
+                    int_t k_stride = row * Info::k_step_t::value;
+                    constexpr std::size_t extra =
+                        (_impl_tmp::byte_alignment::value + sizeof(data_t) - 1) / sizeof(data_t);
+                    int_t origin_offset = Info::lag_t::value * row - Info::extent_t::iminus::value -
+                                          grid.k_start(stage_t::interval(), stage_t::execution()) * k_stride;
+                    return sid::synthetic()
+                        .set<sid::property::origin>(allocate(allocator,
+                                                        meta::lazy::id<data_t>(),
+                                                        thread_stride * thread_pool::get_max_threads(ThreadPool()) +
+                                                            extra) +
+                                                    origin_offset)
+                        .template set<sid::property::strides>(
+                            hymap::keys<dim::i, dim::k, dim::thread>::make_values(
+                                integral_constant<int_t, 1>(), k_stride, thread_stride))
+                        .template set<sid::property::strides_kind, strides_kind<Info>>()
+                        .template set<sid::property::ptr_diff, int_t>();
+                }
+
+                /**
+                 *  Runtime state of the rolling buffers of a stage within a block.
+                 *
+                 *  `reset` must be called at the start of each row, `slide` after each k-increment.
+                 */
+                template <class Infos, class Homes>
+                class k_caches {
+                    Homes m_homes;
+                    int_t m_count = 0;
+
+                  public:
+                    k_caches(Homes homes) : m_homes(std::move(homes)) {}
+
+                    template <class Ptr>
+                    GT_FORCE_INLINE void reset(Ptr &ptr) {
+                        m_count = 0;
+                        tuple_util::for_each(
+                            [&ptr](auto info, auto home) {
+                                host_device::at_key<decltype(info.key())>(ptr) = home;
+                            },
+                            meta::rename<tuple, Infos>(),
+                            m_homes);
+                    }
+
+                    template <class Ptr, class Strides>
+                    GT_FORCE_INLINE void slide(Ptr &ptr, Strides const &strides) {
+                        if (++m_count < meta::first<Infos>::rewind_period_t::value)
+                            return;
+                        tuple_util::for_each(
+                            [&](auto info, auto home) {
+                                using info_t = decltype(info);
+                                using key_t = decltype(info.key());
+                                int_t row =
+                                    sid::get_stride_element<key_t, dim::k>(strides) * info_t::k_step_t::value;
+                                auto cur = host_device::at_key<key_t>(ptr);
+                                std::copy_n(cur - info_t::lag_t::value * row,
+                                    (info_t::window_t::value - 1) * row,
+                                    home - info_t::lag_t::value * row);
+                            },
+                            meta::rename<tuple, Infos>(),
+                            m_homes);
+                        reset(ptr);
+                    }
+                };
+
+                struct no_k_caches {
+                    template <class Ptr>
+                    GT_FORCE_INLINE void reset(Ptr &) {}
+
+                    template <class Ptr, class Strides>
+                    GT_FORCE_INLINE void slide(Ptr &, Strides const &) {}
+                };
+
+                template <class Infos, class Ptr, std::enable_if_t<meta::is_empty<Infos>::value, int> = 0>
+                no_k_caches make_k_caches(Ptr const &) {
+                    return {};
+                }
+
+                template <class Infos, class Ptr, std::enable_if_t<!meta::is_empty<Infos>::value, int> = 0>
+                auto make_k_caches(Ptr const &ptr) {
+                    auto homes = tuple_util::transform(
+                        [&ptr](auto info) { return host_device::at_key<decltype(info.key())>(ptr); },
+                        meta::rename<tuple, Infos>());
+                    return k_caches<Infos, decltype(homes)>(std::move(homes));
+                }
+            } // namespace k_cache_impl_
+
+            using k_cache_impl_::k_cache_infos;
+            using k_cache_impl_::make_k_cache_storage;
+            using k_cache_impl_::make_k_caches;
+            using k_cache_impl_::remove_rolling_k_caches;
+            using k_cache_impl_::stage_k_cache_infos;
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+} // namespace gridtools
@@ -9,57 +9,152 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
 #include "../../common/defs.hpp"
 #include "../../common/for_each.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
 #include "../../common/omp.hpp"
 #include "../../common/tuple_util.hpp"
 #include "../../meta.hpp"
 #include "../../sid/concept.hpp"
 #include "../../thread_pool/concept.hpp"
+#include "../be_api.hpp"
 #include "../common/dim.hpp"
+#include "../reduction_output.hpp"
 #include "execinfo.hpp"
+#include "k_cache.hpp"
+#include "simd.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_ifirst_backend {
             namespace loops_impl_ {
-                template <class Stage, class Ptr, class Strides>
-                GT_FORCE_INLINE void i_loop(int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                template <class Ptr>
+                struct is_reduction_key_f {
+                    template <class Key>
+                    using apply = is_reduction_ptr<
+                        std::decay_t<decltype(host_device::at_key<Key>(std::declval<Ptr const &>()))>>;
+                };
+
+                template <class Ptr>
+                using has_reduction_output = meta::any_of<is_reduction_key_f<Ptr>::template apply, get_keys<Ptr>>;
+
+                template <class Dim, class Stage, class Ptr, class Strides>
+                GT_FORCE_INLINE void inner_loop(
+                    std::false_type, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    using namespace literals;
+                    if constexpr (has_reduction_output<Ptr>::value) {
+                        // the accumulation into a reduction output is a dependency between the iterations
+                        for (int_t i = 0; i < size; ++i) {
+                            stage(ptr, strides);
+                            sid::shift(ptr, sid::get_stride<Dim>(strides), 1_c);
+                        }
+                    } else {
 #pragma omp simd
-                    for (int_t i = 0; i < size; ++i) {
-                        using namespace literals;
+                        for (int_t i = 0; i < size; ++i) {
+                            stage(ptr, strides);
+                            sid::shift(ptr, sid::get_stride<Dim>(strides), 1_c);
+                        }
+                    }
+                    sid::shift(ptr, sid::get_stride<Dim>(strides), -size);
+                }
+
+                // stages that can not be vectorized explicitly fall back to the scalar loop
+                template <class Dim,
+                    class Stage,
+                    class Ptr,
+                    class Strides,
+                    int W = is_simd_stage<Stage>::value ? simd_width<Ptr, Strides, Dim> : 0,
+                    std::enable_if_t<W == 0, int> = 0>
+                GT_FORCE_INLINE void inner_loop(
+                    std::true_type, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    inner_loop<Dim>(std::false_type(), size, stage, ptr, strides);
+                }
+
+                template <class Dim,
+                    class Stage,
+                    class Ptr,
+                    class Strides,
+                    int W = is_simd_stage<Stage>::value ? simd_width<Ptr, Strides, Dim> : 0,
+                    std::enable_if_t<W != 0, int> = 0>
+                GT_FORCE_INLINE void inner_loop(
+                    std::true_type, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    using namespace literals;
+                    auto &&stride = sid::get_stride<Dim>(strides);
+                    int_t i = 0;
+                    for (; i + W <= size; i += W) {
+                        stage.template operator()<deref_f<Strides, W, Dim>>(ptr, strides);
+                        sid::shift(ptr, stride, integral_constant<int_t, W>());
+                    }
+                    for (; i < size; ++i) {
                         stage(ptr, strides);
+                        sid::shift(ptr, stride, 1_c);
+                    }
+                    sid::shift(ptr, stride, -size);
+                }
+
+                template <class Simd, class Stage, class Ptr, class Strides>
+                GT_FORCE_INLINE void i_loop(Simd, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    inner_loop<dim::i>(Simd(), size, stage, ptr, strides);
+                }
+
+                /**
+                 *  The loop mode of the ensembles: every point along i is computed for the `members` members of the
+                 *  ensemble, which are contiguous along `dim::e`. With `Simd` set, the members are processed with
+                 *  explicit SIMD vectors.
+                 */
+                template <class Simd>
+                struct ensemble_loop {
+                    int_t members;
+                };
+
+                template <class Simd, class Stage, class Ptr, class Strides>
+                GT_FORCE_INLINE void i_loop(
+                    ensemble_loop<Simd> mode, int_t size, Stage stage, Ptr &ptr, Strides const &strides) {
+                    using namespace literals;
+                    for (int_t i = 0; i < size; ++i) {
+                        inner_loop<dim::e>(Simd(), mode.members, stage, ptr, strides);
                         sid::shift(ptr, sid::get_stride<dim::i>(strides), 1_c);
                     }
                     sid::shift(ptr, sid::get_stride<dim::i>(strides), -size);
                 }
 
-                template <class Ptr, class Strides>
+                template <class Simd, class Ptr, class Strides, class KCaches>
                 struct k_i_loops_f {
+                    Simd m_simd;
                     int_t m_i_size;
                     Ptr &m_ptr;
                     Strides const &m_strides;
+                    KCaches &m_k_caches;
 
                     template <class Cell, class KSize>
                     GT_FORCE_INLINE void operator()(Cell cell, KSize k_size) const {
                         for (int_t k = 0; k < k_size; ++k) {
-                            i_loop(m_i_size, cell, m_ptr, m_strides);
+                            i_loop(m_simd, m_i_size, cell, m_ptr, m_strides);
                             cell.inc_k(m_ptr, m_strides);
+                            m_k_caches.slide(m_ptr, m_strides);
                         }
                     }
                 };
 
-                template <class Ptr, class Strides>
-                GT_FORCE_INLINE k_i_loops_f<Ptr, Strides> make_k_i_loops(
-                    int_t i_size, Ptr &ptr, Strides const &strides) {
-                    return {i_size, ptr, strides};
+                template <class Simd, class Ptr, class Strides, class KCaches>
+                GT_FORCE_INLINE k_i_loops_f<Simd, Ptr, Strides, KCaches> make_k_i_loops(
+                    Simd simd, int_t i_size, Ptr &ptr, Strides const &strides, KCaches &k_caches) {
+                    return {simd, i_size, ptr, strides, k_caches};
                 }
 
-                template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
-                auto make_loop(std::true_type, Grid const &grid, Composite composite, KSizes k_sizes) {
+                template <class ThreadPool,
+                    class Stage,
+                    class KCacheInfos,
+                    class Simd,
+                    class Grid,
+                    class Composite,
+                    class KSizes>
+                auto make_loop(std::true_type, Simd simd, Grid const &grid, Composite composite, KSizes k_sizes) {
                     using extent_t = typename Stage::extent_t;
                     using ptr_diff_t = sid::ptr_diff_type<Composite>;
                     auto strides = sid::get_strides(composite);
@@ -68,6 +163,7 @@ namespace gridtools {
                     sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
                     return [origin = sid::get_origin(composite) + offset,
                                strides = std::move(strides),
+                               simd,
                                k_start = grid.k_start(Stage::interval()),
                                k_sizes = std::move(k_sizes)](execinfo_block_kparallel const &info) {
                         ptr_diff_t offset{};
@@ -85,9 +181,9 @@ namespace gridtools {
                             using namespace literals;
                             int_t cur = k_start;
                             tuple_util::for_each(
-                                [&ptr, &strides, &cur, k = info.k, i_size](auto cell, auto k_size) {
+                                [&ptr, &strides, &cur, &simd, k = info.k, i_size](auto cell, auto k_size) {
                                     if (k >= cur && k < cur + k_size)
-                                        i_loop(i_size, cell, ptr, strides);
+                                        i_loop(simd, i_size, cell, ptr, strides);
                                     cur += k_size;
                                 },
                                 Stage::cells(),
@@ -97,24 +193,123 @@ namespace gridtools {
                     };
                 }
 
-                template <class ThreadPool, class Grid, class Loops>
-                void run_loops(std::true_type, Grid const &grid, Loops loops) {
-                    execinfo info(ThreadPool(), grid);
+                /**
+                 *  `LoopGroups` is a tuple of the groups of independent passes, each of them is a tuple of loops.
+                 *  The blocks of the different groups are executed concurrently.
+                 */
+                template <class ThreadPool, class Grid, class LoopGroups>
+                void run_loops(std::true_type, Grid const &grid, execinfo const &info, LoopGroups groups) {
                     int_t i_blocks = info.i_blocks();
                     int_t j_blocks = info.j_blocks();
                     int_t k_size = grid.k_size();
+                    // the group index is folded into the outermost dimension
                     thread_pool::parallel_for_loop(
                         ThreadPool(),
-                        [&](auto i, auto k, auto j) {
-                            tuple_util::for_each([block = info.block(i, j, k)](auto &&loop) { loop(block); }, loops);
+                        [&](auto i, auto k, auto jg) {
+                            int_t j = jg % j_blocks;
+                            if (!info.is_active(i, j))
+                                return;
+                            be_api::visit_group(groups, jg / j_blocks, [block = info.block(i, j, k)](auto &&loops) {
+                                tuple_util::for_each([&](auto &&loop) { loop(block); }, loops);
+                            });
                         },
                         i_blocks,
                         k_size,
-                        j_blocks);
+                        j_blocks * tuple_util::size<LoopGroups>::value);
+                }
+
+                /**
+                 *  The execution mode of the parallel stages that are executed on (i, j, k)-blocks, see `k_blocking`.
+                 *  Each stage computes the levels of the block extended by its k-extent (see `stage_k_extents`), thus
+                 *  the temporaries hold the k-levels of a block including the k-halo. The other modes are
+                 *  `std::true_type` (one k-level per block, no k-extents) and `std::false_type` (the whole k-axis is
+                 *  processed serially).
+                 */
+                struct k_blocked {};
+
+                template <class ThreadPool,
+                    class Stage,
+                    class KCacheInfos,
+                    class Simd,
+                    class Grid,
+                    class Composite,
+                    class KSizes,
+                    class KExtent>
+                auto make_loop(k_blocked, Simd simd, Grid const &grid, Composite composite, KSizes k_sizes, KExtent) {
+                    using extent_t = typename Stage::extent_t;
+                    using ptr_diff_t = sid::ptr_diff_type<Composite>;
+                    auto strides = sid::get_strides(composite);
+                    ptr_diff_t offset{};
+                    sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
+                    sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
+                    return [origin = sid::get_origin(composite) + offset,
+                               strides = std::move(strides),
+                               simd,
+                               k_start = grid.k_start(Stage::interval()),
+                               k_sizes = std::move(k_sizes)](execinfo_block_kblocked const &info) {
+                        ptr_diff_t offset{};
+                        sid::shift(
+                            offset, sid::get_stride<dim::thread>(strides), thread_pool::get_thread_num(ThreadPool()));
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::i>>(strides), info.i_block);
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::j>>(strides), info.j_block);
+                        sid::shift(offset, sid::get_stride<sid::blocked_dim<dim::k>>(strides), info.k_block);
+                        auto block_ptr = origin() + offset;
+
+                        int_t j_count = extent_t::extend(dim::j(), info.j_block_size);
+                        int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
+
+                        // the levels of the block extended by the k-extent, clipped to the intervals of the cells
+                        int_t k_from = info.k_start + KExtent::kminus::value;
+                        int_t k_to = info.k_start + info.k_size + KExtent::kplus::value;
+                        int_t cur = k_start;
+                        tuple_util::for_each(
+                            [&](auto cell, auto k_size) {
+                                int_t first = std::max(cur, k_from);
+                                int_t last = std::min(cur + k_size, k_to);
+                                cur += k_size;
+                                for (int_t k = first; k < last; ++k) {
+                                    using namespace literals;
+                                    auto ptr = block_ptr;
+                                    sid::shift(ptr, sid::get_stride<dim::k>(strides), k - info.k_start);
+                                    for (int_t j = 0; j < j_count; ++j) {
+                                        i_loop(simd, i_size, cell, ptr, strides);
+                                        sid::shift(ptr, sid::get_stride<dim::j>(strides), 1_c);
+                                    }
+                                }
+                            },
+                            Stage::cells(),
+                            k_sizes);
+                    };
+                }
+
+                template <class ThreadPool, class Grid, class LoopGroups>
+                void run_loops(k_blocked, Grid const &grid, execinfo const &info, LoopGroups groups) {
+                    k_blocking blocking(ThreadPool(), grid, info);
+                    int_t j_blocks = info.j_blocks();
+                    thread_pool::parallel_for_loop(
+                        ThreadPool(),
+                        [&](auto i, auto k, auto jg) {
+                            int_t j = jg % j_blocks;
+                            if (!info.is_active(i, j))
+                                return;
+                            auto block = blocking.block(info, i, j, k);
+                            be_api::visit_group(groups, jg / j_blocks, [&block](auto &&loops) {
+                                tuple_util::for_each([&](auto &&loop) { loop(block); }, loops);
+                            });
+                        },
+                        info.i_blocks(),
+                        blocking.k_blocks(),
+                        j_blocks * tuple_util::size<LoopGroups>::value);
                 }
 
-                template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
-                auto make_loop(std::false_type, Grid const &grid, Composite composite, KSizes k_sizes) {
+                template <class ThreadPool,
+                    class Stage,
+                    class KCacheInfos,
+                    class Simd,
+                    class Grid,
+                    class Composite,
+                    class KSizes>
+                auto make_loop(std::false_type, Simd simd, Grid const &grid, Composite composite, KSizes k_sizes) {
                     using extent_t = typename Stage::extent_t;
                     using ptr_diff_t = sid::ptr_diff_type<Composite>;
 
@@ -127,6 +322,7 @@ namespace gridtools {
 
                     return [origin = sid::get_origin(composite) + offset,
                                strides = std::move(strides),
+                               simd,
                                k_shift_back = -grid.k_size(Stage::interval()) * Stage::k_step(),
                                k_sizes = std::move(k_sizes)](execinfo_block_kserial const &info) {
                         sid::ptr_diff_type<Composite> offset{};
@@ -139,9 +335,11 @@ namespace gridtools {
                         int_t j_size = extent_t::extend(dim::j(), info.j_block_size);
                         int_t i_size = extent_t::extend(dim::i(), info.i_block_size);
 
-                        auto k_i_loops = make_k_i_loops(i_size, ptr, strides);
+                        auto k_caches = make_k_caches<KCacheInfos>(ptr);
+                        auto k_i_loops = make_k_i_loops(simd, i_size, ptr, strides, k_caches);
                         for (int_t j = 0; j < j_size; ++j) {
                             using namespace literals;
+                            k_caches.reset(ptr);
                             tuple_util::for_each(k_i_loops, Stage::cells(), k_sizes);
                             sid::shift(ptr, sid::get_stride<dim::k>(strides), k_shift_back);
                             sid::shift(ptr, sid::get_stride<dim::j>(strides), 1_c);
@@ -149,18 +347,24 @@ namespace gridtools {
                     };
                 }
 
-                template <class ThreadPool, class Grid, class Loops>
-                void run_loops(std::false_type, Grid const &grid, Loops loops) {
-                    execinfo info(ThreadPool(), grid);
+                template <class ThreadPool, class Grid, class LoopGroups>
+                void run_loops(std::false_type, Grid const &, execinfo const &info, LoopGroups groups) {
                     thread_pool::parallel_for_loop(
                         ThreadPool(),
-                        [&](auto i, auto j) {
-                            tuple_util::for_each([block = info.block(i, j)](auto &&loop) { loop(block); }, loops);
+                        [&](auto i, auto j, auto group) {
+                            if (!info.is_active(i, j))
+                                return;
+                            be_api::visit_group(groups, group, [block = info.block(i, j)](auto &&loops) {
+                                tuple_util::for_each([&](auto &&loop) { loop(block); }, loops);
+                            });
                         },
                         info.i_blocks(),
-                        info.j_blocks());
+                        info.j_blocks(),
+                        tuple_util::size<LoopGroups>());
                 }
             } // namespace loops_impl_
+            using loops_impl_::ensemble_loop;
+            using loops_impl_::k_blocked;
             using loops_impl_::make_loop;
             using loops_impl_::run_loops;
         } // namespace cpu_ifirst_backend
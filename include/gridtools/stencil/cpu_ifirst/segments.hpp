@@ -0,0 +1,323 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+
+#include "../../meta.hpp"
+#include "../be_api.hpp"
+#include "../common/extent.hpp"
+#include "loops.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace segments_impl_ {
+                template <class Mode, class Indices>
+                struct segment {
+                    using mode_t = Mode;
+                    using indices_t = Indices;
+                };
+
+                template <class Segment>
+                using get_mode = typename Segment::mode_t;
+
+                template <class Segment>
+                using get_indices = typename Segment::indices_t;
+
+                template <class Segments>
+                struct last_mode {
+                    using type = void;
+                };
+
+                template <class Segment, class... Segments>
+                struct last_mode<meta::list<Segment, Segments...>> {
+                    using type = get_mode<meta::last<meta::list<Segment, Segments...>>>;
+                };
+
+                template <class Stages>
+                struct is_parallel_at_f {
+                    template <class I>
+                    using apply = typename be_api::is_parallel<typename meta::at<Stages, I>::execution_t>::type;
+                };
+
+                // consecutive stages with the same execution policy (parallel or not) form a segment
+                template <class Stages>
+                struct add_stage_f {
+                    template <class Segments, class I, class = void>
+                    struct apply_impl {
+                        using type = meta::push_back<Segments,
+                            segment<typename is_parallel_at_f<Stages>::template apply<I>, meta::list<I>>>;
+                    };
+
+                    template <class Segments, class I>
+                    struct apply_impl<Segments,
+                        I,
+                        std::enable_if_t<std::is_same_v<typename last_mode<Segments>::type,
+                            typename is_parallel_at_f<Stages>::template apply<I>>>> {
+                        using last_t = meta::last<Segments>;
+                        using type = meta::push_back<meta::pop_back<Segments>,
+                            segment<get_mode<last_t>, meta::push_back<get_indices<last_t>, I>>>;
+                    };
+
+                    template <class Segments, class I>
+                    using apply = typename apply_impl<Segments, I>::type;
+                };
+
+                template <class Stages>
+                struct get_plh_map_f {
+                    template <class I>
+                    using apply = typename meta::at<Stages, I>::plh_map_t;
+                };
+
+                template <class Stages>
+                struct stage_at_f {
+                    template <class I>
+                    using apply = meta::at<Stages, I>;
+                };
+
+                template <class Extent>
+                using to_vertical_extent = extent<0, 0, 0, 0, Extent::kminus::value, Extent::kplus::value>;
+
+                template <class PlhInfo>
+                using is_tmp = typename PlhInfo::is_tmp_t;
+
+                template <class PlhInfo>
+                using is_written_tmp = std::bool_constant<PlhInfo::is_tmp_t::value && !PlhInfo::is_const_t::value>;
+
+                template <class PlhInfo>
+                using is_written_field = std::bool_constant<!PlhInfo::is_tmp_t::value && !PlhInfo::is_const_t::value>;
+
+                template <class Plh>
+                struct has_key_f {
+                    template <class Item>
+                    using apply = std::is_same<meta::first<Item>, Plh>;
+                };
+
+                // the k-extent map is a list of (placeholder, k-extent) pairs, a placeholder can appear several times
+                template <class Map, class Plh>
+                using lookup_k_extent = meta::rename<enclosing_extent,
+                    meta::transform<meta::second, meta::filter<has_key_f<Plh>::template apply, Map>>>;
+
+                template <class Map>
+                struct lookup_k_extent_f {
+                    template <class PlhInfo>
+                    using apply = lookup_k_extent<Map, typename PlhInfo::plh_t>;
+                };
+
+                template <class Extent>
+                struct add_access_f {
+                    template <class PlhInfo>
+                    using apply = meta::list<typename PlhInfo::plh_t,
+                        sum_extent<Extent, to_vertical_extent<typename PlhInfo::extent_t>>>;
+                };
+
+                // The stages are processed from the last one to the first one. A stage has to compute the k-levels
+                // at which its temporaries are accessed by the following stages, and accesses its own temporaries at
+                // these levels shifted by the k-extents of the accessors. The state is the pair of the k-extent map
+                // of the temporaries and the list of the k-extents of the processed stages.
+                template <class State,
+                    class Stage,
+                    class Map = meta::first<State>,
+                    class PlhInfos = meta::rename<meta::list, typename Stage::plh_map_t>,
+                    class Extent = meta::rename<enclosing_extent,
+                        meta::transform<lookup_k_extent_f<Map>::template apply,
+                            meta::filter<is_written_tmp, PlhInfos>>>>
+                using add_stage_k_extent = meta::list<
+                    meta::concat<Map,
+                        meta::transform<add_access_f<Extent>::template apply, meta::filter<is_tmp, PlhInfos>>>,
+                    meta::push_front<meta::second<State>, Extent>>;
+
+                template <class Stages>
+                using k_extents =
+                    meta::foldl<add_stage_k_extent, meta::list<meta::list<>, meta::list<>>, meta::reverse<Stages>>;
+
+                template <class Stage, class Extent>
+                using writes_fields_at_k_offsets = std::bool_constant<!std::is_same_v<Extent, extent<>> &&
+                                                                      !meta::is_empty<meta::filter<is_written_field,
+                                                                          typename Stage::plh_map_t>>::value>;
+
+                template <class PlhInfo, class Extent = typename PlhInfo::extent_t>
+                using is_written_field_accessed_at_k_offsets = std::bool_constant<is_written_field<PlhInfo>::value &&
+                                                                                  (Extent::kminus::value != 0 ||
+                                                                                      Extent::kplus::value != 0)>;
+
+                // Parallel stages can be k-blocked if the fields they write are accessed at the current k-level
+                // only, neighbouring k-blocks would otherwise read and write the same levels concurrently. For the
+                // same reason the stages that compute several k-levels around a block must write temporaries only.
+                template <class Stages,
+                    class Indices,
+                    class SegmentStages = meta::transform<stage_at_f<Stages>::template apply, Indices>,
+                    class PlhMap = meta::rename<be_api::merge_plh_maps,
+                        meta::transform<get_plh_map_f<Stages>::template apply, Indices>>>
+                using can_be_k_blocked =
+                    std::bool_constant<!meta::any_of<is_written_field_accessed_at_k_offsets, PlhMap>::value &&
+                                       !meta::rename<std::disjunction,
+                                           meta::transform<writes_fields_at_k_offsets,
+                                               SegmentStages,
+                                               meta::second<k_extents<SegmentStages>>>>::value>;
+
+                template <class Info, class Extent>
+                struct widen_extent;
+
+                template <class Key,
+                    class IsTmp,
+                    class Data,
+                    class NumColors,
+                    class IsConst,
+                    class Extent,
+                    class CacheIoPolicies,
+                    class Other>
+                struct widen_extent<be_api::plh_info<Key, IsTmp, Data, NumColors, IsConst, Extent, CacheIoPolicies>,
+                    Other> {
+                    using type = be_api::plh_info<Key,
+                        IsTmp,
+                        Data,
+                        NumColors,
+                        IsConst,
+                        enclosing_extent<Extent, Other>,
+                        CacheIoPolicies>;
+                };
+
+                template <class Map>
+                struct widen_k_extent_f {
+                    template <class PlhInfo>
+                    using apply =
+                        typename widen_extent<PlhInfo, lookup_k_extent<Map, typename PlhInfo::plh_t>>::type;
+                };
+
+                template <class Stages>
+                struct select_mode_f {
+                    template <class Segment, class Indices = get_indices<Segment>>
+                    using apply = segment<meta::if_c<get_mode<Segment>::value &&
+                                                         can_be_k_blocked<Stages, Indices>::value,
+                                              k_blocked,
+                                              std::false_type>,
+                        Indices>;
+                };
+
+                // consecutive k-serial segments are merged
+                template <class Segments, class Segment, class = void>
+                struct merge_serial {
+                    using type = meta::push_back<Segments, Segment>;
+                };
+
+                template <class Segments, class Segment>
+                struct merge_serial<Segments,
+                    Segment,
+                    std::enable_if_t<std::is_same_v<get_mode<Segment>, std::false_type> &&
+                                     std::is_same_v<typename last_mode<Segments>::type, std::false_type>>> {
+                    using type = meta::push_back<meta::pop_back<Segments>,
+                        segment<std::false_type,
+                            meta::concat<get_indices<meta::last<Segments>>, get_indices<Segment>>>>;
+                };
+
+                template <class Segments, class Segment>
+                using merge_serial_t = typename merge_serial<Segments, Segment>::type;
+
+                template <class Stages, class Segment>
+                using segment_stages = meta::transform<stage_at_f<Stages>::template apply, get_indices<Segment>>;
+
+                template <class Stages, class Plh>
+                struct uses_plh_f {
+                    template <class Segment>
+                    using apply =
+                        meta::any_of<be_api::has_plh_f<Plh>::template apply, segment_stages<Stages, Segment>>;
+                };
+
+                template <class Stages, class Segments>
+                struct is_local_tmp_f {
+                    template <class Plh>
+                    using apply = std::bool_constant<
+                        meta::length<meta::filter<uses_plh_f<Stages, Plh>::template apply, Segments>>::value <= 1>;
+                };
+
+                template <class Stages, class Segment>
+                struct is_used_in_f {
+                    template <class PlhInfo>
+                    using apply = typename uses_plh_f<Stages, typename PlhInfo::plh_t>::template apply<Segment>;
+                };
+
+                template <class Indices>
+                struct restrict_group_f {
+                    template <class Group>
+                    using apply = meta::filter<meta::curry<meta::st_contains, Indices>::template apply, Group>;
+                };
+
+                template <class Group>
+                using is_not_empty = std::bool_constant<!meta::is_empty<Group>::value>;
+
+                template <class Stages,
+                    class TmpPlhs,
+                    class Segments = meta::foldl<merge_serial_t,
+                        meta::list<>,
+                        meta::transform<select_mode_f<Stages>::template apply,
+                            meta::foldl<add_stage_f<Stages>::template apply,
+                                meta::list<>,
+                                meta::make_indices_for<Stages>>>>>
+                using make_segments_impl =
+                    meta::if_<meta::all_of<is_local_tmp_f<Stages, Segments>::template apply, TmpPlhs>,
+                        Segments,
+                        meta::list<segment<std::false_type, meta::make_indices_for<Stages>>>>;
+            } // namespace segments_impl_
+
+            /**
+             *  Splits the stages of the split view `Stages` into consecutive segments that are executed one after
+             *  the other, each in its own parallel region and with its own execution mode (see `k_blocked`):
+             *    - if `FuseAll` is set, there is a single segment executed one k-level per block;
+             *    - otherwise the parallel stages that can be k-blocked form `k_blocked` segments and the others
+             *      `std::false_type` (k-serial) segments.
+             *  The temporaries `TmpPlhs` are allocated per thread and per block, thus they can not be shared between
+             *  segments; if they would be, there is a single k-serial segment.
+             *
+             *  The segment has `mode_t` and `indices_t`, the list of the indices of its stages.
+             */
+            template <class Stages, class TmpPlhs, class FuseAll>
+            using make_segments = meta::if_<FuseAll,
+                meta::list<segments_impl_::segment<std::true_type, meta::make_indices_for<Stages>>>,
+                segments_impl_::make_segments_impl<Stages, TmpPlhs>>;
+
+            /**
+             *  The stages of `Stages` that belong to `Segment`.
+             */
+            using segments_impl_::segment_stages;
+
+            /**
+             *  The part of `PlhMap` with the placeholders that are accessed by the stages of `Segment`.
+             */
+            template <class Stages, class Segment, class PlhMap>
+            using segment_plh_map = meta::filter<segments_impl_::is_used_in_f<Stages, Segment>::template apply, PlhMap>;
+
+            /**
+             *  The k-extents of the k-blocked stages `Stages`: the levels around the block that they compute.
+             */
+            template <class Stages>
+            using stage_k_extents = meta::second<segments_impl_::k_extents<Stages>>;
+
+            /**
+             *  `PlhMap` with the extents of the temporaries widened to the levels around the block at which they are
+             *  computed by the k-blocked stages `Stages`.
+             */
+            template <class Stages,
+                class PlhMap,
+                class KExtentMap = meta::first<segments_impl_::k_extents<Stages>>>
+            using k_blocked_plh_map =
+                meta::transform<segments_impl_::widen_k_extent_f<KExtentMap>::template apply, PlhMap>;
+
+            /**
+             *  The groups of stage indices `Groups` (see `be_api::make_stage_groups`) restricted to `Segment`.
+             */
+            template <class Groups, class Segment>
+            using segment_groups = meta::filter<segments_impl_::is_not_empty,
+                meta::transform<segments_impl_::restrict_group_f<typename Segment::indices_t>::template apply,
+                    Groups>>;
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,426 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/gt_math.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/vector_register_bytes.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../common/dim.hpp"
+#include "../reduction_output.hpp"
+
+/**
+ *   @file
+ *
+ *   Explicit SIMD execution of the i-loop of cpu_ifirst, enabled by `cpu_ifirst<ThreadPool, true>`.
+ *
+ *   The stages are invoked once per `W` consecutive points along i, with a dereferencing policy under which the
+ *   accessors evaluate to vectors of `W` elements:
+ *     - data with unit i-stride is loaded into a `vec<T, W>` (read-only data) or a `simd_ref<T, W>` (written data,
+ *       stored back on assignment to the accessor result);
+ *     - data with zero i-stride (e.g. global parameters or k-only fields) evaluates to the scalar as usual, which is
+ *       broadcast when combined with vectors;
+ *     - stages that write to a reduction output (see reduction_output.hpp) are not vectorized.
+ *   The width `W` is chosen per stage from the largest data type of the stage and the vector register size of the
+ *   target. Remaining points that don't fill a vector are computed by the scalar code.
+ *
+ *   For an ensemble (see run_ensemble.hpp) the vectors run along the members (`dim::e`) instead of i, with the same
+ *   rules applied to the strides along `dim::e`.
+ *
+ *   Only stages for which all data is either read-only with zero i-stride or arithmetic with unit i-stride (both
+ *   known at compile time) are vectorized, the others use the scalar code. The stencil functors have to be
+ *   written generically for SIMD execution:
+ *     - the results of accessors should be kept in `auto` variables (not references, a written accessor bound to
+ *       `auto &&` is a copy as well);
+ *     - the arithmetic operators and `math::fabs/abs/sqrt/exp/log/pow/min/max` are supported, also with a scalar
+ *       operand;
+ *     - comparisons evaluate to masks, which can be combined with `&&`, `||` and `!`. Branches on values are not
+ *       supported, `math::select(cond, a, b)` (for vectors or scalars) takes their place.
+ *   Functors that are not written this way (for instance with `double` locals or `if` on values) opt out with
+ *   `static constexpr bool simd = false;` and are computed by the scalar code.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace simd_impl_ {
+                constexpr int register_bytes = vector_register_bytes;
+
+                /**
+                 *  Result of the comparison of two `vec<T, W>`: all bits set in the lanes where the comparison holds.
+                 */
+                template <class T, int W>
+                struct simd_mask {
+                    typedef T data_t __attribute__((vector_size(sizeof(T) * W)));
+                    using native_t = decltype(data_t() < data_t());
+
+                    native_t m_value;
+
+                    simd_mask() = default;
+                    GT_FORCE_INLINE simd_mask(native_t value) : m_value(value) {}
+
+                    GT_FORCE_INLINE bool operator[](int i) const { return m_value[i]; }
+
+                    friend GT_FORCE_INLINE simd_mask operator!(simd_mask const &arg) { return ~arg.m_value; }
+                    friend GT_FORCE_INLINE simd_mask operator&&(simd_mask const &lhs, simd_mask const &rhs) {
+                        return lhs.m_value & rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE simd_mask operator||(simd_mask const &lhs, simd_mask const &rhs) {
+                        return lhs.m_value | rhs.m_value;
+                    }
+                };
+
+                template <class T, int W>
+                struct vec {
+                    typedef T native_t __attribute__((vector_size(sizeof(T) * W)));
+                    static constexpr int width = W;
+
+                    native_t m_value;
+
+                    vec() = default;
+                    GT_FORCE_INLINE vec(native_t value) : m_value(value) {}
+                    template <class U, std::enable_if_t<std::is_arithmetic_v<U>, int> = 0>
+                    GT_FORCE_INLINE vec(U value) {
+                        for (int i = 0; i < W; ++i)
+                            m_value[i] = value;
+                    }
+
+                    static GT_FORCE_INLINE vec load(T const *ptr) {
+                        vec res;
+                        std::memcpy(&res.m_value, ptr, sizeof(native_t));
+                        return res;
+                    }
+
+                    GT_FORCE_INLINE void store(T *ptr) const { std::memcpy(ptr, &m_value, sizeof(native_t)); }
+
+                    GT_FORCE_INLINE T operator[](int i) const { return m_value[i]; }
+
+                    friend GT_FORCE_INLINE vec operator+(vec const &arg) { return arg; }
+                    friend GT_FORCE_INLINE vec operator-(vec const &arg) { return -arg.m_value; }
+                    friend GT_FORCE_INLINE vec operator+(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value + rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE vec operator-(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value - rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE vec operator*(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value * rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE vec operator/(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value / rhs.m_value;
+                    }
+
+                    friend GT_FORCE_INLINE simd_mask<T, W> operator==(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value == rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE simd_mask<T, W> operator!=(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value != rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE simd_mask<T, W> operator<(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value < rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE simd_mask<T, W> operator<=(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value <= rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE simd_mask<T, W> operator>(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value > rhs.m_value;
+                    }
+                    friend GT_FORCE_INLINE simd_mask<T, W> operator>=(vec const &lhs, vec const &rhs) {
+                        return lhs.m_value >= rhs.m_value;
+                    }
+
+                    GT_FORCE_INLINE vec &operator+=(vec const &rhs) { return *this = *this + rhs; }
+                    GT_FORCE_INLINE vec &operator-=(vec const &rhs) { return *this = *this - rhs; }
+                    GT_FORCE_INLINE vec &operator*=(vec const &rhs) { return *this = *this * rhs; }
+                    GT_FORCE_INLINE vec &operator/=(vec const &rhs) { return *this = *this / rhs; }
+                };
+
+                template <class T, int W, class F>
+                GT_FORCE_INLINE vec<T, W> elementwise(F f, vec<T, W> const &arg) {
+                    vec<T, W> res;
+                    for (int i = 0; i < W; ++i)
+                        res.m_value[i] = f(arg.m_value[i]);
+                    return res;
+                }
+
+                template <class T, int W, class F>
+                GT_FORCE_INLINE vec<T, W> elementwise(F f, vec<T, W> const &lhs, vec<T, W> const &rhs) {
+                    vec<T, W> res;
+                    for (int i = 0; i < W; ++i)
+                        res.m_value[i] = f(lhs.m_value[i], rhs.m_value[i]);
+                    return res;
+                }
+
+                /**
+                 *  Vector of data that is written by the stage: behaves like a `vec` loaded from `ptr`. Assignments to
+                 *  the accessor result (an rvalue, as in `eval(out()) = x`) store the value back, assignments to a
+                 *  named `simd_ref` (as in `auto x = eval(out()); x = y;`) change only the local value, like a scalar
+                 *  `auto` copy does. A `simd_ref` can't be copied.
+                 */
+                template <class T, int W>
+                class simd_ref : public vec<T, W> {
+                    T *m_ptr;
+
+                  public:
+                    explicit GT_FORCE_INLINE simd_ref(T *ptr) : vec<T, W>(vec<T, W>::load(ptr)), m_ptr(ptr) {}
+                    simd_ref(simd_ref const &) = delete;
+                    simd_ref(simd_ref &&) = default;
+
+                    GT_FORCE_INLINE simd_ref &&operator=(vec<T, W> const &value) && {
+                        this->m_value = value.m_value;
+                        this->store(m_ptr);
+                        return std::move(*this);
+                    }
+                    GT_FORCE_INLINE simd_ref &&operator=(simd_ref const &value) && {
+                        return std::move(*this) = static_cast<vec<T, W> const &>(value);
+                    }
+                    GT_FORCE_INLINE simd_ref &&operator+=(vec<T, W> const &rhs) && {
+                        return std::move(*this) = *this + rhs;
+                    }
+                    GT_FORCE_INLINE simd_ref &&operator-=(vec<T, W> const &rhs) && {
+                        return std::move(*this) = *this - rhs;
+                    }
+                    GT_FORCE_INLINE simd_ref &&operator*=(vec<T, W> const &rhs) && {
+                        return std::move(*this) = *this * rhs;
+                    }
+                    GT_FORCE_INLINE simd_ref &&operator/=(vec<T, W> const &rhs) && {
+                        return std::move(*this) = *this / rhs;
+                    }
+
+                    GT_FORCE_INLINE simd_ref &operator=(vec<T, W> const &value) & {
+                        this->m_value = value.m_value;
+                        return *this;
+                    }
+                    GT_FORCE_INLINE simd_ref &operator=(simd_ref const &value) & {
+                        return *this = static_cast<vec<T, W> const &>(value);
+                    }
+                    GT_FORCE_INLINE simd_ref &operator+=(vec<T, W> const &rhs) & { return *this = *this + rhs; }
+                    GT_FORCE_INLINE simd_ref &operator-=(vec<T, W> const &rhs) & { return *this = *this - rhs; }
+                    GT_FORCE_INLINE simd_ref &operator*=(vec<T, W> const &rhs) & { return *this = *this * rhs; }
+                    GT_FORCE_INLINE simd_ref &operator/=(vec<T, W> const &rhs) & { return *this = *this / rhs; }
+                };
+
+                struct min_f {
+                    template <class T>
+                    GT_FORCE_INLINE T operator()(T x, T y) const {
+                        return y < x ? y : x;
+                    }
+                };
+
+                struct max_f {
+                    template <class T>
+                    GT_FORCE_INLINE T operator()(T x, T y) const {
+                        return x < y ? y : x;
+                    }
+                };
+
+                struct pow_f {
+                    template <class T>
+                    GT_FORCE_INLINE T operator()(T x, T y) const {
+                        return std::pow(x, y);
+                    }
+                };
+
+// `math::name` of two vectors, of a vector and a broadcast scalar, and of two written vectors (which would resolve
+// to the scalar overload of gt_math.hpp otherwise)
+#define GT_CPU_IFIRST_SIMD_BINARY_FUNCTION(name)                                           \
+    template <class T, int W>                                                              \
+    GT_FORCE_INLINE vec<T, W> name(vec<T, W> const &lhs, vec<T, W> const &rhs) {           \
+        return elementwise(name##_f(), lhs, rhs);                                          \
+    }                                                                                      \
+    template <class T, int W>                                                              \
+    GT_FORCE_INLINE vec<T, W> name(simd_ref<T, W> const &lhs, simd_ref<T, W> const &rhs) { \
+        return elementwise(name##_f(), vec<T, W>(lhs), vec<T, W>(rhs));                    \
+    }                                                                                      \
+    template <class T, int W, class U, std::enable_if_t<std::is_arithmetic_v<U>, int> = 0> \
+    GT_FORCE_INLINE vec<T, W> name(vec<T, W> const &lhs, U rhs) {                          \
+        return elementwise(name##_f(), lhs, vec<T, W>(rhs));                               \
+    }                                                                                      \
+    template <class T, int W, class U, std::enable_if_t<std::is_arithmetic_v<U>, int> = 0> \
+    GT_FORCE_INLINE vec<T, W> name(U lhs, vec<T, W> const &rhs) {                          \
+        return elementwise(name##_f(), vec<T, W>(lhs), rhs);                               \
+    }
+
+                GT_CPU_IFIRST_SIMD_BINARY_FUNCTION(min)
+                GT_CPU_IFIRST_SIMD_BINARY_FUNCTION(max)
+                GT_CPU_IFIRST_SIMD_BINARY_FUNCTION(pow)
+
+#undef GT_CPU_IFIRST_SIMD_BINARY_FUNCTION
+
+                /**
+                 *  `math::select` of vectors: the lanes of `lhs` where `mask` is set, the lanes of `rhs` otherwise.
+                 *  Scalar operands are broadcast.
+                 */
+                template <class T, int W, class L, class R>
+                GT_FORCE_INLINE vec<T, W> select(simd_mask<T, W> const &mask, L const &lhs, R const &rhs) {
+                    vec<T, W> l(lhs), r(rhs), res;
+                    for (int i = 0; i < W; ++i)
+                        res.m_value[i] = mask.m_value[i] ? l.m_value[i] : r.m_value[i];
+                    return res;
+                }
+
+                template <class Ptr, class Key>
+                using ptr_type = std::decay_t<decltype(host_device::at_key<Key>(std::declval<Ptr const &>()))>;
+
+                template <class Strides, class Key, class Dim>
+                using stride_type =
+                    std::decay_t<decltype(sid::get_stride_element<Key, Dim>(std::declval<Strides const &>()))>;
+
+                template <class Ptr>
+                using is_const_ptr = std::is_const<std::remove_pointer_t<Ptr>>;
+
+                // width limit of a single data: 0 if it prevents vectorization, `register_bytes` if it doesn't limit it
+                template <class Ptr, class Stride, class = void>
+                struct max_width : integral_constant<int, 0> {};
+
+                template <class Ptr, class Stride>
+                struct max_width<Ptr,
+                    Stride,
+                    std::enable_if_t<is_integral_constant_of<Stride, 0>::value && !is_reduction_ptr<Ptr>::value &&
+                                     (!std::is_pointer_v<Ptr> || is_const_ptr<Ptr>::value)>>
+                    : integral_constant<int, register_bytes> {};
+
+                template <class Ptr, class Stride>
+                struct max_width<Ptr,
+                    Stride,
+                    std::enable_if_t<is_integral_constant_of<Stride, 1>::value && std::is_pointer_v<Ptr> &&
+                                     std::is_arithmetic_v<std::remove_pointer_t<Ptr>>>>
+                    : integral_constant<int, register_bytes / sizeof(std::remove_pointer_t<Ptr>)> {};
+
+                template <class Ptr, class Strides, class Dim>
+                struct key_max_width_f {
+                    template <class Key>
+                    using apply = max_width<ptr_type<Ptr, Key>, stride_type<Strides, Key, Dim>>;
+                };
+
+                template <class Strides, class Dim>
+                struct has_unit_stride_f {
+                    template <class Key>
+                    using apply = is_integral_constant_of<stride_type<Strides, Key, Dim>, 1>;
+                };
+
+                template <class... Ts>
+                struct min_width : integral_constant<int, std::min({register_bytes, Ts::value...})> {};
+
+                /**
+                 *  The vector width for a stage with the given composite pointer and strides, 0 if the stage is not
+                 *  vectorized. The vectors run along `Dim`: i, or the members of an ensemble.
+                 */
+                template <class Ptr,
+                    class Strides,
+                    class Dim = dim::i,
+                    class Keys = get_keys<Ptr>,
+                    class Widths = meta::transform<key_max_width_f<Ptr, Strides, Dim>::template apply, Keys>,
+                    class Width = meta::rename<min_width, Widths>,
+                    class HasUnitStride = meta::any_of<has_unit_stride_f<Strides, Dim>::template apply, Keys>>
+                constexpr int simd_width = HasUnitStride::value && Width::value > 1 ? Width::value : 0;
+
+                template <class Functor, class = void>
+                struct is_simd_functor : std::true_type {};
+
+                template <class Functor>
+                struct is_simd_functor<Functor, std::enable_if_t<!Functor::simd>> : std::false_type {};
+
+                template <class Fun, class = void>
+                struct is_simd_fun : std::true_type {};
+
+                template <class Fun>
+                struct is_simd_fun<Fun, std::void_t<typename Fun::functor_t>>
+                    : is_simd_functor<typename Fun::functor_t> {};
+
+                /**
+                 *  Whether the stage may be vectorized: false if one of its functors opted out with
+                 *  `static constexpr bool simd = false;`.
+                 */
+                template <class Stage, class = void>
+                struct is_simd_stage : std::true_type {};
+
+                template <class Stage>
+                struct is_simd_stage<Stage, std::void_t<typename Stage::funs_t>>
+                    : meta::all_of<is_simd_fun, typename Stage::funs_t> {};
+
+                template <class Strides, int W, class Dim = dim::i>
+                struct deref_f {
+                    template <class T>
+                    static GT_FORCE_INLINE vec<T, W> deref(integral_constant<int_t, 1>, T const *ptr) {
+                        return vec<T, W>::load(ptr);
+                    }
+
+                    template <class T>
+                    static GT_FORCE_INLINE simd_ref<T, W> deref(integral_constant<int_t, 1>, T *ptr) {
+                        return simd_ref<T, W>(ptr);
+                    }
+
+                    template <class Ptr>
+                    static GT_FORCE_INLINE decltype(auto) deref(integral_constant<int_t, 0>, Ptr const &ptr) {
+                        return *ptr;
+                    }
+
+                    template <class Key, class Ptr>
+                    GT_FORCE_INLINE decltype(auto) operator()(Key, Ptr const &ptr) const {
+                        using stride_t = stride_type<Strides, Key, Dim>;
+                        return deref(integral_constant<int_t, stride_t::value>(), ptr);
+                    }
+                };
+            } // namespace simd_impl_
+
+            using simd_impl_::deref_f;
+            using simd_impl_::is_simd_stage;
+            using simd_impl_::simd_mask;
+            using simd_impl_::simd_ref;
+            using simd_impl_::simd_width;
+            using simd_impl_::vec;
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+
+    namespace math {
+        template <class T, int W>
+        GT_FORCE_INLINE stencil::cpu_ifirst_backend::vec<T, W> fabs(
+            stencil::cpu_ifirst_backend::vec<T, W> const &arg) {
+            return stencil::cpu_ifirst_backend::simd_impl_::elementwise([](T x) { return std::fabs(x); }, arg);
+        }
+
+        template <class T, int W>
+        GT_FORCE_INLINE stencil::cpu_ifirst_backend::vec<T, W> abs(stencil::cpu_ifirst_backend::vec<T, W> const &arg) {
+            return stencil::cpu_ifirst_backend::simd_impl_::elementwise([](T x) { return std::abs(x); }, arg);
+        }
+
+        template <class T, int W>
+        GT_FORCE_INLINE stencil::cpu_ifirst_backend::vec<T, W> sqrt(
+            stencil::cpu_ifirst_backend::vec<T, W> const &arg) {
+            return stencil::cpu_ifirst_backend::simd_impl_::elementwise([](T x) { return std::sqrt(x); }, arg);
+        }
+
+        template <class T, int W>
+        GT_FORCE_INLINE stencil::cpu_ifirst_backend::vec<T, W> exp(stencil::cpu_ifirst_backend::vec<T, W> const &arg) {
+            return stencil::cpu_ifirst_backend::simd_impl_::elementwise([](T x) { return std::exp(x); }, arg);
+        }
+
+        template <class T, int W>
+        GT_FORCE_INLINE stencil::cpu_ifirst_backend::vec<T, W> log(stencil::cpu_ifirst_backend::vec<T, W> const &arg) {
+            return stencil::cpu_ifirst_backend::simd_impl_::elementwise([](T x) { return std::log(x); }, arg);
+        }
+
+        using stencil::cpu_ifirst_backend::simd_impl_::max;
+        using stencil::cpu_ifirst_backend::simd_impl_::min;
+        using stencil::cpu_ifirst_backend::simd_impl_::pow;
+        using stencil::cpu_ifirst_backend::simd_impl_::select;
+    } // namespace math
+} // namespace gridtools
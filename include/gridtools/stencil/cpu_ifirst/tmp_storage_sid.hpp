@@ -13,6 +13,8 @@
 
 #include "../../common/hugepage_alloc.hpp"
 #include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple_util.hpp"
 #include "../../sid/allocator.hpp"
 #include "../../sid/concept.hpp"
 #include "../../sid/simple_ptr_holder.hpp"
@@ -72,6 +74,9 @@ namespace gridtools {
                 template <class T, class Extent>
                 using strides_kind = strides_kind_impl<sizeof(T), Extent>;
 
+                template <std::size_t, class>
+                struct inlined_strides_kind {};
+
                 /**
                  * @brief Strides, depending on data type due to padding to cache-line size. Specialization for non-zero
                  * extents along k-dimension.
@@ -138,6 +143,71 @@ namespace gridtools {
                     .template set<sid::property::strides_kind, _impl_tmp::strides_kind<T, Extent>>()
                     .template set<sid::property::ptr_diff, int_t>();
             }
+
+            /**
+             * @brief Storage of a temporary that is computed on the fly: one row of a block per thread, as the i-loop
+             * (vectorized or not) executes all stages of an item before it moves on.
+             */
+            template <class T, class Extent, class ThreadPool, class Allocator>
+            auto make_inlined_tmp_storage(Allocator &allocator, std::size_t i_block_size) {
+                const std::size_t size_i = _impl_tmp::pad<T>(Extent::extend(dim::i(), i_block_size));
+                constexpr std::size_t extra = (_impl_tmp::byte_alignment::value + sizeof(T) - 1) / sizeof(T);
+                return sid::synthetic()
+                    .set<sid::property::origin>(
+                        allocate(allocator,
+                            meta::lazy::id<T>(),
+                            size_i * thread_pool::get_max_threads(ThreadPool()) + extra) +
+                        _impl_tmp::pad<T>(-Extent::iminus::value))
+                    .template set<sid::property::strides>(
+                        hymap::keys<dim::i, dim::thread>::make_values(integral_constant<int_t, 1>(), (int_t)size_i))
+                    .template set<sid::property::strides_kind, _impl_tmp::inlined_strides_kind<sizeof(T), Extent>>()
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
+
+            template <std::size_t, class>
+            struct ensemble_strides_kind {};
+
+            template <std::size_t, class>
+            struct ensemble_inlined_strides_kind {};
+
+            /**
+             * @brief Storage of a temporary of an ensemble: the same blocks as above, with the `members` members of
+             * every point stored contiguously along `dim::e`.
+             */
+            template <class T, class Extent, bool AllParallel, class ThreadPool, class Allocator>
+            auto make_ensemble_tmp_storage(Allocator &allocator, pos3<std::size_t> const &block_size, int_t members) {
+                using namespace literals;
+                auto strides = tuple_util::transform([members](auto stride) -> int_t { return stride * members; },
+                    _impl_tmp::strides<T, Extent, AllParallel>(block_size));
+                return sid::synthetic()
+                    .set<sid::property::origin>(
+                        allocate(allocator,
+                            meta::lazy::id<T>(),
+                            _impl_tmp::storage_size<T, Extent, ThreadPool>(block_size) * members) +
+                        _impl_tmp::origin_offset<T, Extent, AllParallel>(block_size) * members)
+                    .template set<sid::property::strides>(
+                        hymap::concat(hymap::keys<dim::e>::make_values(1_c), std::move(strides)))
+                    .template set<sid::property::strides_kind, ensemble_strides_kind<sizeof(T), Extent>>()
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
+
+            /**
+             * @brief Storage of a temporary of an ensemble that is computed on the fly: one row of a block per thread
+             * with the members of every point stored contiguously along `dim::e`.
+             */
+            template <class T, class Extent, class ThreadPool, class Allocator>
+            auto make_ensemble_inlined_tmp_storage(Allocator &allocator, std::size_t i_block_size, int_t members) {
+                using namespace literals;
+                const std::size_t size_i = Extent::extend(dim::i(), i_block_size) * members;
+                return sid::synthetic()
+                    .set<sid::property::origin>(
+                        allocate(allocator, meta::lazy::id<T>(), size_i * thread_pool::get_max_threads(ThreadPool())) -
+                        Extent::iminus::value * members)
+                    .template set<sid::property::strides>(
+                        hymap::keys<dim::e, dim::i, dim::thread>::make_values(1_c, members, (int_t)size_i))
+                    .template set<sid::property::strides_kind, ensemble_inlined_strides_kind<sizeof(T), Extent>>()
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
         } // namespace cpu_ifirst_backend
     }     // namespace stencil
 } // namespace gridtools
@@ -0,0 +1,265 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "../../common/defs.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "execinfo.hpp"
+
+/**
+ *   @file
+ *
+ *   Auto-tuning of the cpu_ifirst block decomposition.
+ *
+ *   Tuning is enabled by setting the environment variable `GT_CPU_IFIRST_TUNING_CACHE` to the path of the tuning
+ *   cache file. For every stencil, grid size and thread count that is not yet in the cache, the first invocation is a
+ *   warm-up run with the default block sizes that is not measured (it pays for first touch and cold caches). The
+ *   following invocations are run with different candidate i/j-block sizes, one candidate per invocation, and their
+ *   run times are measured. Once all candidates were run, the fastest one is appended to the cache file and used for
+ *   all later invocations, also in later runs of the program. The candidates are shrunk like the default blocks to fit
+ *   the ij-cached temporaries into the cache.
+ *
+ *   The candidates are measured on consecutive invocations rather than by running the same invocation repeatedly, as
+ *   stencils are not idempotent in general (e.g. if an output field is also an input).
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace tuning_impl_ {
+                using block_sizes_t = std::pair<int_t, int_t>;
+
+                /**
+                 *  Tuning cache file. Every line holds a key and the tuned i- and j-block sizes, later lines win.
+                 */
+                class tuning_cache {
+                    std::string m_path;
+                    std::map<std::string, block_sizes_t> m_entries;
+
+                  public:
+                    tuning_cache(std::string path) : m_path(std::move(path)) {
+                        std::ifstream file(m_path);
+                        std::string line;
+                        while (std::getline(file, line)) {
+                            auto pos = line.find_last_of(' ');
+                            if (pos == std::string::npos || pos == 0)
+                                continue;
+                            auto key_end = line.find_last_of(' ', pos - 1);
+                            if (key_end == std::string::npos)
+                                continue;
+                            std::istringstream values(line.substr(key_end + 1));
+                            block_sizes_t sizes;
+                            if (values >> sizes.first >> sizes.second && sizes.first > 0 && sizes.second > 0)
+                                m_entries[line.substr(0, key_end)] = sizes;
+                        }
+                    }
+
+                    block_sizes_t const *find(std::string const &key) const {
+                        auto it = m_entries.find(key);
+                        return it == m_entries.end() ? nullptr : &it->second;
+                    }
+
+                    void store(std::string const &key, block_sizes_t sizes) {
+                        m_entries[key] = sizes;
+                        std::ofstream(m_path, std::ios::app)
+                            << key << " " << sizes.first << " " << sizes.second << "\n";
+                    }
+                };
+
+                /**
+                 *  Candidate block sizes: the default heuristic first, then combinations of i-blocks of the full i-size
+                 *  and its halves and quarters with j-blocks of powers of two. Candidates that do not provide at
+                 *  least one block per thread are skipped.
+                 */
+                inline std::vector<block_sizes_t> candidates(
+                    int_t i_size, int_t j_size, int_t threads, block_sizes_t default_sizes) {
+                    std::vector<block_sizes_t> res = {default_sizes};
+                    for (int_t i_div = 1; i_div <= 4; i_div *= 2) {
+                        int_t i_block = (i_size + i_div - 1) / i_div;
+                        if (i_div > 1 && i_block < 8)
+                            break;
+                        for (int_t j_block = 1; j_block <= std::min(j_size, int_t(32)); j_block *= 2) {
+                            int_t blocks = (i_size + i_block - 1) / i_block * ((j_size + j_block - 1) / j_block);
+                            block_sizes_t sizes = {i_block, j_block};
+                            if (blocks >= threads && std::find(res.begin(), res.end(), sizes) == res.end())
+                                res.push_back(sizes);
+                        }
+                    }
+                    return res;
+                }
+
+                struct tuning_record {
+                    bool warmed_up = false;
+                    std::vector<block_sizes_t> candidates;
+                    std::vector<double> times;
+                };
+
+                class tuner {
+                    std::mutex m_mutex;
+                    tuning_cache m_cache;
+                    std::map<std::string, tuning_record> m_records;
+
+                  public:
+                    tuner(std::string path) : m_cache(std::move(path)) {}
+
+                    /**
+                     *  Returns the block sizes to use for the next invocation and the index of the candidate that has
+                     *  to be measured, or -1 if the key is already tuned or the invocation is the warm-up run.
+                     */
+                    std::pair<block_sizes_t, int> next(std::string const &key,
+                        int_t i_size,
+                        int_t j_size,
+                        int_t threads,
+                        block_sizes_t default_sizes) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if (auto *tuned = m_cache.find(key))
+                            return {*tuned, -1};
+                        auto &record = m_records[key];
+                        if (!record.warmed_up) {
+                            record.warmed_up = true;
+                            return {default_sizes, -1};
+                        }
+                        if (record.candidates.empty())
+                            record.candidates = candidates(i_size, j_size, threads, default_sizes);
+                        int index = record.times.size();
+                        if (index == (int)record.candidates.size())
+                            return {record.candidates.front(), -1};
+                        return {record.candidates[index], index};
+                    }
+
+                    /**
+                     *  The tuned block sizes, if the key is tuned already.
+                     */
+                    std::optional<block_sizes_t> find(std::string const &key) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if (auto *tuned = m_cache.find(key))
+                            return *tuned;
+                        return {};
+                    }
+
+                    /**
+                     *  Records the run time of a candidate. After the last candidate the winner is stored in the
+                     *  tuning cache.
+                     */
+                    void report(std::string const &key, int index, double time) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto &record = m_records[key];
+                        if (index != (int)record.times.size())
+                            return;
+                        record.times.push_back(time);
+                        if (record.times.size() < record.candidates.size())
+                            return;
+                        auto best = std::min_element(record.times.begin(), record.times.end()) - record.times.begin();
+                        m_cache.store(key, record.candidates[best]);
+                        m_records.erase(key);
+                    }
+                };
+
+                /**
+                 *  The process-wide tuner or nullptr if tuning is disabled.
+                 */
+                inline tuner *get_tuner() {
+                    static tuner *instance = [] {
+                        const char *path = std::getenv("GT_CPU_IFIRST_TUNING_CACHE");
+                        return path && *path ? new tuner(path) : nullptr;
+                    }();
+                    return instance;
+                }
+
+                // FNV-1a, to get keys that are stable between runs
+                inline std::uint64_t hash(char const *str) {
+                    std::uint64_t res = 14695981039346656037ull;
+                    for (; *str; ++str)
+                        res = (res ^ (unsigned char)*str) * 1099511628211ull;
+                    return res;
+                }
+
+                template <class Spec, class Grid>
+                std::string make_key(Grid const &grid, int_t threads) {
+                    std::ostringstream res;
+                    res << std::hex << hash(typeid(Spec).name()) << std::dec << " " << grid.i_size() << " "
+                        << grid.j_size() << " " << grid.k_size() << " " << threads;
+                    return res.str();
+                }
+
+                /**
+                 *  Applies the tuned (or currently measured) block sizes to the execinfo of an invocation. If a
+                 *  candidate is measured, its run time is reported when the object is destroyed.
+                 */
+                class block_tuner {
+                    tuner *m_tuner = nullptr;
+                    std::string m_key;
+                    int m_index = -1;
+                    std::chrono::steady_clock::time_point m_start;
+
+                  public:
+                    template <class Spec, class ThreadPool, class Grid, class Fit>
+                    block_tuner(Spec, ThreadPool, Grid const &grid, execinfo &info, Fit fit) : m_tuner(get_tuner()) {
+                        if (!m_tuner)
+                            return;
+                        int_t threads = thread_pool::get_max_threads(ThreadPool());
+                        m_key = make_key<Spec>(grid, threads);
+                        auto next = m_tuner->next(m_key,
+                            grid.i_size(),
+                            grid.j_size(),
+                            threads,
+                            {info.i_block_size(), info.j_block_size()});
+                        info = execinfo(grid, next.first.first, next.first.second);
+                        fit(info);
+                        m_index = next.second;
+                        m_start = std::chrono::steady_clock::now();
+                    }
+
+                    block_tuner(block_tuner const &) = delete;
+                    block_tuner &operator=(block_tuner const &) = delete;
+
+                    ~block_tuner() {
+                        if (m_index < 0)
+                            return;
+                        std::chrono::duration<double> time = std::chrono::steady_clock::now() - m_start;
+                        m_tuner->report(m_key, m_index, time.count());
+                    }
+                };
+
+                /**
+                 *  Applies the tuned block sizes to the execinfo of a prepared stencil, if they are known. Prepared
+                 *  stencils don't take part in the tuning because their block sizes are fixed.
+                 */
+                template <class Spec, class ThreadPool, class Grid, class Fit>
+                void apply_tuned_block_sizes(Spec, ThreadPool, Grid const &grid, execinfo &info, Fit fit) {
+                    tuner *t = get_tuner();
+                    if (!t)
+                        return;
+                    if (auto sizes = t->find(make_key<Spec>(grid, thread_pool::get_max_threads(ThreadPool())))) {
+                        info = execinfo(grid, sizes->first, sizes->second);
+                        fit(info);
+                    }
+                }
+            } // namespace tuning_impl_
+
+            using tuning_impl_::apply_tuned_block_sizes;
+            using tuning_impl_::block_tuner;
+        } // namespace cpu_ifirst_backend
+    }     // namespace stencil
+} // namespace gridtools
@@ -9,7 +9,10 @@
  */
 #pragma once
 
+#include <cassert>
+#include <cstddef>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 #include "../common/defs.hpp"
@@ -27,23 +30,74 @@
 #include "../sid/contiguous.hpp"
 #include "../sid/loop.hpp"
 #include "../sid/sid_shift_origin.hpp"
+#include "../sid/synthetic.hpp"
 #include "../thread_pool/concept.hpp"
+#include "../thread_pool/dummy.hpp"
 #include "../thread_pool/omp.hpp"
 #include "be_api.hpp"
+#include "common/activity_mask.hpp"
 #include "common/dim.hpp"
+#include "cpu_kfirst/k_cache.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_kfirst_backend {
-            template <class ThreadPool, class Stage, class Grid, class DataStores>
-            auto make_stage_loop(ThreadPool, Stage, Grid const &grid, DataStores &data_stores) {
+            template <class Info, class DataStores>
+            auto make_stage_sid(std::false_type, Info info, DataStores &data_stores) {
+                return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
+            }
+
+            template <class Info, class DataStores>
+            k_cache_sid_t make_stage_sid(std::true_type, Info, DataStores &) {
+                return {};
+            }
+
+            template <class Stage, class KSizes>
+            auto make_k_loop(meta::list<>, KSizes k_sizes, int_t shift_back) {
+                return [k_sizes = std::move(k_sizes), shift_back](auto &ptr, auto const &strides)
+                           GT_FORCE_INLINE_LAMBDA {
+                               tuple_util::for_each(
+                                   [&ptr, &strides](auto cell, auto size) GT_FORCE_INLINE_LAMBDA {
+                                       for (int_t k = 0; k < size; ++k) {
+                                           cell(ptr, strides);
+                                           cell.inc_k(ptr, strides);
+                                       }
+                                   },
+                                   Stage::cells(),
+                                   k_sizes);
+                               sid::shift(ptr, sid::get_stride<dim::k>(strides), shift_back);
+                           };
+            }
+
+            template <class Stage, class KCachePlhMap, class KSizes>
+            auto make_k_loop(KCachePlhMap, KSizes k_sizes, int_t) {
+                return [k_sizes = std::move(k_sizes)](auto const &ptr, auto const &strides) GT_FORCE_INLINE_LAMBDA {
+                    k_caches_type<KCachePlhMap> k_caches;
+                    auto mixed_ptr = hymap::merge(k_caches.ptr(), ptr);
+                    tuple_util::for_each(
+                        [&](auto cell, auto size) GT_FORCE_INLINE_LAMBDA {
+                            for (int_t k = 0; k < size; ++k) {
+                                cell(mixed_ptr, strides);
+                                k_caches.slide(cell.k_step());
+                                cell.inc_k(mixed_ptr.secondary(), strides);
+                            }
+                        },
+                        Stage::cells(),
+                        k_sizes);
+                };
+            }
+
+            template <class ThreadPool, class Stages, class Stage, class Grid, class DataStores>
+            auto make_stage_loop(ThreadPool, Stages, Stage, Grid const &grid, DataStores &data_stores) {
                 using extent_t = typename Stage::extent_t;
 
+                using k_cache_plh_map_t = local_k_cache_plh_map<Stages, Stage>;
                 using plh_map_t = typename Stage::plh_map_t;
                 using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
                 auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
                     [&](auto info) GT_FORCE_INLINE_LAMBDA {
-                        return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
+                        return make_stage_sid(
+                            meta::st_contains<k_cache_plh_map_t, decltype(info)>(), info, data_stores);
                     },
                     Stage::plh_map()));
                 using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
@@ -58,19 +112,7 @@ namespace gridtools {
                 auto shift_back = -grid.k_size(Stage::interval()) * Stage::k_step();
                 auto k_sizes = tuple_util::transform(
                     [&](auto cell) GT_FORCE_INLINE_LAMBDA { return grid.k_size(cell.interval()); }, Stage::cells());
-                auto k_loop = [k_sizes = std::move(k_sizes), shift_back](auto &ptr, auto const &strides)
-                                  GT_FORCE_INLINE_LAMBDA {
-                                      tuple_util::for_each(
-                                          [&ptr, &strides](auto cell, auto size) GT_FORCE_INLINE_LAMBDA {
-                                              for (int_t k = 0; k < size; ++k) {
-                                                  cell(ptr, strides);
-                                                  cell.inc_k(ptr, strides);
-                                              }
-                                          },
-                                          Stage::cells(),
-                                          k_sizes);
-                                      sid::shift(ptr, sid::get_stride<dim::k>(strides), shift_back);
-                                  };
+                auto k_loop = make_k_loop<Stage>(k_cache_plh_map_t(), std::move(k_sizes), shift_back);
                 return [origin = sid::get_origin(composite) + offset,
                            strides = std::move(strides),
                            k_loop = std::move(k_loop)](int_t i_block, int_t j_block, int_t i_size, int_t j_size) {
@@ -85,69 +127,175 @@ namespace gridtools {
                 };
             }
 
+            /**
+             *  The block sizes are either compile time constants (the default) or run time values:
+             *  `cpu_kfirst<int_t, int_t>{i_block_size, j_block_size}`.
+             */
             template <class IBlockSize = integral_constant<int_t, 8>,
                 class JBlockSize = integral_constant<int_t, 8>,
                 class ThreadPool = thread_pool::omp>
-            struct cpu_kfirst {};
+            struct cpu_kfirst {
+                IBlockSize i_block_size = {};
+                JBlockSize j_block_size = {};
+            };
 
+            /**
+             *  The storage of a temporary that is computed on the fly: the stages of an item are executed point by
+             *  point, thus one element per thread is enough. It is padded to a cache line to avoid false sharing.
+             */
+            template <class T, class ThreadPool, class Allocator>
+            auto make_inlined_tmp_storage(Allocator &alloc) {
+                using stride_t = integral_constant<int_t, (64 + sizeof(T) - 1) / sizeof(T)>;
+                std::size_t size = stride_t::value * thread_pool::get_max_threads(ThreadPool());
+                return sid::synthetic()
+                    .set<sid::property::origin>(allocate(alloc, meta::lazy::id<T>(), size))
+                    .template set<sid::property::strides>(hymap::keys<dim::thread>::make_values(stride_t()))
+                    .template set<sid::property::ptr_diff, int_t>();
+            }
+
+            /**
+             *  Allocates the temporaries once, the returned function executes the stencil on the external data stores.
+             */
             template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Grid, class DataStores>
-            void gridtools_backend_entry_point(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool>,
-                Spec,
-                Grid const &grid,
-                DataStores external_data_stores) {
+            auto gridtools_backend_prepare(
+                cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> backend, Spec, Grid const &grid, DataStores const &) {
                 using stages_t = be_api::make_split_view<Spec>;
 
+                auto i_block_size = backend.i_block_size;
+                auto j_block_size = backend.j_block_size;
+                assert(i_block_size > 0 && j_block_size > 0);
+
                 auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
 
-                using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
-                auto temporaries = be_api::make_data_stores(tmp_plh_map_t(), [&grid, &alloc](auto info) {
-                    auto extent = info.extent();
-                    auto interval = stages_t::interval();
-                    auto num_colors = info.num_colors();
-                    auto offsets = hymap::keys<dim::i, dim::j, dim::k>::make_values(-extent.minus(dim::i()),
-                        -extent.minus(dim::j()),
-                        -grid.k_start(interval) - extent.minus(dim::k()));
-                    auto sizes = hymap::keys<dim::c, dim::k, dim::j, dim::i, dim::thread>::make_values(num_colors,
-                        grid.k_size(interval, extent),
-                        extent.extend(dim::j(), JBlockSize()),
-                        extent.extend(dim::i(), IBlockSize()),
-                        thread_pool::get_max_threads(ThreadPool()));
-
-                    using stride_kind = meta::list<decltype(extent), decltype(num_colors)>;
-                    return sid::shift_sid_origin(
-                        sid::make_contiguous<decltype(info.data()), int_t, stride_kind>(alloc, sizes), offsets);
+                using tmp_plh_map_t = remove_local_k_caches<stages_t,
+                    be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>>;
+                using inlined_tmp_plh_map_t = be_api::inlined_tmp_plh_map<stages_t, tmp_plh_map_t>;
+                auto inlined_temporaries = be_api::make_data_stores(inlined_tmp_plh_map_t(), [&alloc](auto info) {
+                    return make_inlined_tmp_storage<decltype(info.data()), ThreadPool>(alloc);
                 });
+                using buffered_tmp_plh_map_t = be_api::buffered_tmp_plh_map<stages_t, tmp_plh_map_t>;
+                auto temporaries = be_api::make_aliased_data_stores(
+                    stages_t(), buffered_tmp_plh_map_t(), [&grid, &alloc, i_block_size, j_block_size](auto info) {
+                        auto extent = info.extent();
+                        auto interval = stages_t::interval();
+                        auto num_colors = info.num_colors();
+                        auto offsets = hymap::keys<dim::i, dim::j, dim::k>::make_values(-extent.minus(dim::i()),
+                            -extent.minus(dim::j()),
+                            -grid.k_start(interval) - extent.minus(dim::k()));
+                        auto sizes = hymap::keys<dim::c, dim::k, dim::j, dim::i, dim::thread>::make_values(num_colors,
+                            grid.k_size(interval, extent),
+                            extent.extend(dim::j(), j_block_size),
+                            extent.extend(dim::i(), i_block_size),
+                            thread_pool::get_max_threads(ThreadPool()));
 
-                auto blocked_external_data_stores = tuple_util::transform(
-                    [&](auto &&data_store) GT_FORCE_INLINE_LAMBDA {
-                        return sid::block(std::forward<decltype(data_store)>(data_store),
-                            hymap::keys<dim::i, dim::j>::values<IBlockSize, JBlockSize>());
-                    },
-                    std::move(external_data_stores));
+                        using stride_kind = meta::list<decltype(extent), decltype(num_colors)>;
+                        return sid::shift_sid_origin(
+                            sid::make_contiguous<decltype(info.data()), int_t, stride_kind>(alloc, sizes), offsets);
+                    });
 
-                auto data_stores = hymap::concat(std::move(blocked_external_data_stores), std::move(temporaries));
+                return [alloc = std::move(alloc),
+                           temporaries = std::move(temporaries),
+                           inlined_temporaries = std::move(inlined_temporaries),
+                           grid,
+                           i_block_size,
+                           j_block_size](DataStores external_data_stores, activity_mask const *mask = nullptr) {
+                    auto blocked_external_data_stores = tuple_util::transform(
+                        [&](auto &&data_store) GT_FORCE_INLINE_LAMBDA {
+                            return sid::block(std::forward<decltype(data_store)>(data_store),
+                                hymap::keys<dim::i, dim::j>::make_values(i_block_size, j_block_size));
+                        },
+                        std::move(external_data_stores));
 
-                auto stage_loops = tuple_util::transform(
-                    [&](auto stage)
-                        GT_FORCE_INLINE_LAMBDA { return make_stage_loop(ThreadPool(), stage, grid, data_stores); },
-                    meta::rename<tuple, stages_t>());
+                    auto data_stores =
+                        hymap::concat(std::move(blocked_external_data_stores), temporaries, inlined_temporaries);
 
-                int_t total_i = grid.i_size();
-                int_t total_j = grid.j_size();
+                    // the loops of the stages grouped by the independent passes
+                    auto stage_loops = tuple_util::transform(
+                        [&](auto group) GT_FORCE_INLINE_LAMBDA {
+                            return tuple_util::transform(
+                                [&](auto i) GT_FORCE_INLINE_LAMBDA {
+                                    return make_stage_loop(
+                                        ThreadPool(), stages_t(), meta::at<stages_t, decltype(i)>(), grid, data_stores);
+                                },
+                                meta::rename<tuple, decltype(group)>());
+                        },
+                        meta::rename<tuple, be_api::make_stage_groups<Spec>>());
 
-                int_t NBI = (total_i + IBlockSize::value - 1) / IBlockSize::value;
-                int_t NBJ = (total_j + JBlockSize::value - 1) / JBlockSize::value;
+                    int_t total_i = grid.i_size();
+                    int_t total_j = grid.j_size();
 
-                thread_pool::parallel_for_loop(
-                    ThreadPool(),
-                    [&](auto bj, auto bi) {
-                        int_t i_size = bi + 1 == NBI ? total_i - bi * IBlockSize::value : IBlockSize::value;
-                        int_t j_size = bj + 1 == NBJ ? total_j - bj * JBlockSize::value : JBlockSize::value;
-                        tuple_util::for_each(
-                            [=](auto &&fun) GT_FORCE_INLINE_LAMBDA { fun(bi, bj, i_size, j_size); }, stage_loops);
-                    },
-                    NBJ,
-                    NBI);
+                    int_t NBI = (total_i + i_block_size - 1) / i_block_size;
+                    int_t NBJ = (total_j + j_block_size - 1) / j_block_size;
+
+                    // the blocks of the independent groups of passes are executed concurrently, the group index is
+                    // the outermost one to hand out the blocks of the same group to the same threads
+                    thread_pool::parallel_for_loop(
+                        ThreadPool(),
+                        [&](auto bj, auto bi, auto group) {
+                            int_t i_size = bi + 1 == NBI ? total_i - bi * i_block_size : i_block_size;
+                            int_t j_size = bj + 1 == NBJ ? total_j - bj * j_block_size : j_block_size;
+                            if (mask && !mask->any({int_t(bi * i_block_size),
+                                            int_t(bi * i_block_size + i_size),
+                                            int_t(bj * j_block_size),
+                                            int_t(bj * j_block_size + j_size)}))
+                                return;
+                            be_api::visit_group(stage_loops, group, [=](auto &&loops) GT_FORCE_INLINE_LAMBDA {
+                                tuple_util::for_each(
+                                    [=](auto &&fun) GT_FORCE_INLINE_LAMBDA { fun(bi, bj, i_size, j_size); }, loops);
+                            });
+                        },
+                        NBJ,
+                        NBI,
+                        tuple_util::size<decltype(stage_loops)>());
+                };
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Grid, class DataStores>
+            void gridtools_backend_entry_point(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> backend,
+                Spec spec,
+                Grid const &grid,
+                DataStores external_data_stores) {
+                gridtools_backend_prepare(backend, spec, grid, external_data_stores)(std::move(external_data_stores));
+            }
+
+            /**
+             *  The blocks without active point are skipped.
+             */
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Grid, class DataStores>
+            void gridtools_backend_masked_entry_point(cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> backend,
+                Spec spec,
+                Grid const &grid,
+                activity_mask const &mask,
+                DataStores external_data_stores) {
+                gridtools_backend_prepare(backend, spec, grid, external_data_stores)(
+                    std::move(external_data_stores), &mask);
+            }
+
+            /**
+             *  If there are at least as many members as threads, every member is executed by a single thread, with
+             *  the temporaries for one thread only. The members are handed out dynamically, the largest first (see
+             *  `be_api::parallel_for_each_member`).
+             */
+            template <class IBlockSize, class JBlockSize, class ThreadPool, class Spec, class Members>
+            void gridtools_backend_batch_entry_point(
+                cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> backend, Spec spec, Members const &members) {
+                int_t size = members.size();
+                if (size < thread_pool::get_max_threads(ThreadPool())) {
+                    for (auto const &member : members)
+                        gridtools_backend_entry_point(backend, spec, member.grid, member.data_stores);
+                    return;
+                }
+                cpu_kfirst<IBlockSize, JBlockSize, thread_pool::dummy> serial{
+                    backend.i_block_size, backend.j_block_size};
+                be_api::parallel_for_each_member(ThreadPool(), members, [&](auto const &member) {
+                    gridtools_backend_entry_point(serial, spec, member.grid, member.data_stores);
+                });
+            }
+
+            template <class IBlockSize, class JBlockSize, class ThreadPool>
+            std::pair<ThreadPool, cpu_kfirst<IBlockSize, JBlockSize, thread_pool::dummy>> gridtools_backend_split(
+                cpu_kfirst<IBlockSize, JBlockSize, ThreadPool> backend) {
+                return {{}, {backend.i_block_size, backend.j_block_size}};
             }
         } // namespace cpu_kfirst_backend
         using cpu_kfirst_backend::cpu_kfirst;
@@ -0,0 +1,139 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <type_traits>
+
+#include "../../common/defs.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../be_api.hpp"
+#include "../common/dim.hpp"
+
+/**
+ *   @file
+ *
+ *   K-caches for cpu_kfirst.
+ *
+ *   cpu_kfirst visits the k-levels of a stage innermost, column by column. A k-cached temporary that is local to a
+ *   single stage (see `be_api::is_local_k_cache_f`) is therefore held in a sliding window of local variables of the
+ *   k-loop instead of in memory. The window size is known at compile time from the k-extent of the cache.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            namespace k_cache_impl_ {
+                template <class T, int_t Minus, int_t Plus>
+                struct storage {
+                    T m_values[Plus - Minus + 1];
+
+                    storage() = default;
+                    storage(storage const &) = delete;
+                    storage(storage &&) = default;
+
+                    template <class Step, std::enable_if_t<Step::value == 1, int> = 0>
+                    GT_FORCE_INLINE void slide(Step) {
+                        for (int_t k = 0; k < Plus - Minus; ++k)
+                            m_values[k] = m_values[k + 1];
+                    }
+
+                    template <class Step, std::enable_if_t<Step::value == -1, int> = 0>
+                    GT_FORCE_INLINE void slide(Step) {
+                        for (int_t k = Plus - Minus; k > 0; --k)
+                            m_values[k] = m_values[k - 1];
+                    }
+
+                    GT_FORCE_INLINE T *ptr() { return m_values - Minus; }
+                };
+
+                /**
+                 *  Stand-in SID for the k-cached placeholders in the composite. It contributes only the unit k-stride,
+                 *  the pointers are taken from the window.
+                 */
+                struct fake {
+                    fake operator()() const { return {}; }
+                    fake operator*() const;
+                };
+                fake sid_get_ptr_diff(fake);
+                inline fake sid_get_origin(fake) { return {}; }
+                inline fake operator+(fake, fake) { return {}; }
+                inline hymap::keys<dim::k>::values<integral_constant<int_t, 1>> sid_get_strides(fake) { return {}; }
+
+                static_assert(is_sid<fake>(), GT_INTERNAL_ERROR);
+
+                template <class Storages>
+                class k_caches {
+                    Storages m_storages;
+
+                  public:
+                    GT_FORCE_INLINE auto ptr() {
+                        return tuple_util::transform(
+                            [](auto &storage) GT_FORCE_INLINE_LAMBDA { return storage.ptr(); }, m_storages);
+                    }
+
+                    template <class Step>
+                    GT_FORCE_INLINE void slide(Step step) {
+                        tuple_util::for_each(
+                            [step](auto &storage) GT_FORCE_INLINE_LAMBDA { storage.slide(step); }, m_storages);
+                    }
+                };
+
+                template <class PlhInfo, class Extent = typename PlhInfo::extent_t>
+                using make_storage_type =
+                    storage<typename PlhInfo::data_t, Extent::kminus::value, Extent::kplus::value>;
+
+                /**
+                 *  The plh infos of the k-cached temporaries of `Stage` that are held in local variables.
+                 */
+                template <class Stages, class Stage>
+                using local_k_cache_plh_map = meta::filter<
+                    be_api::is_local_k_cache_f<meta::rename<meta::list, Stages>, Stage>::template apply,
+                    meta::rename<meta::list, typename Stage::plh_map_t>>;
+
+                template <class Stages>
+                struct local_k_cache_plh_map_f {
+                    template <class Stage>
+                    using apply = local_k_cache_plh_map<Stages, Stage>;
+                };
+
+                template <class Plhs>
+                struct is_not_in_f {
+                    template <class PlhInfo>
+                    using apply = std::negation<meta::st_contains<Plhs, typename PlhInfo::plh_t>>;
+                };
+
+                /**
+                 *  Removes the temporaries that are held in local variables from the plh map.
+                 */
+                template <class Stages,
+                    class PlhMap,
+                    class StageList = meta::rename<meta::list, Stages>,
+                    class Plhs = meta::transform<be_api::get_plh,
+                        meta::flatten<meta::transform<local_k_cache_plh_map_f<StageList>::template apply, StageList>>>>
+                using remove_local_k_caches = meta::filter<is_not_in_f<Plhs>::template apply, PlhMap>;
+
+                template <class PlhMap,
+                    class Keys = meta::transform<meta::first, PlhMap>,
+                    class Storages = meta::transform<make_storage_type, PlhMap>>
+                using k_caches_type = k_caches<hymap::from_keys_values<Keys, Storages>>;
+            } // namespace k_cache_impl_
+
+            using k_cache_sid_t = k_cache_impl_::fake;
+            using k_cache_impl_::k_caches_type;
+            using k_cache_impl_::local_k_cache_plh_map;
+            using k_cache_impl_::remove_local_k_caches;
+        } // namespace cpu_kfirst_backend
+    }     // namespace stencil
+} // namespace gridtools
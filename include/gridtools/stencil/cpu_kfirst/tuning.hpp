@@ -0,0 +1,74 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "../../common/defs.hpp"
+#include "../../thread_pool/omp.hpp"
+#include "../cpu_kfirst.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            namespace tuning_impl_ {
+                using block_sizes_t = std::pair<int_t, int_t>;
+
+                /**
+                 *  Default candidates: i-blocks from 8 to 128 and j-blocks from 1 to 16, powers of two.
+                 */
+                inline std::vector<block_sizes_t> default_block_sizes() {
+                    std::vector<block_sizes_t> res;
+                    for (int_t i = 8; i <= 128; i *= 2)
+                        for (int_t j = 1; j <= 16; j *= 2)
+                            res.emplace_back(i, j);
+                    return res;
+                }
+
+                /**
+                 *  Sweeps the candidate block sizes and returns the cpu_kfirst backend with the fastest ones.
+                 *
+                 *  `fun` is called with a `cpu_kfirst<int_t, int_t, ThreadPool>` backend and has to run the
+                 *  computation to tune with it. It is called `repetitions` times per candidate, the fastest call
+                 *  counts. Note that `fun` is run many times, so it should not accumulate into its inputs.
+                 */
+                template <class ThreadPool = thread_pool::omp, class Fun>
+                cpu_kfirst<int_t, int_t, ThreadPool> tune_block_sizes(Fun &&fun,
+                    std::vector<block_sizes_t> const &candidates = default_block_sizes(),
+                    int repetitions = 3) {
+                    assert(!candidates.empty() && repetitions > 0);
+                    using backend_t = cpu_kfirst<int_t, int_t, ThreadPool>;
+                    backend_t res = {candidates.front().first, candidates.front().second};
+                    double best = std::numeric_limits<double>::max();
+                    for (auto &&candidate : candidates) {
+                        backend_t backend = {candidate.first, candidate.second};
+                        for (int r = 0; r < repetitions; ++r) {
+                            auto start = std::chrono::steady_clock::now();
+                            fun(backend);
+                            std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+                            if (time.count() < best) {
+                                best = time.count();
+                                res = backend;
+                            }
+                        }
+                    }
+                    return res;
+                }
+            } // namespace tuning_impl_
+
+            using tuning_impl_::default_block_sizes;
+            using tuning_impl_::tune_block_sizes;
+        } // namespace cpu_kfirst_backend
+    }     // namespace stencil
+} // namespace gridtools
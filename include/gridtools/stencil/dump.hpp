@@ -79,9 +79,11 @@ namespace gridtools {
                 class NumColors,
                 class IsConst,
                 class Extent,
-                class... CacheIoPolicies>
+                class... CacheIoPolicies,
+                class InlinedTmps>
             json from(
-                be_api::plh_info<L<Plh, Caches...>, IsTmp, Data, NumColors, IsConst, Extent, LL<CacheIoPolicies...>>) {
+                be_api::plh_info<L<Plh, Caches...>, IsTmp, Data, NumColors, IsConst, Extent, LL<CacheIoPolicies...>>,
+                InlinedTmps) {
                 json res = {{"plh", from_plh(Plh())},
                     {"caches", json::array({from(Caches())...})},
                     {"is_tmp", IsTmp::value},
@@ -89,8 +91,10 @@ namespace gridtools {
                     {"is_const", IsConst::value},
                     {"extent", from(Extent())},
                     {"cache_io_policies", json::array({from(CacheIoPolicies())...})}};
-                if (IsTmp::value)
+                if (IsTmp::value) {
                     res["num_colors"] = NumColors::value;
+                    res["inlined"] = meta::st_contains<InlinedTmps, Plh>::value;
+                }
                 return res;
             }
 
@@ -124,36 +128,44 @@ namespace gridtools {
                 class... PlhInfos,
                 class Extent,
                 class Execution,
-                class NeedSync>
-            json from(be_api::cell<L<FunCalls...>, Interval, LL<PlhInfos...>, Extent, Execution, NeedSync>) {
+                class NeedSync,
+                class InlinedTmps>
+            json from(
+                be_api::cell<L<FunCalls...>, Interval, LL<PlhInfos...>, Extent, Execution, NeedSync>, InlinedTmps) {
                 return {{"fun_calls", json::array({from_fun_call(FunCalls())...})},
                     {"interval", from(Interval())},
-                    {"plh_infos", json::array({from(PlhInfos())...})},
+                    {"plh_infos", json::array({from(PlhInfos(), InlinedTmps())...})},
                     {"extent", from(Extent())},
                     {"execution", from(Execution())},
                     {"need_sync", NeedSync::value}};
             }
 
-            template <template <class...> class L, class... Cells>
-            auto from_row(L<Cells...>) {
-                return json::array({from(Cells())...});
+            template <template <class...> class L, class... Cells, class InlinedTmps>
+            auto from_row(L<Cells...>, InlinedTmps) {
+                return json::array({from(Cells(), InlinedTmps())...});
             }
 
-            template <template <class...> class L, class... Rows>
-            auto from_matrix(L<Rows...>) {
-                return json::array({from_row(Rows())...});
+            template <template <class...> class L, class... Rows, class InlinedTmps>
+            auto from_matrix(L<Rows...>, InlinedTmps) {
+                return json::array({from_row(Rows(), InlinedTmps())...});
             }
 
-            template <template <class...> class L, class... Matrices>
-            auto from_matrices(L<Matrices...>) {
-                return json::array({from_matrix(Matrices())...});
+            /**
+             *  The temporaries are marked as "inlined" if they are computed on the fly by the backends that support
+             *  it, see `be_api::is_inlined_tmp_f`.
+             */
+            template <template <class...> class L, class... Matrices, class InlinedTmps>
+            auto from_matrices(L<Matrices...>, InlinedTmps) {
+                return json::array({from_matrix(Matrices(), InlinedTmps())...});
             }
 
             struct dump {
                 std::ostream &m_sink;
                 template <class Spec, class... Ts>
                 friend void gridtools_backend_entry_point(dump obj, Spec, Ts &&...) {
-                    obj.m_sink << from_matrices(be_api::make_fused_view<Spec>()) << std::endl;
+                    obj.m_sink << from_matrices(be_api::make_fused_view<Spec>(),
+                                      be_api::inlined_tmp_plhs<be_api::make_split_view<Spec>>())
+                               << std::endl;
                 }
             };
         } // namespace dump_backend
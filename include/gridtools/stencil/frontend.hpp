@@ -14,6 +14,12 @@
 #include "common/intent.hpp"
 #include "frontend/axis.hpp"
 #include "frontend/expandable_run.hpp"
+#include "frontend/graph.hpp"
 #include "frontend/make_grid.hpp"
 #include "frontend/make_param_list.hpp"
+#include "frontend/prepare.hpp"
 #include "frontend/run.hpp"
+#include "frontend/run_batch.hpp"
+#include "frontend/run_ensemble.hpp"
+#include "frontend/run_masked.hpp"
+#include "frontend/run_timesteps.hpp"
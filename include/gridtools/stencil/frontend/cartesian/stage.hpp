@@ -70,6 +70,8 @@ namespace gridtools {
 
                 template <class Functor, class PlhMap>
                 struct stage {
+                    using functor_t = Functor;
+
                     template <class Deref = void, class Ptr, class Strides>
                     GT_FUNCTION void operator()(Ptr const &ptr, Strides const &strides) const {
                         using deref_t = meta::if_<std::is_void<Deref>, default_deref_f, Deref>;
@@ -0,0 +1,167 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../../common/for_each.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../common/extent.hpp"
+#include "../core/backend.hpp"
+#include "../core/compute_extents_metafunctions.hpp"
+#include "../core/is_tmp_arg.hpp"
+#include "run.hpp"
+
+/**
+ *   @file
+ *
+ *   Deferred execution of a sequence of stencil compositions on the same fields.
+ *
+ *       auto g = make_graph(backend, grid, fields...).run(comp1).run(comp2);
+ *       g.execute();
+ *
+ *   has the same effect as
+ *
+ *       run(comp1, backend, grid, fields...);
+ *       run(comp2, backend, grid, fields...);
+ *
+ *   The compositions take all the fields of the graph as arguments (they can ignore some of them). Because the
+ *   fields are shared, the dependencies between the runs are known at compile time and consecutive runs are fused
+ *   into a single composition (as if they were passes of one `multi_pass`) that the backend executes in a single
+ *   sweep. A new sweep is started only where it is needed to keep the semantics of the separate runs: if a field
+ *   that is written by one of the runs is accessed at horizontal offsets by a run of the current sweep or by the
+ *   next one. In a single blocked sweep, the neighbouring blocks of such a field would be read before they are
+ *   written (or written before they are read).
+ *
+ *   Temporaries of different runs never need a new sweep.
+ *
+ *   The graph holds references to the fields; they have to outlive it.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace graph_impl_ {
+            template <class L, class R>
+            struct concat_specs;
+
+            template <class... Ls, class... Rs>
+            struct concat_specs<frontend_impl_::spec<Ls...>, frontend_impl_::spec<Rs...>> {
+                using type = frontend_impl_::spec<Ls..., Rs...>;
+            };
+
+            template <class Spec>
+            using extent_map = core::get_extent_map_from_msses<Spec>;
+
+            template <class Spec>
+            using accessed_args = meta::transform<meta::first, extent_map<Spec>>;
+
+            template <class Spec, class Arg>
+            using is_accessed_at_offsets = std::negation<
+                std::is_same<to_horizontal_extent<core::lookup_extent_map<extent_map<Spec>, Arg>>, extent<>>>;
+
+            template <class L, class R>
+            struct needs_sweep_f {
+                template <class Arg>
+                using apply = std::conjunction<std::negation<core::is_tmp_arg<Arg>>,
+                    meta::st_contains<accessed_args<L>, Arg>,
+                    std::disjunction<meta::st_contains<frontend_impl_::all_rw_args<L>, Arg>,
+                        meta::st_contains<frontend_impl_::all_rw_args<R>, Arg>>,
+                    std::disjunction<is_accessed_at_offsets<L, Arg>, is_accessed_at_offsets<R, Arg>>>;
+            };
+
+            template <class L, class R>
+            using can_fuse = std::negation<meta::any_of<needs_sweep_f<L, R>::template apply, accessed_args<R>>>;
+
+            template <class Sweeps, class Spec, class = void>
+            struct add_run {
+                using type = meta::push_back<Sweeps, Spec>;
+            };
+
+            template <class Sweeps, class Spec>
+            struct add_run<Sweeps, Spec, std::enable_if_t<can_fuse<meta::last<Sweeps>, Spec>::value>> {
+                using type = meta::push_back<meta::pop_back<Sweeps>,
+                    typename concat_specs<meta::last<Sweeps>, Spec>::type>;
+            };
+
+            template <class Sweeps, class Spec>
+            using add_run_t = typename add_run<Sweeps, Spec>::type;
+
+            /**
+             *  Splits the list of the compositions `Specs` into the compositions that are executed in one sweep.
+             */
+            template <class Specs>
+            using make_sweeps = meta::foldl<add_run_t, meta::list<meta::first<Specs>>, meta::pop_front<Specs>>;
+
+            template <class Backend, class Grid, class Indices, class DataStoreMap, class Specs>
+            class graph;
+
+            template <class Backend, class Grid, size_t... Is, class DataStoreMap, class... Specs>
+            class graph<Backend, Grid, std::index_sequence<Is...>, DataStoreMap, meta::list<Specs...>> {
+                Backend m_backend;
+                Grid m_grid;
+                DataStoreMap m_data_stores;
+
+              public:
+                graph(Backend backend, Grid const &grid, DataStoreMap data_stores)
+                    : m_backend(std::move(backend)), m_grid(grid), m_data_stores(std::move(data_stores)) {}
+
+                /**
+                 *  Returns the graph with the composition `comp` appended; `comp` is called with the placeholders
+                 *  of all the fields of the graph.
+                 */
+                template <class Comp>
+                auto run(Comp comp) const {
+                    using spec_t = decltype(comp(frontend_impl_::arg<Is>()...));
+                    frontend_impl_::check_spec<spec_t, Grid>();
+                    return graph<Backend, Grid, std::index_sequence<Is...>, DataStoreMap, meta::list<Specs..., spec_t>>(
+                        m_backend, m_grid, m_data_stores);
+                }
+
+                void execute() const {
+                    if constexpr (sizeof...(Specs) != 0)
+                        for_each<make_sweeps<meta::list<Specs...>>>([&](auto sweep) {
+                            using spec_t = decltype(sweep);
+                            tuple_util::apply(
+                                [&](auto const &...fields) {
+                                    frontend_impl_::check_bounds<spec_t>(
+                                        m_grid, std::index_sequence<Is...>(), fields...);
+                                },
+                                m_data_stores);
+                            core::call_entry_point_f<spec_t>()(m_backend, m_grid, m_data_stores);
+                        });
+                }
+            };
+
+            template <class Backend, class Grid, size_t... Is, class... Fields>
+            auto make_graph_impl(Backend backend, Grid const &grid, std::index_sequence<Is...>, Fields &...fields) {
+                using data_store_map_t = typename hymap::keys<frontend_impl_::arg<Is>...>::template values<Fields &...>;
+                return graph<Backend, Grid, std::index_sequence<Is...>, data_store_map_t, meta::list<>>(
+                    std::move(backend), grid, data_store_map_t{fields...});
+            }
+
+            /**
+             *  The empty graph on the given fields.
+             */
+            template <class Backend, class Grid, class... Fields>
+            auto make_graph(Backend backend, Grid const &grid, Fields &...fields) {
+                static_assert(
+                    std::conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                return make_graph_impl(std::move(backend), grid, std::index_sequence_for<Fields...>(), fields...);
+            }
+        } // namespace graph_impl_
+        using graph_impl_::graph;
+        using graph_impl_::make_graph;
+    } // namespace stencil
+} // namespace gridtools
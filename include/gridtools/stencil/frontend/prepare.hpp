@@ -0,0 +1,81 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "../../common/hymap.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../core/backend.hpp"
+#include "run.hpp"
+
+/**
+ *   @file
+ *
+ *   Stencil computations that are set up once and executed many times.
+ *
+ *   `auto stencil = prepare(comp, backend, grid, fields...);` does everything that `run(comp, backend, grid,
+ *   fields...)` does before the execution of the stencil, that depends on the grid and on the types of the fields,
+ *   but not on the data. What this is depends on the backend, for instance cpu_ifirst computes the block
+ *   decomposition and allocates the temporaries here. Backends without such support do all the work on every call.
+ *
+ *   `stencil(fields...)` then executes the computation on the given fields, which must have the same types as the
+ *   fields that were passed to `prepare` and should have the same sizes. It is equivalent to `run(comp, backend, grid,
+ *   fields...)`.
+ *
+ *   The prepared stencil owns the temporaries of the computation, thus it can not be called concurrently.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace prepare_impl_ {
+            template <class DataStoreMap, class Impl>
+            class prepared {
+                Impl m_impl;
+
+              public:
+                prepared(Impl impl) : m_impl(std::move(impl)) {}
+
+                template <class... Fields>
+                void operator()(Fields &&...fields) const {
+                    m_impl(DataStoreMap{fields...});
+                }
+            };
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            auto prepare_impl(
+                Comp comp, Backend &&be, Grid const &grid, std::index_sequence<Is...>, Fields &&...fields) {
+                using spec_t = decltype(comp(frontend_impl_::arg<Is>()...));
+                frontend_impl_::check_spec<spec_t, Grid>();
+                frontend_impl_::check_bounds<spec_t>(grid, std::index_sequence<Is...>(), fields...);
+                using data_store_map_t = typename hymap::keys<frontend_impl_::arg<Is>...>::template values<
+                    std::remove_reference_t<Fields> &...>;
+                auto impl = core::prepare_entry_point_f<spec_t>()(
+                    std::forward<Backend>(be), grid, data_store_map_t{fields...});
+                return prepared<data_store_map_t, decltype(impl)>(std::move(impl));
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields>
+            auto prepare(Comp comp, Backend &&be, Grid const &grid, Fields &&...fields) {
+                static_assert(
+                    std::conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                return prepare_impl(comp,
+                    std::forward<Backend>(be),
+                    grid,
+                    std::index_sequence_for<Fields...>(),
+                    std::forward<Fields>(fields)...);
+            }
+        } // namespace prepare_impl_
+        using prepare_impl_::prepare;
+    } // namespace stencil
+} // namespace gridtools
@@ -30,6 +30,7 @@
 #include "../core/functor_metafunctions.hpp"
 #include "../core/is_tmp_arg.hpp"
 #include "../core/mss.hpp"
+#include "../reduction_output.hpp"
 
 namespace gridtools {
     namespace stencil {
@@ -198,22 +199,40 @@ namespace gridtools {
                 using apply = core::check_valid_apply_overloads<Functor, Interval>;
             };
 
-            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
-            auto run_impl(Comp comp, Backend &&be, Grid const &grid, std::index_sequence<Is...>, Fields &&...fields)
-                -> std::void_t<decltype(comp(arg<Is>()...))> {
-                using spec_t = decltype(comp(arg<Is>()...));
+            template <class Spec, class Grid>
+            void check_spec() {
                 static_assert(
-                    meta::is_instantiation_of<spec, spec_t>::value, "Invalid stencil composition specification.");
+                    meta::is_instantiation_of<spec, Spec>::value, "Invalid stencil composition specification.");
                 static_assert(
                     meta::is_instantiation_of<core::interval, typename Grid::interval_t>::value, "Invalid grid.");
-                using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, spec_t>>>;
+                using functors_t = meta::transform<meta::first, meta::flatten<meta::transform<meta::second, Spec>>>;
                 static_assert(meta::all_of<check_valid_apply_overloads<typename Grid::interval_t>::template apply,
                                   functors_t>::value,
                     "Invalid stencil operator detected.");
+            }
 
-                using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
+            template <class Extent>
+            using is_horizontally_empty = std::bool_constant<Extent::iminus::value == 0 && Extent::iplus::value == 0 &&
+                                                             Extent::jminus::value == 0 && Extent::jplus::value == 0>;
+
+            template <class ExtentMap>
+            struct is_written_in_compute_domain_f {
+                template <class Arg, class Field>
+                using apply = std::disjunction<std::negation<is_reduction_ptr<sid::ptr_type<Field>>>,
+                    is_horizontally_empty<core::lookup_extent_map<ExtentMap, Arg>>>;
+            };
+
+            template <class Spec, class Grid, class... Fields, size_t... Is>
+            void check_bounds(Grid const &grid, std::index_sequence<Is...>, Fields const &...fields) {
+                // the backends compute the stages on their extent, thus the points of the halo and of the overlapping
+                // blocks would be accumulated into a reduction output
+                static_assert(meta::all<meta::transform<
+                                  is_written_in_compute_domain_f<core::get_extent_map_from_msses<Spec>>::template apply,
+                                  meta::list<arg<Is>...>,
+                                  meta::list<Fields...>>>::value,
+                    "Reduction outputs should be written by stages with empty horizontal extent.");
 #ifndef NDEBUG
-                using extent_map_t = core::get_extent_map_from_msses<spec_t>;
+                using extent_map_t = core::get_extent_map_from_msses<Spec>;
                 auto check_bounds = [origin = grid.origin(), size = grid.size()](auto arg, auto const &field) {
                     using extent_t = core::lookup_extent_map<extent_map_t, decltype(arg)>;
                     // There is no check in k-direction because at the fields may be used within subintervals
@@ -230,6 +249,15 @@ namespace gridtools {
                 using loop_t = int[sizeof...(Is)];
                 (void)loop_t{check_bounds(arg<Is>(), fields)...};
 #endif
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            auto run_impl(Comp comp, Backend &&be, Grid const &grid, std::index_sequence<Is...>, Fields &&...fields)
+                -> std::void_t<decltype(comp(arg<Is>()...))> {
+                using spec_t = decltype(comp(arg<Is>()...));
+                check_spec<spec_t, Grid>();
+                check_bounds<spec_t>(grid, std::index_sequence<Is...>(), fields...);
+                using data_store_map_t = typename hymap::keys<arg<Is>...>::template values<Fields &...>;
                 core::call_entry_point_f<spec_t>()(std::forward<Backend>(be), grid, data_store_map_t{fields...});
             }
 
@@ -0,0 +1,87 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../common/hymap.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../core/backend.hpp"
+#include "run.hpp"
+
+/**
+ *   @file
+ *
+ *   Execution of one stencil composition on a batch of independent domains.
+ *
+ *       std::vector<std::tuple<Grid, Field, Field>> members = ...;
+ *       run_batch(comp, backend, members);
+ *
+ *   has the same effect as
+ *
+ *       for (auto &[grid, in, out] : members)
+ *           run(comp, backend, grid, in, out);
+ *
+ *   `members` is a range of tuple-like elements, each of them holds the grid followed by the fields of one member.
+ *   All members have the same types, but the sizes of their grids and fields can differ.
+ *
+ *   The backends with support for batches (cpu_kfirst and cpu_ifirst) execute the members concurrently if there are
+ *   enough of them to keep all threads busy: each thread then executes whole members, taking the next one (the largest
+ *   remaining) as soon as it is done. With fewer members, they are executed one after the other, each of them in
+ *   parallel over its blocks. Other backends always do the latter.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace run_batch_impl_ {
+            template <class Member, size_t I>
+            using field_type = std::remove_reference_t<decltype(tuple_util::get<I + 1>(std::declval<Member &>()))>;
+
+            template <class Comp, class Backend, class Members, size_t... Is>
+            void run_batch_impl(Comp comp, Backend &&be, Members &members, std::index_sequence<Is...>) {
+                using member_t = std::remove_reference_t<decltype(*std::begin(members))>;
+                using grid_t = std::decay_t<decltype(tuple_util::get<0>(std::declval<member_t &>()))>;
+                static_assert(std::conjunction<is_sid<field_type<member_t, Is>>...>::value,
+                    "All computation fields must satisfy SID concept.");
+                using spec_t = decltype(comp(frontend_impl_::arg<Is>()...));
+                frontend_impl_::check_spec<spec_t, grid_t>();
+                using data_store_map_t = typename hymap::keys<frontend_impl_::arg<Is>...>::template values<
+                    field_type<member_t, Is> &...>;
+                std::vector<core::batch_member<grid_t, data_store_map_t>> batch;
+                for (auto &member : members) {
+                    auto const &grid = tuple_util::get<0>(member);
+                    frontend_impl_::check_bounds<spec_t>(
+                        grid, std::index_sequence<Is...>(), tuple_util::get<Is + 1>(member)...);
+                    batch.push_back({grid, data_store_map_t{tuple_util::get<Is + 1>(member)...}});
+                }
+                core::call_batch_entry_point_f<spec_t>()(std::forward<Backend>(be), batch);
+            }
+
+            /**
+             *  Executes the composition `comp` for all members of `members`, see above.
+             */
+            template <class Comp, class Backend, class Members>
+            void run_batch(Comp comp, Backend &&be, Members &&members) {
+                using member_t = std::decay_t<decltype(*std::begin(members))>;
+                run_batch_impl(comp,
+                    std::forward<Backend>(be),
+                    members,
+                    std::make_index_sequence<tuple_util::size<member_t>::value - 1>());
+            }
+        } // namespace run_batch_impl_
+        using run_batch_impl_::run_batch;
+    } // namespace stencil
+} // namespace gridtools
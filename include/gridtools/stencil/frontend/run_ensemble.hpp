@@ -0,0 +1,97 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/rename_dimensions.hpp"
+#include "../common/dim.hpp"
+#include "../core/backend.hpp"
+#include "run.hpp"
+
+/**
+ *   @file
+ *
+ *   Execution of a stencil composition on all members of an ensemble.
+ *
+ *       auto builder = storage::builder<Traits>.type<double>().dimensions(ni, nj, nk).ensemble(n);
+ *       auto in = builder.build();
+ *       auto out = builder.build();
+ *       run_ensemble(comp, backend, grid, n, in, out);
+ *
+ *   has the same effect as running `comp` once per member on the fields restricted to that member.
+ *
+ *   The fourth dimension of the fields is the index of the member (`dim::e` for the backends), as added by
+ *   `storage::builder<...>.ensemble(...)`. Fields with three dimensions or less are shared by all members. The
+ *   stencil operators are written for a single member: the accessors don't address the ensemble dimension.
+ *
+ *   The members are stored contiguously, thus cpu_ifirst with SIMD enabled vectorizes the stages across the
+ *   members instead of along i, which gives full vectors even on small horizontal domains. The other backends
+ *   execute the members one after the other.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace run_ensemble_impl_ {
+            template <class Field>
+            auto as_ensemble_field(Field &&field) {
+                return sid::rename_dimensions<integral_constant<int_t, 3>, dim::e>(std::forward<Field>(field));
+            }
+
+            template <class Field>
+            void check_members(int_t members, Field const &field) {
+#ifndef NDEBUG
+                auto u_bounds = sid::get_upper_bounds(field);
+                if constexpr (has_key<decltype(u_bounds), dim::e>::value)
+                    assert(sid::get_upper_bound<dim::e>(u_bounds) >= members);
+#endif
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            void run_ensemble_impl(Comp comp,
+                Backend &&be,
+                Grid const &grid,
+                int_t members,
+                std::index_sequence<Is...>,
+                Fields &&...fields) {
+                using spec_t = decltype(comp(frontend_impl_::arg<Is>()...));
+                frontend_impl_::check_spec<spec_t, Grid>();
+                frontend_impl_::check_bounds<spec_t>(grid, std::index_sequence<Is...>(), fields...);
+                (check_members(members, fields), ...);
+                using data_store_map_t = typename hymap::keys<frontend_impl_::arg<Is>...>::template values<Fields...>;
+                core::call_ensemble_entry_point_f<spec_t>()(
+                    std::forward<Backend>(be), grid, members, data_store_map_t{std::forward<Fields>(fields)...});
+            }
+
+            /**
+             *  Executes the composition `comp` for the `members` members of the ensemble, see above.
+             */
+            template <class Comp, class Backend, class Grid, class... Fields>
+            void run_ensemble(Comp comp, Backend &&be, Grid const &grid, int_t members, Fields &&...fields) {
+                static_assert(
+                    std::conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                run_ensemble_impl(comp,
+                    std::forward<Backend>(be),
+                    grid,
+                    members,
+                    std::index_sequence_for<Fields...>(),
+                    as_ensemble_field(std::forward<Fields>(fields))...);
+            }
+        } // namespace run_ensemble_impl_
+        using run_ensemble_impl_::run_ensemble;
+    } // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,80 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/hymap.hpp"
+#include "../../sid/concept.hpp"
+#include "../common/activity_mask.hpp"
+#include "../core/backend.hpp"
+#include "run.hpp"
+
+/**
+ *   @file
+ *
+ *   Execution of a stencil composition restricted to the active points of the grid.
+ *
+ *       activity_mask mask(grid.i_size(), grid.j_size(), [&](int i, int j) { return is_ocean(i, j); });
+ *       run_masked(comp, backend, grid, mask, in, out);
+ *
+ *   or, with a list of rectangles of the compute domain (the ends are exclusive),
+ *
+ *       activity_mask mask(grid.i_size(), grid.j_size(), {{0, 4, 0, nj}, {ni - 4, ni, 0, nj}});
+ *
+ *   computes the stencil at least on the active points: the backends with support for masks (cpu_kfirst and
+ *   cpu_ifirst) skip the blocks of their decomposition that have no active point, all the points of the other blocks
+ *   are computed. Thus the cost is proportional to the active area if the active points are clustered. The other
+ *   backends compute the whole grid.
+ *
+ *   The indices of the mask start at the first point of the compute domain, its size is the one of the compute
+ *   domain.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace run_masked_impl_ {
+            template <class Comp, class Backend, class Grid, class... Fields, size_t... Is>
+            void run_masked_impl(Comp comp,
+                Backend &&be,
+                Grid const &grid,
+                activity_mask const &mask,
+                std::index_sequence<Is...>,
+                Fields &&...fields) {
+                using spec_t = decltype(comp(frontend_impl_::arg<Is>()...));
+                frontend_impl_::check_spec<spec_t, Grid>();
+                frontend_impl_::check_bounds<spec_t>(grid, std::index_sequence<Is...>(), fields...);
+                assert(mask.i_size() == grid.i_size() && mask.j_size() == grid.j_size());
+                using data_store_map_t = typename hymap::keys<frontend_impl_::arg<Is>...>::template values<Fields...>;
+                core::call_masked_entry_point_f<spec_t>()(
+                    std::forward<Backend>(be), grid, mask, data_store_map_t{std::forward<Fields>(fields)...});
+            }
+
+            /**
+             *  Executes the composition `comp` on the active points of `mask`, see above.
+             */
+            template <class Comp, class Backend, class Grid, class... Fields>
+            void run_masked(Comp comp, Backend &&be, Grid const &grid, activity_mask const &mask, Fields &&...fields) {
+                static_assert(
+                    std::conjunction<is_sid<Fields>...>::value, "All computation fields must satisfy SID concept.");
+                run_masked_impl(comp,
+                    std::forward<Backend>(be),
+                    grid,
+                    mask,
+                    std::index_sequence_for<Fields...>(),
+                    std::forward<Fields>(fields)...);
+            }
+        } // namespace run_masked_impl_
+        using run_masked_impl_::run_masked;
+    } // namespace stencil
+} // namespace gridtools
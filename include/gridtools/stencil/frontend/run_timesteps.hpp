@@ -0,0 +1,341 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/defs.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../meta.hpp"
+#include "../../sid/allocator.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/sid_shift_origin.hpp"
+#include "../../sid/synthetic.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../common/dim.hpp"
+#include "../common/intent.hpp"
+#include "../core/backend.hpp"
+#include "../core/compute_extents_metafunctions.hpp"
+#include "run.hpp"
+
+/**
+ *   @file
+ *
+ *   Temporal blocking for the repeated application of a stencil composition on host backends.
+ *
+ *   `run_timesteps(steps, comp, backend, grid, current, next, other_fields...)` has the same effect as
+ *
+ *       for (int step = 0; step != steps; ++step) {
+ *           run(comp, backend, grid, current, next, other_fields...);
+ *           swap(current, next);
+ *       }
+ *
+ *   where `swap` exchanges the roles of the two fields (not their content): the composition reads the state of the
+ *   current time step from its first argument and writes the state of the next one into its second argument.
+ *   After the call the last state is in `current` if `steps` is even and in `next` otherwise, the other field holds
+ *   the state of the step before.
+ *
+ *   The time steps are grouped into blocks of `temporal_blocking::steps` steps. Within a block, the horizontal
+ *   domain is split into tiles and every tile advances the whole block at once, on a local copy of the data that
+ *   fits into the cache. The tiles are overlapped: the copy covers the tile extended by the enclosing extent of the
+ *   current state per time step, the extension shrinks with every step, such that the tile itself is computed
+ *   correctly at the end of the block (at the price of some redundant computation). The data is thus read from and
+ *   written to main memory once per block instead of once per step.
+ *
+ *   The tiles are independent: if the backend can be split into a thread pool and a single threaded variant (see
+ *   `gridtools_backend_split` in core/backend.hpp, cpu_kfirst and cpu_ifirst can), the tiles are distributed over
+ *   the threads of the pool and every thread advances its tiles with the single threaded backend in its own local
+ *   copies. Otherwise the tiles are executed one after the other, each time step by the backend itself. Every time
+ *   step of a tile is a run of the backend on the tile, thus the tiles should not be too small; the local copies are
+ *   laid out like the fields (contiguous along i or along k).
+ *
+ *   Requirements on the composition:
+ *     - the first argument is only read, the second one is only written;
+ *     - the second argument is not read at horizontal offsets;
+ *     - the other arguments are only read.
+ *
+ *   The local copies are plain host memory, thus this works with the naive, cpu_kfirst and cpu_ifirst backends.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace run_timesteps_impl_ {
+            /**
+             *  Tiling parameters of `run_timesteps`. The number of time steps per block is made odd by rounding down.
+             *  Tile sizes of zero are chosen such that the local copies of a tile fit into `cache_bytes`.
+             */
+            struct temporal_blocking {
+                int steps = 3;
+                int_t i_size = 0;
+                int_t j_size = 0;
+                std::size_t cache_bytes = std::size_t(1) << 22;
+            };
+
+            struct box {
+                int_t lo[3];
+                int_t hi[3];
+            };
+
+            using box_dims_t = meta::list<dim::i, dim::j, dim::k>;
+
+            // copies the points of `b` that are outside of `hole` (or all of them if `hole` is empty), row by row
+            // along dimension `D`
+            template <int D, class Dst, class Src>
+            void copy_box(Dst &dst, Src &src, box const &b, box const &hole = {}) {
+                using dim_t = meta::at_c<box_dims_t, D>;
+                // the remaining dimensions, the outer one is the slower one of the layout
+                constexpr int mid = 1;
+                constexpr int outer = 2 - D;
+                auto dst_origin = sid::get_origin(dst);
+                auto src_origin = sid::get_origin(src);
+                auto dst_strides = sid::get_strides(dst);
+                auto src_strides = sid::get_strides(src);
+                int_t pos[3];
+                auto copy_row = [&](int_t from, int_t to) {
+                    using namespace literals;
+                    pos[D] = from;
+                    auto dst_ptr = dst_origin();
+                    auto src_ptr = src_origin();
+                    sid::shift(dst_ptr, sid::get_stride<dim::i>(dst_strides), pos[0]);
+                    sid::shift(dst_ptr, sid::get_stride<dim::j>(dst_strides), pos[1]);
+                    sid::shift(dst_ptr, sid::get_stride<dim::k>(dst_strides), pos[2]);
+                    sid::shift(src_ptr, sid::get_stride<dim::i>(src_strides), pos[0]);
+                    sid::shift(src_ptr, sid::get_stride<dim::j>(src_strides), pos[1]);
+                    sid::shift(src_ptr, sid::get_stride<dim::k>(src_strides), pos[2]);
+                    for (int_t n = from; n < to; ++n) {
+                        *dst_ptr = *src_ptr;
+                        sid::shift(dst_ptr, sid::get_stride<dim_t>(dst_strides), 1_c);
+                        sid::shift(src_ptr, sid::get_stride<dim_t>(src_strides), 1_c);
+                    }
+                };
+                for (pos[outer] = b.lo[outer]; pos[outer] < b.hi[outer]; ++pos[outer])
+                    for (pos[mid] = b.lo[mid]; pos[mid] < b.hi[mid]; ++pos[mid]) {
+                        if (pos[outer] < hole.lo[outer] || pos[outer] >= hole.hi[outer] || pos[mid] < hole.lo[mid] ||
+                            pos[mid] >= hole.hi[mid]) {
+                            copy_row(b.lo[D], b.hi[D]);
+                            continue;
+                        }
+                        copy_row(b.lo[D], std::min(b.hi[D], hole.lo[D]));
+                        copy_row(std::max(b.lo[D], hole.hi[D]), b.hi[D]);
+                    }
+            }
+
+            template <class KFirst>
+            struct buffer_strides_kind;
+
+            using buffer_keys_t = hymap::keys<dim::i, dim::j, dim::k>;
+
+            inline auto buffer_strides(std::false_type, int_t i_size, int_t j_size, int_t) {
+                using namespace literals;
+                return buffer_keys_t::make_values(1_c, i_size, i_size * j_size);
+            }
+
+            inline auto buffer_strides(std::true_type, int_t, int_t j_size, int_t k_size) {
+                using namespace literals;
+                return buffer_keys_t::make_values(j_size * k_size, k_size, 1_c);
+            }
+
+            // a local copy of the fields on the box `b`, indexed in the coordinates of the fields; the local copy is
+            // contiguous along i or, if `KFirst` is set, along k, like the fields
+            template <class KFirst, class PtrHolder>
+            auto make_buffer(KFirst, PtrHolder const &origin, box const &b) {
+                int_t i_size = b.hi[0] - b.lo[0];
+                int_t j_size = b.hi[1] - b.lo[1];
+                int_t k_size = b.hi[2] - b.lo[2];
+                return sid::shift_sid_origin(
+                    sid::synthetic()
+                        .set<sid::property::origin>(origin)
+                        .template set<sid::property::strides>(buffer_strides(KFirst(), i_size, j_size, k_size))
+                        .template set<sid::property::strides_kind, buffer_strides_kind<KFirst>>()
+                        .template set<sid::property::ptr_diff, int_t>()
+                        .template set<sid::property::lower_bounds>(buffer_keys_t::make_values(0, 0, 0))
+                        .template set<sid::property::upper_bounds>(buffer_keys_t::make_values(i_size, j_size, k_size)),
+                    buffer_keys_t::make_values(-b.lo[0], -b.lo[1], -b.lo[2]));
+            }
+
+            template <class Spec, size_t I>
+            using arg_extent = core::lookup_extent_map<core::get_extent_map_from_msses<Spec>, frontend_impl_::arg<I>>;
+
+            template <class Spec, size_t I>
+            using is_read_only = std::bool_constant<decltype(frontend_impl_::get_arg_intent(
+                                                        Spec(), frontend_impl_::arg<I>()))::value == intent::in>;
+
+            template <class Comp,
+                class Backend,
+                class Grid,
+                class Current,
+                class Next,
+                class... Rest,
+                size_t... Is>
+            void run_timesteps_impl(temporal_blocking const &blocking,
+                int steps,
+                Comp comp,
+                Backend &&be,
+                Grid const &grid,
+                std::index_sequence<Is...>,
+                Current &current,
+                Next &next,
+                Rest &...rest) {
+                using spec_t = decltype(
+                    comp(frontend_impl_::arg<0>(), frontend_impl_::arg<1>(), frontend_impl_::arg<Is + 2>()...));
+                static_assert(meta::is_instantiation_of<frontend_impl_::spec, spec_t>::value,
+                    "Invalid stencil composition specification.");
+                static_assert(is_read_only<spec_t, 0>::value, "The current state should be read only.");
+                using next_extent_t = arg_extent<spec_t, 1>;
+                static_assert(next_extent_t::iminus::value == 0 && next_extent_t::iplus::value == 0 &&
+                                  next_extent_t::jminus::value == 0 && next_extent_t::jplus::value == 0,
+                    "The next state should not be read at horizontal offsets.");
+                static_assert(std::conjunction<is_read_only<spec_t, Is + 2>...>::value,
+                    "The fields other than the next state should be read only.");
+
+                using extent_t = arg_extent<spec_t, 0>;
+                int_t i_minus = -extent_t::iminus::value, i_plus = extent_t::iplus::value;
+                int_t j_minus = -extent_t::jminus::value, j_plus = extent_t::jplus::value;
+
+                auto origin = grid.origin();
+                int_t i_start = at_key<dim::i>(origin), i_size = grid.i_size();
+                int_t j_start = at_key<dim::j>(origin), j_size = grid.j_size();
+                int_t k_start = at_key<dim::k>(origin), k_size = grid.k_size();
+                // the vertical extent is an over-approximation if the vertical offsets depend on the interval
+                int_t k_lo = std::max({int_t(k_start + extent_t::kminus::value),
+                    int_t(sid::get_lower_bound<dim::k>(sid::get_lower_bounds(current))),
+                    int_t(sid::get_lower_bound<dim::k>(sid::get_lower_bounds(next)))});
+                int_t k_hi = std::min({int_t(k_start + k_size + extent_t::kplus::value),
+                    int_t(sid::get_upper_bound<dim::k>(sid::get_upper_bounds(current))),
+                    int_t(sid::get_upper_bound<dim::k>(sid::get_upper_bounds(next)))});
+                box domain = {{i_start, j_start, k_start}, {i_start + i_size, j_start + j_size, k_start + k_size}};
+
+                int block_steps = std::max(1, blocking.steps % 2 ? blocking.steps : blocking.steps - 1);
+                int_t i_overlap = block_steps * (i_minus + i_plus), j_overlap = block_steps * (j_minus + j_plus);
+
+                using data_t = std::remove_const_t<sid::element_type<Current>>;
+                using k_first_t = is_integral_constant_of<
+                    std::decay_t<decltype(sid::get_stride<dim::k>(sid::get_strides(current)))>,
+                    1>;
+                constexpr int row_dim = k_first_t::value ? 2 : 0;
+                int_t side = std::sqrt(blocking.cache_bytes / (2 * sizeof(data_t) * std::max(k_hi - k_lo, 1)));
+                int_t i_tile = std::min(blocking.i_size > 0 ? blocking.i_size : std::max(side - i_overlap, 8), i_size);
+                int_t j_tile = std::min(blocking.j_size > 0 ? blocking.j_size : std::max(side - j_overlap, 8), j_size);
+
+                auto split_be = core::split_backend(be);
+                using thread_pool_t = decltype(split_be.first);
+                auto const &tile_be = split_be.second;
+                int_t i_tiles = (i_size + i_tile - 1) / i_tile;
+                int_t j_tiles = (j_size + j_tile - 1) / j_tile;
+
+                // a pair of local copies per thread
+                auto alloc = sid::allocator(&std::make_unique<char[]>);
+                std::size_t buffer_size = std::size_t(i_tile + i_overlap) * (j_tile + j_overlap) * (k_hi - k_lo);
+                std::size_t num_threads = thread_pool::get_max_threads(thread_pool_t());
+                auto buffers0 = allocate(alloc, meta::lazy::id<data_t>(), buffer_size * num_threads);
+                auto buffers1 = allocate(alloc, meta::lazy::id<data_t>(), buffer_size * num_threads);
+
+                auto run_block = [&](int n, auto &src, auto &dst) {
+                    if (n == 1) {
+                        run(comp, be, grid, src, dst, rest...);
+                        return;
+                    }
+                    thread_pool::parallel_for_loop(
+                        thread_pool_t(),
+                        [&](auto i_tile_index, auto j_tile_index) {
+                            int_t i_lo = i_start + i_tile_index * i_tile;
+                            int_t j_lo = j_start + j_tile_index * j_tile;
+                            int_t i_hi = std::min(i_lo + i_tile, i_start + i_size);
+                            int_t j_hi = std::min(j_lo + j_tile, j_start + j_size);
+                            box tile = {{i_lo, j_lo, k_start}, {i_hi, j_hi, k_start + k_size}};
+                            box halo = {{std::max(i_lo - n * i_minus, i_start - i_minus),
+                                            std::max(j_lo - n * j_minus, j_start - j_minus),
+                                            k_lo},
+                                {std::min(i_hi + n * i_plus, i_start + i_size + i_plus),
+                                    std::min(j_hi + n * j_plus, j_start + j_size + j_plus),
+                                    k_hi}};
+                            std::ptrdiff_t offset = buffer_size * thread_pool::get_thread_num(thread_pool_t());
+                            auto tmp0 = make_buffer(k_first_t(), buffers0 + offset, halo);
+                            auto tmp1 = make_buffer(k_first_t(), buffers1 + offset, halo);
+                            // the next state is only read outside of the domain, where it is never written
+                            copy_box<row_dim>(tmp0, src, halo);
+                            copy_box<row_dim>(tmp1, dst, halo, domain);
+                            for (int step = 0; step != n; ++step) {
+                                int_t shrink = n - 1 - step;
+                                int_t i_from = std::max(i_lo - shrink * i_minus, i_start);
+                                int_t i_to = std::min(i_hi + shrink * i_plus, i_start + i_size);
+                                int_t j_from = std::max(j_lo - shrink * j_minus, j_start);
+                                int_t j_to = std::min(j_hi + shrink * j_plus, j_start + j_size);
+                                auto subgrid = grid.horizontal_subgrid(i_from, i_to - i_from, j_from, j_to - j_from);
+                                if (step % 2)
+                                    run(comp, tile_be, subgrid, tmp1, tmp0, rest...);
+                                else
+                                    run(comp, tile_be, subgrid, tmp0, tmp1, rest...);
+                            }
+                            // `n` is odd, thus the last state is in `tmp1`; the other tiles read `dst` only outside of
+                            // the domain, so it can be updated right away
+                            copy_box<row_dim>(dst, tmp1, tile);
+                        },
+                        i_tiles,
+                        j_tiles);
+                };
+
+                // All blocks have an odd number of steps, such that every block writes into the field that is not read
+                // by the block. The last step is done alone to leave the state before it in the other field.
+                bool swapped = false;
+                for (int done = 0; done < steps;) {
+                    int left = steps - done;
+                    int n = left == 1 ? 1 : std::min(block_steps, left - 1);
+                    n -= 1 - n % 2;
+                    if (swapped)
+                        run_block(n, next, current);
+                    else
+                        run_block(n, current, next);
+                    swapped = !swapped;
+                    done += n;
+                }
+            }
+
+            template <class Comp, class Backend, class Grid, class Current, class Next, class... Rest>
+            void run_timesteps(temporal_blocking const &blocking,
+                int steps,
+                Comp comp,
+                Backend &&be,
+                Grid const &grid,
+                Current &&current,
+                Next &&next,
+                Rest &&...rest) {
+                static_assert(std::conjunction<is_sid<Current>, is_sid<Next>, is_sid<Rest>...>::value,
+                    "All computation fields must satisfy SID concept.");
+                static_assert(std::is_same_v<sid::element_type<Current>, sid::element_type<Next>>,
+                    "The current and the next state should have the same type.");
+                run_timesteps_impl(blocking,
+                    steps,
+                    comp,
+                    std::forward<Backend>(be),
+                    grid,
+                    std::index_sequence_for<Rest...>(),
+                    current,
+                    next,
+                    rest...);
+            }
+
+            template <class Comp, class Backend, class Grid, class... Fields>
+            void run_timesteps(int steps, Comp comp, Backend &&be, Grid const &grid, Fields &&...fields) {
+                run_timesteps(
+                    temporal_blocking(), steps, comp, std::forward<Backend>(be), grid, std::forward<Fields>(fields)...);
+            }
+        } // namespace run_timesteps_impl_
+        using run_timesteps_impl_::run_timesteps;
+        using run_timesteps_impl_::temporal_blocking;
+    } // namespace stencil
+} // namespace gridtools
@@ -24,6 +24,7 @@
 #include "../sid/contiguous.hpp"
 #include "../sid/loop.hpp"
 #include "../sid/sid_shift_origin.hpp"
+#include "../sid/synthetic.hpp"
 #include "be_api.hpp"
 #include "common/dim.hpp"
 
@@ -35,20 +36,28 @@ namespace gridtools {
                 auto alloc = sid::host_device::allocator(&std::make_unique<char[]>);
                 using stages_t = be_api::make_split_view<Spec>;
                 using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
-                auto temporaries = be_api::make_data_stores(tmp_plh_map_t(), [&](auto info) {
-                    auto extent = info.extent();
-                    auto interval = stages_t::interval();
-                    auto num_colors = info.num_colors();
-                    auto offsets = hymap::keys<dim::i, dim::j, dim::k>::make_values(-extent.minus(dim::i()),
-                        -extent.minus(dim::j()),
-                        -grid.k_start(interval) - extent.minus(dim::k()));
-                    auto sizes = hymap::keys<dim::c, dim::k, dim::j, dim::i>::make_values(
-                        num_colors, grid.k_size(interval, extent), grid.j_size(extent), grid.i_size(extent));
-                    using stride_kind = meta::list<decltype(extent), decltype(num_colors)>;
-                    return sid::shift_sid_origin(
-                        sid::make_contiguous<decltype(info.data()), ptrdiff_t, stride_kind>(alloc, sizes), offsets);
-                });
-                auto data_stores = hymap::concat(external_data_stores, temporaries);
+                // the stages are executed point by point, a temporary that is computed on the fly needs one element
+                auto inlined_temporaries =
+                    be_api::make_data_stores(be_api::inlined_tmp_plh_map<stages_t, tmp_plh_map_t>(), [&](auto info) {
+                        return sid::synthetic().set<sid::property::origin>(
+                            allocate(alloc, meta::lazy::id<decltype(info.data())>(), 1));
+                    });
+                using buffered_tmp_plh_map_t = be_api::buffered_tmp_plh_map<stages_t, tmp_plh_map_t>;
+                auto temporaries =
+                    be_api::make_aliased_data_stores(stages_t(), buffered_tmp_plh_map_t(), [&](auto info) {
+                        auto extent = info.extent();
+                        auto interval = stages_t::interval();
+                        auto num_colors = info.num_colors();
+                        auto offsets = hymap::keys<dim::i, dim::j, dim::k>::make_values(-extent.minus(dim::i()),
+                            -extent.minus(dim::j()),
+                            -grid.k_start(interval) - extent.minus(dim::k()));
+                        auto sizes = hymap::keys<dim::c, dim::k, dim::j, dim::i>::make_values(
+                            num_colors, grid.k_size(interval, extent), grid.j_size(extent), grid.i_size(extent));
+                        using stride_kind = meta::list<decltype(extent), decltype(num_colors)>;
+                        return sid::shift_sid_origin(
+                            sid::make_contiguous<decltype(info.data()), ptrdiff_t, stride_kind>(alloc, sizes), offsets);
+                    });
+                auto data_stores = hymap::concat(external_data_stores, temporaries, inlined_temporaries);
                 using plh_map_t = typename stages_t::plh_map_t;
                 using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
                 auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
@@ -0,0 +1,148 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/defs.hpp"
+#include "../common/hymap.hpp"
+#include "../common/integral_constant.hpp"
+#include "../reduction/functions.hpp"
+#include "../thread_pool/concept.hpp"
+#include "../thread_pool/dummy.hpp"
+#include "../thread_pool/omp.hpp"
+#include "common/dim.hpp"
+
+/**
+ *   @file
+ *
+ *   Reduction of the values that a stencil computes, fused into the stencil execution.
+ *
+ *       reduction_output norm(0., reduction::plus());
+ *       run(comp, backend, grid, in, norm);
+ *       double res = norm.result();
+ *
+ *   Every assignment to the inout accessor that is bound to `norm` combines the assigned value into the result with
+ *   the functor (see reduction/functions.hpp) instead of storing it, so the reduced field doesn't need to be stored
+ *   and read again by a separate reduction pass.
+ *
+ *   The values are accumulated into one partial result per thread: the partials are strided along `dim::thread`,
+ *   which the cpu backends shift to the executing thread, and padded to a cache line. `result()` combines the
+ *   partials. The partials are kept between runs, `reset()` sets them back to the neutral value.
+ *
+ *   The stage that writes to a reduction output should have an empty horizontal extent (i.e. its other outputs are
+ *   not read with horizontal offsets by the following stages), otherwise the points outside of the compute domain
+ *   would be accumulated as well; this is checked at compile time.
+ *
+ *   The execution order of the points is not specified, thus the functor should be associative and commutative.
+ *   Reduction outputs are supported by the naive and the cpu backends. The partials are allocated for the threads of
+ *   OpenMP by default, backends with another thread pool need that pool passed to the constructor. With `run_batch`,
+ *   every member needs its own reduction output.
+ */
+
+namespace gridtools {
+    namespace stencil {
+        namespace reduction_output_impl_ {
+            template <class F, class T>
+            struct reference {
+                T *m_ptr;
+
+                reference const &operator=(T const &value) const {
+                    *m_ptr = F()(*m_ptr, value);
+                    return *this;
+                }
+            };
+
+            template <class F, class T>
+            struct ptr {
+                T *m_ptr;
+
+                reference<F, T> operator*() const { return {m_ptr}; }
+                ptr operator()() const { return *this; }
+
+                ptr &operator+=(std::ptrdiff_t diff) {
+                    m_ptr += diff;
+                    return *this;
+                }
+                friend ptr operator+(ptr obj, std::ptrdiff_t diff) { return obj += diff; }
+            };
+
+            template <class T>
+            struct is_reduction_ptr : std::false_type {};
+
+            template <class F, class T>
+            struct is_reduction_ptr<ptr<F, T>> : std::true_type {};
+
+            template <class T>
+            struct strides_kind {};
+
+            using default_thread_pool =
+#if defined(_OPENMP) || defined(GT_HIP_OPENMP_WORKAROUND)
+                thread_pool::omp;
+#else
+                thread_pool::dummy;
+#endif
+
+            template <class T, class F = reduction::plus>
+            class reduction_output {
+                static_assert(std::is_arithmetic_v<T>, "reduction output should be of arithmetic type");
+                static_assert(std::is_empty_v<F> && std::is_default_constructible_v<F>,
+                    "reduction output supports only stateless functors");
+
+                // one cache line per partial result
+                using stride_t = integral_constant<int_t, (64 + sizeof(T) - 1) / sizeof(T)>;
+
+                T m_neutral_value;
+                std::shared_ptr<std::vector<T>> m_partials;
+
+              public:
+                template <class ThreadPool = default_thread_pool>
+                reduction_output(T neutral_value, F = {}, ThreadPool thread_pool = {})
+                    : m_neutral_value(neutral_value),
+                      m_partials(std::make_shared<std::vector<T>>(
+                          stride_t::value * thread_pool::get_max_threads(thread_pool), neutral_value)) {}
+
+                /**
+                 *  Combines the partial results of the threads.
+                 */
+                T result() const {
+                    T res = m_neutral_value;
+                    for (std::size_t i = 0; i < m_partials->size(); i += stride_t::value)
+                        res = F()(res, (*m_partials)[i]);
+                    return res;
+                }
+
+                void reset() { std::fill(m_partials->begin(), m_partials->end(), m_neutral_value); }
+
+                friend ptr<F, T> sid_get_origin(reduction_output &obj) { return {obj.m_partials->data()}; }
+                friend std::ptrdiff_t sid_get_ptr_diff(reduction_output const &) { return {}; }
+                friend strides_kind<T> sid_get_strides_kind(reduction_output const &) { return {}; }
+                friend hymap::keys<dim::thread>::values<stride_t> sid_get_strides(reduction_output const &) {
+                    return {};
+                }
+                friend hymap::keys<dim::thread>::values<integral_constant<int_t, 0>> sid_get_lower_bounds(
+                    reduction_output const &) {
+                    return {};
+                }
+                friend hymap::keys<dim::thread>::values<int_t> sid_get_upper_bounds(reduction_output const &obj) {
+                    return {int_t(obj.m_partials->size() / stride_t::value)};
+                }
+            };
+        } // namespace reduction_output_impl_
+
+        using reduction_output_impl_::is_reduction_ptr;
+        using reduction_output_impl_::reduction_output;
+    } // namespace stencil
+} // namespace gridtools
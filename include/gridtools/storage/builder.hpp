@@ -22,6 +22,7 @@
 #include "../meta.hpp"
 #include "../sid/unknown_kind.hpp"
 #include "data_store.hpp"
+#include "first_touch.hpp"
 #include "traits.hpp"
 
 namespace gridtools {
@@ -35,6 +36,7 @@ namespace gridtools {
                 struct halos {};
                 struct initializer {};
                 struct layout {};
+                struct ensemble {};
             } // namespace param
 
             template <class T>
@@ -64,8 +66,17 @@ namespace gridtools {
                 return res;
             }
 
-            template <class Fun, class T, class Layout, class Info, size_t... Is>
-            void initializer_impl(Fun const &fun, T *dst, Layout layout, Info const &info, std::index_sequence<Is...>) {
+            template <class Fun, class T, class Layout, class Info, class Halos, size_t... Is>
+            void initializer_impl(Fun const &fun,
+                T *dst,
+                Layout layout,
+                Info const &info,
+                Halos const &halos,
+                std::index_sequence<Is...>) {
+                if (first_touch_blocked(layout, info, halos, [&](auto const &indices) {
+                        dst[info.index(indices[Is]...)] = fun(indices[Is]...);
+                    }))
+                    return;
                 int length = info.length();
                 auto in_range = [&](auto const &indices) {
                     for (auto ok : {(tuple_util::get<Is>(indices) < tuple_util::get<Is>(info.native_lengths()))...})
@@ -85,15 +96,23 @@ namespace gridtools {
 
             template <class Fun>
             auto wrap_initializer(Fun fun) {
-                return [fun = std::move(fun)](auto *dst, auto layout, auto const &info) {
-                    initializer_impl(
-                        fun, dst, layout, info, std::make_index_sequence<std::decay_t<decltype(info)>::ndims>());
+                return [fun = std::move(fun)](auto *dst, auto layout, auto const &info, auto const &halos) {
+                    initializer_impl(fun,
+                        dst,
+                        layout,
+                        info,
+                        halos,
+                        std::make_index_sequence<std::decay_t<decltype(info)>::ndims>());
                 };
             }
 
             template <class T>
             auto wrap_value(T const &value) {
-                return [value = std::move(value)](auto *dst, auto, auto const &info) {
+                return [value = std::move(value)](auto *dst, auto layout, auto const &info, auto const &halos) {
+                    if (first_touch_blocked(layout, info, halos, [&](auto const &indices) {
+                            dst[info.index_from_tuple(indices)] = value;
+                        }))
+                        return;
                     int length = info.length();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -288,6 +307,19 @@ namespace gridtools {
                     return add_value<param::halos>(array<int, sizeof...(Args)>{static_cast<int>(values)...});
                 }
 
+                /**
+                 *  Adds an ensemble dimension of `members` elements after the dimensions given to `dimensions(...)`.
+                 *  It is the innermost dimension in memory whatever the layout of the other dimensions is, and it
+                 *  has no halo. The initializer gets the index of the member as its last argument.
+                 */
+                template <class Arg>
+                auto ensemble(Arg const &members) const {
+                    static_assert(!has<param::ensemble>::value, "storage ensemble is set twice");
+                    static_assert(std::is_convertible<Arg const &, uint_t>::value,
+                        "builder.ensemble(...) argument should be convertible to unsigned int");
+                    return add_value<param::ensemble>(normalize_dimension(members, is_integral_constant<Arg>()));
+                }
+
                 template <class Fun>
                 auto initializer(Fun fun) const {
                     static_assert(!has<param::initializer>::value, "storage initializer/value is set twice");
@@ -310,8 +342,22 @@ namespace gridtools {
                     constexpr auto n = tuple_util::size<decltype(lengths)>::value;
                     auto &&halos = value<param::halos, array<int, n>>();
                     auto initializer = value<param::initializer, uninitialized>();
-                    return make_data_store<traits_t, typename value_type<param::type>::type, value_type<param::id>>(
-                        name, lengths, halos, initializer);
+                    if constexpr (has<param::ensemble>::value) {
+                        using ensemble_traits_t =
+                            custom_traits<Traits, append_innermost<traits::layout_type<traits_t, n>>>;
+                        array<int, n + 1> ensemble_halos = {};
+                        for (size_t i = 0; i != n; ++i)
+                            ensemble_halos[i] = halos[i];
+                        return make_data_store<ensemble_traits_t,
+                            typename value_type<param::type>::type,
+                            value_type<param::id>>(name,
+                            tuple_util::deep_copy(tuple_util::push_back(lengths, value<param::ensemble>())),
+                            ensemble_halos,
+                            initializer);
+                    } else {
+                        return make_data_store<traits_t, typename value_type<param::type>::type, value_type<param::id>>(
+                            name, lengths, halos, initializer);
+                    }
                 }
 
                 auto operator()() const { return build(); }
@@ -112,7 +112,7 @@ namespace gridtools {
                 data_store(std::string name, Info info, Halos const &halos, Initializer const &initializer)
                     : data_store::base(std::move(name), std::move(info), halos), m_state(invalid_target),
                       m_host_ptr(std::make_unique<T[]>(this->info().length())) {
-                    initializer(m_host_ptr.get(), typename data_store::layout_t(), this->info());
+                    initializer(m_host_ptr.get(), typename data_store::layout_t(), this->info(), halos);
                 }
 
                 T *get_target_ptr() {
@@ -156,7 +156,7 @@ namespace gridtools {
                 template <class Initializer, class Halos>
                 data_store(std::string name, Info info, Halos const &halos, Initializer const &initializer)
                     : data_store::base(std::move(name), std::move(info), halos) {
-                    initializer(this->raw_target_ptr(), typename data_store::layout_t(), this->info());
+                    initializer(this->raw_target_ptr(), typename data_store::layout_t(), this->info(), halos);
                 }
 
                 T *get_target_ptr() const { return this->raw_target_ptr(); }
@@ -185,7 +185,7 @@ namespace gridtools {
                 data_store(std::string name, Info info, Halos const &halos, Initializer const &initializer)
                     : data_store::base(std::move(name), std::move(info), halos),
                       m_host_ptr(std::make_unique<T[]>(this->info().length())) {
-                    initializer(m_host_ptr.get(), typename data_store::layout_t(), this->info());
+                    initializer(m_host_ptr.get(), typename data_store::layout_t(), this->info(), halos);
                     traits::update_target<Traits>(this->raw_target_ptr(), m_host_ptr.get(), this->info().length());
                 }
 
@@ -209,7 +209,7 @@ namespace gridtools {
                 template <class Initializer, class Halos>
                 data_store(std::string name, Info info, Halos const &halos, Initializer const &initializer)
                     : base<Traits, T const, Info, Kind>(std::move(name), std::move(info), halos) {
-                    initializer(this->raw_target_ptr(), typename data_store::layout_t(), this->info());
+                    initializer(this->raw_target_ptr(), typename data_store::layout_t(), this->info(), halos);
                 }
                 T const *get_target_ptr() const { return this->raw_target_ptr(); }
                 T const *get_const_target_ptr() const { return get_target_ptr(); }
@@ -0,0 +1,163 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include "../common/array.hpp"
+#include "../common/defs.hpp"
+#include "../common/layout_map.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ *   @file
+ *
+ *   NUMA-aware first touch of initialized data stores.
+ *
+ *   Memory pages are placed on the NUMA node of the thread that first writes to them. By default, initializers
+ *   write the storage in parallel along its linear index. If the environment variable `GT_FIRST_TOUCH` is set to
+ *   `blocked`, they write it instead block by block, using the same i/j-block decomposition and block-to-thread
+ *   mapping as the default decomposition of the cpu_ifirst backend (see `cpu_ifirst_backend::execinfo`) with the
+ *   OpenMP thread pool. The halo points are written together with the adjacent boundary blocks. Each thread then
+ *   finds the blocks it computes on in memory of its own NUMA node.
+ */
+
+namespace gridtools {
+    namespace storage {
+        namespace first_touch_impl_ {
+            enum class first_touch_mode { linear, blocked };
+
+            inline first_touch_mode first_touch_mode_from_env() {
+                static const first_touch_mode value = [] {
+                    const char *env_value = std::getenv("GT_FIRST_TOUCH");
+                    if (!env_value || std::strcmp(env_value, "linear") == 0)
+                        return first_touch_mode::linear;
+                    if (std::strcmp(env_value, "blocked") == 0)
+                        return first_touch_mode::blocked;
+                    std::fprintf(stderr, "warning: env variable GT_FIRST_TOUCH set to invalid value '%s'\n", env_value);
+                    return first_touch_mode::linear;
+                }();
+                return value;
+            }
+
+            /**
+             *  Blocked first touch is only meaningful if the storage extends along i and j.
+             */
+            template <class Layout>
+            constexpr bool is_blockable(Layout) {
+                return Layout::masked_length >= 2 && Layout::at(0) != -1 && Layout::at(1) != -1;
+            }
+
+            /**
+             *  Calls `fun(indices)` for every point of the storage, the points of an (i, j)-block are visited by the
+             *  thread that processes this block in cpu_ifirst.
+             */
+            template <class Layout, class Info, class Halos, class Fun>
+            void blocked_for_each(Layout, Info const &info, Halos const &halos, Fun const &fun) {
+                static constexpr int ndims = Info::ndims;
+                static_assert(is_blockable(Layout()), GT_INTERNAL_ERROR);
+
+                auto lengths = info.lengths();
+                int i_length = lengths[0], j_length = lengths[1];
+                int i_halo = std::min<int>(halos[0], i_length / 2), j_halo = std::min<int>(halos[1], j_length / 2);
+                int rest = 1;
+                for (int d = 2; d < ndims; ++d)
+                    rest *= Layout::at(d) == -1 ? 1 : lengths[d];
+                if (i_length == 0 || j_length == 0 || rest == 0)
+                    return;
+
+#ifdef _OPENMP
+                int threads = omp_get_max_threads();
+#else
+                int threads = 1;
+#endif
+                // same as cpu_ifirst_backend::execinfo(thread_pool::omp(), grid) for the compute domain
+                int i_size = std::max(i_length - 2 * i_halo, 1), j_size = std::max(j_length - 2 * j_halo, 1);
+                int j_block_size = (j_size + threads - 1) / threads;
+                int j_blocks = (j_size + j_block_size - 1) / j_block_size;
+                int max_i_blocks = threads / j_blocks;
+                int i_block_size = (i_size + max_i_blocks - 1) / max_i_blocks;
+                int i_blocks = (i_size + i_block_size - 1) / i_block_size;
+
+                auto range_begin = [](int block, int block_size, int halo) {
+                    return block == 0 ? 0 : halo + block * block_size;
+                };
+                auto range_end = [](int block, int block_size, int blocks, int halo, int length) {
+                    return block == blocks - 1 ? length : halo + (block + 1) * block_size;
+                };
+
+                // same loop structure as `thread_pool::omp` uses for 2D loops, thus the same schedule
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2)
+#endif
+                for (int j_block = 0; j_block < j_blocks; ++j_block)
+                    for (int i_block = 0; i_block < i_blocks; ++i_block) {
+                        int i_begin = range_begin(i_block, i_block_size, i_halo);
+                        int i_end = range_end(i_block, i_block_size, i_blocks, i_halo, i_length);
+                        int j_begin = range_begin(j_block, j_block_size, j_halo);
+                        int j_end = range_end(j_block, j_block_size, j_blocks, j_halo, j_length);
+                        array<int, ndims> indices;
+                        for (int j = j_begin; j < j_end; ++j) {
+                            indices[1] = j;
+                            for (int r = 0; r < rest; ++r) {
+                                int index = r;
+                                for (int d = ndims - 1; d >= 2; --d) {
+                                    if (Layout::at(d) == -1) {
+                                        indices[d] = lengths[d] - 1;
+                                    } else {
+                                        indices[d] = index % lengths[d];
+                                        index /= lengths[d];
+                                    }
+                                }
+                                for (int i = i_begin; i < i_end; ++i) {
+                                    indices[0] = i;
+                                    fun(indices);
+                                }
+                            }
+                        }
+                    }
+            }
+
+            template <class Layout,
+                class Info,
+                class Halos,
+                class Fun,
+                std::enable_if_t<!is_blockable(Layout()), int> = 0>
+            bool first_touch_blocked(Layout, Info const &, Halos const &, Fun const &) {
+                return false;
+            }
+
+            /**
+             *  Runs `blocked_for_each` and returns true if blocked first touch is enabled and applicable.
+             */
+            template <class Layout,
+                class Info,
+                class Halos,
+                class Fun,
+                std::enable_if_t<is_blockable(Layout()), int> = 0>
+            bool first_touch_blocked(Layout layout, Info const &info, Halos const &halos, Fun const &fun) {
+                if (first_touch_mode_from_env() != first_touch_mode::blocked)
+                    return false;
+                blocked_for_each(layout, info, halos, fun);
+                return true;
+            }
+        } // namespace first_touch_impl_
+
+        using first_touch_impl_::blocked_for_each;
+        using first_touch_impl_::first_touch_blocked;
+    } // namespace storage
+} // namespace gridtools
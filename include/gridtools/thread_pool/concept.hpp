@@ -25,6 +25,14 @@
  *     thread_pool_parallel_for_loop(pool, func, lim0, lim1, lim2);
  *     etc.
  *   They are optional and could be provided for performance reasons.
+ *
+ *   The scheduling policy of the loop iterations is a property of the thread pool type. Available are:
+ *     omp                - OpenMP, static schedule (thread_pool/omp.hpp)
+ *     omp_dynamic<Chunk> - OpenMP, dynamic schedule with the given chunk size (thread_pool/omp.hpp)
+ *     work_stealing      - native persistent threads with work stealing (thread_pool/work_stealing.hpp)
+ *     native             - native persistent pinned threads, static schedule (thread_pool/native.hpp)
+ *   Backends that are parametrized on the thread pool (cpu_kfirst, cpu_ifirst, fn naive) thus select the policy by
+ *   their thread pool template argument.
  */
 
 #include <tuple>
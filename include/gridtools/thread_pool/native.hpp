@@ -0,0 +1,248 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../common/integral_constant.hpp"
+#include "persistent.hpp"
+
+/**
+ *   @file
+ *
+ *   Native persistent thread pool without OpenMP dependency.
+ *
+ *   The workers are `std::thread`s that are started once and live until the end of the program, the calling thread
+ *   takes part in every loop as thread 0. Loops are scheduled statically: the (flattened) iteration space is split
+ *   into one contiguous range per thread, such that every thread touches the same data in every call.
+ *
+ *   Between loops the workers spin on the loop generation counter for a while before they go to sleep, the end of a
+ *   loop is detected by the calling thread by spinning on a counter. Short back-to-back loops therefore don't pay for
+ *   the wake-up of sleeping threads.
+ *
+ *   Configuration by environment variables:
+ *     GT_NUM_THREADS      - number of threads, the default is the number of CPUs the process may run on
+ *     GT_THREAD_PINNING   - if set to 0, the workers are not pinned; by default worker `n` is pinned to the `n`-th
+ *                           CPU of the affinity mask of the process (Linux only). The calling thread is left alone,
+ *                           CPU 0 of the mask is thus free for it.
+ *     GT_THREAD_SPIN      - number of spin iterations before a waiting worker goes to sleep, default 100000
+ *
+ *   See persistent.hpp for nested and concurrent loops.
+ */
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace native_impl_ {
+            inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#elif defined(__aarch64__)
+                asm volatile("yield");
+#endif
+            }
+
+            using persistent_impl_::allowed_cpus;
+            using persistent_impl_::env_value;
+            using persistent_impl_::pin_to;
+            using persistent_impl_::thread_index;
+
+            class pool {
+                using fun_t = void (*)(void const *, std::uint64_t, std::uint64_t);
+
+                int m_num_threads;
+                long m_spin;
+                std::vector<int> m_cpus;
+                std::vector<std::thread> m_workers;
+
+                alignas(64) std::atomic<std::uint64_t> m_generation{0};
+                alignas(64) std::atomic<int> m_pending{0};
+                alignas(64) std::atomic<int> m_sleeping{0};
+                bool m_stop = false;
+                std::mutex m_mutex;
+                std::condition_variable m_cv;
+                std::mutex m_loop_mutex;
+
+                fun_t m_fun = nullptr;
+                void const *m_ctx = nullptr;
+                std::uint64_t m_size = 0;
+
+                void work(int index) {
+                    std::uint64_t begin = m_size * index / m_num_threads;
+                    std::uint64_t end = m_size * (index + 1) / m_num_threads;
+                    if (begin != end)
+                        m_fun(m_ctx, begin, end);
+                }
+
+                // spin-then-sleep wait for the next loop
+                bool wait(std::uint64_t generation) {
+                    for (long n = 0; n < m_spin; ++n) {
+                        if (m_generation.load(std::memory_order_acquire) != generation)
+                            return true;
+                        cpu_relax();
+                    }
+                    m_sleeping.fetch_add(1);
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock, [&] { return m_stop || m_generation.load() != generation; });
+                    m_sleeping.fetch_sub(1);
+                    return !m_stop;
+                }
+
+                void worker(int index) {
+                    persistent_impl_::init_worker(index);
+                    if (!m_cpus.empty())
+                        pin_to(m_cpus[index % m_cpus.size()]);
+                    std::uint64_t generation = 0;
+                    while (wait(generation)) {
+                        generation = m_generation.load(std::memory_order_acquire);
+                        work(index);
+                        m_pending.fetch_sub(1, std::memory_order_release);
+                    }
+                }
+
+              public:
+                pool(int num_threads, bool pinning, long spin) : m_num_threads(num_threads), m_spin(spin) {
+                    if (pinning)
+                        m_cpus = allowed_cpus();
+                    for (int i = 1; i < num_threads; ++i)
+                        m_workers.emplace_back([this, i] { worker(i); });
+                }
+
+                pool(pool const &) = delete;
+                pool &operator=(pool const &) = delete;
+
+                ~pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stop = true;
+                    }
+                    m_cv.notify_all();
+                    for (auto &worker : m_workers)
+                        worker.join();
+                }
+
+                int num_threads() const { return m_num_threads; }
+
+                /**
+                 *  Calls `f(begin, end)` for a partition of [0, size) into one range per thread.
+                 */
+                template <class F>
+                void parallel_for(F const &f, std::uint64_t size) {
+                    if (persistent_impl_::in_loop()) {
+                        // nested loop
+                        if (size)
+                            f(std::uint64_t(0), size);
+                        return;
+                    }
+                    std::lock_guard<std::mutex> loop_lock(m_loop_mutex);
+                    persistent_impl_::caller_scope scope;
+                    if (m_num_threads == 1 || size <= 1) {
+                        if (size)
+                            f(std::uint64_t(0), size);
+                        return;
+                    }
+                    m_fun = [](void const *ctx, std::uint64_t begin, std::uint64_t end) {
+                        (*static_cast<F const *>(ctx))(begin, end);
+                    };
+                    m_ctx = &f;
+                    m_size = size;
+                    m_pending.store(m_num_threads - 1, std::memory_order_relaxed);
+                    m_generation.fetch_add(1);
+                    if (m_sleeping.load()) {
+                        // taking the lock guarantees that a worker is either waiting or will see the new generation
+                        { std::lock_guard<std::mutex> lock(m_mutex); }
+                        m_cv.notify_all();
+                    }
+                    work(0);
+                    for (long n = 0; m_pending.load(std::memory_order_acquire); ++n)
+                        if (n < m_spin)
+                            cpu_relax();
+                        else
+                            std::this_thread::yield();
+                }
+            };
+
+            inline pool &get_pool() {
+                static pool instance(persistent_impl_::num_threads_from_env(),
+                    env_value("GT_THREAD_PINNING", 1) != 0,
+                    std::max(0l, env_value("GT_THREAD_SPIN", 100000)));
+                return instance;
+            }
+        } // namespace native_impl_
+
+        struct native {
+            friend int thread_pool_get_thread_num(native) { return native_impl_::thread_index(); }
+            friend int thread_pool_get_max_threads(native) { return native_impl_::get_pool().num_threads(); }
+
+            template <class F, class I, class I_t = to_integral_type_t<I>>
+            friend void thread_pool_parallel_for_loop(native, F const &f, I lim) {
+                native_impl_::get_pool().parallel_for(
+                    [&f](std::uint64_t begin, std::uint64_t end) {
+                        for (I_t i = begin; i < (I_t)end; ++i)
+                            f(i);
+                    },
+                    lim);
+            }
+
+            template <class F, class I, class J, class I_t = to_integral_type_t<I>, class J_t = to_integral_type_t<J>>
+            friend void thread_pool_parallel_for_loop(native, F const &f, I i_lim, J j_lim) {
+                I_t i_size = i_lim;
+                native_impl_::get_pool().parallel_for(
+                    [&f, i_size](std::uint64_t begin, std::uint64_t end) {
+                        I_t i = begin % i_size;
+                        J_t j = begin / i_size;
+                        for (auto n = begin; n != end; ++n) {
+                            f(i, j);
+                            if (++i == i_size) {
+                                i = 0;
+                                ++j;
+                            }
+                        }
+                    },
+                    std::uint64_t(i_lim) * j_lim);
+            }
+
+            template <class F,
+                class I,
+                class J,
+                class K,
+                class I_t = to_integral_type_t<I>,
+                class J_t = to_integral_type_t<J>,
+                class K_t = to_integral_type_t<K>>
+            friend void thread_pool_parallel_for_loop(native, F const &f, I i_lim, J j_lim, K k_lim) {
+                I_t i_size = i_lim;
+                J_t j_size = j_lim;
+                native_impl_::get_pool().parallel_for(
+                    [&f, i_size, j_size](std::uint64_t begin, std::uint64_t end) {
+                        I_t i = begin % i_size;
+                        J_t j = begin / i_size % j_size;
+                        K_t k = begin / i_size / j_size;
+                        for (auto n = begin; n != end; ++n) {
+                            f(i, j, k);
+                            if (++i == i_size) {
+                                i = 0;
+                                if (++j == j_size) {
+                                    j = 0;
+                                    ++k;
+                                }
+                            }
+                        }
+                    },
+                    std::uint64_t(i_lim) * j_lim * k_lim);
+            }
+        };
+    } // namespace thread_pool
+} // namespace gridtools
@@ -53,6 +53,48 @@ namespace gridtools {
                         for (I_t i = 0; i < i_lim; ++i)
                             f(i, j, k);
             }
+#endif
+        };
+
+        /**
+         *  Same as `omp` but with the dynamic schedule: iterations are handed out in chunks of `Chunk` to the threads
+         *  as they become idle.
+         */
+        template <int Chunk = 1>
+        struct omp_dynamic {
+#if defined(_OPENMP) || defined(GT_HIP_OPENMP_WORKAROUND)
+            friend auto thread_pool_get_thread_num(omp_dynamic) { return omp_get_thread_num(); }
+            friend auto thread_pool_get_max_threads(omp_dynamic) { return omp_get_max_threads(); }
+
+            template <class F, class I, class I_t = to_integral_type_t<I>>
+            friend void thread_pool_parallel_for_loop(omp_dynamic, F const &f, I lim) {
+#pragma omp parallel for schedule(dynamic, Chunk)
+                for (I_t i = 0; i < lim; ++i)
+                    f(i);
+            }
+
+            template <class F, class I, class J, class I_t = to_integral_type_t<I>, class J_t = to_integral_type_t<J>>
+            friend void thread_pool_parallel_for_loop(omp_dynamic, F const &f, I i_lim, J j_lim) {
+#pragma omp parallel for collapse(2) schedule(dynamic, Chunk)
+                for (J_t j = 0; j < j_lim; ++j)
+                    for (I_t i = 0; i < i_lim; ++i)
+                        f(i, j);
+            }
+
+            template <class F,
+                class I,
+                class J,
+                class K,
+                class I_t = to_integral_type_t<I>,
+                class J_t = to_integral_type_t<J>,
+                class K_t = to_integral_type_t<K>>
+            friend void thread_pool_parallel_for_loop(omp_dynamic, F const &f, I i_lim, J j_lim, K k_lim) {
+#pragma omp parallel for collapse(3) schedule(dynamic, Chunk)
+                for (K_t k = 0; k < k_lim; ++k)
+                    for (J_t j = 0; j < j_lim; ++j)
+                        for (I_t i = 0; i < i_lim; ++i)
+                            f(i, j, k);
+            }
 #endif
         };
     } // namespace thread_pool
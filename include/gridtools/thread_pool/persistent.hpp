@@ -0,0 +1,112 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ *   @file
+ *
+ *   Common parts of the thread pools with persistent native threads (native.hpp, work_stealing.hpp).
+ *
+ *   The calling thread of a loop takes part in it as thread 0, the workers have the indices 1, 2, ... Nested loops
+ *   (called from within a loop of the pool) are executed serially by the calling thread, which keeps its index.
+ *   Concurrent loops from different threads are serialized, thus the indices of the threads that run at the same time
+ *   are always distinct and can be used to address per-thread resources like temporaries.
+ */
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace persistent_impl_ {
+            inline int &thread_index() {
+                static thread_local int res = 0;
+                return res;
+            }
+
+            // true for the workers and for the calling thread of a loop while the loop runs
+            inline bool &in_loop() {
+                static thread_local bool res = false;
+                return res;
+            }
+
+            /**
+             *  Makes the calling thread thread 0 of a loop, restores its previous state on destruction.
+             */
+            class caller_scope {
+                int m_index;
+
+              public:
+                caller_scope() : m_index(thread_index()) {
+                    thread_index() = 0;
+                    in_loop() = true;
+                }
+                caller_scope(caller_scope const &) = delete;
+                caller_scope &operator=(caller_scope const &) = delete;
+                ~caller_scope() {
+                    thread_index() = m_index;
+                    in_loop() = false;
+                }
+            };
+
+            inline void init_worker(int index) {
+                thread_index() = index;
+                in_loop() = true;
+            }
+
+            inline long env_value(char const *name, long default_value) {
+                char const *value = std::getenv(name);
+                return value && *value ? std::atol(value) : default_value;
+            }
+
+            inline std::vector<int> allowed_cpus() {
+                std::vector<int> res;
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                        if (CPU_ISSET(cpu, &set))
+                            res.push_back(cpu);
+#endif
+                return res;
+            }
+
+            inline void pin_to(int cpu) {
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+            }
+
+            /**
+             *  The number of threads from the environment variable `GT_NUM_THREADS`, the default is the number of
+             *  CPUs the process may run on.
+             */
+            inline int num_threads_from_env() {
+                auto cpus = allowed_cpus();
+                int default_threads =
+                    cpus.empty() ? std::max(1, (int)std::thread::hardware_concurrency()) : (int)cpus.size();
+                long res = env_value("GT_NUM_THREADS", default_threads);
+                return res > 0 ? res : default_threads;
+            }
+        } // namespace persistent_impl_
+    }     // namespace thread_pool
+} // namespace gridtools
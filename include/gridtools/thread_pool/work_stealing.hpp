@@ -0,0 +1,200 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../common/integral_constant.hpp"
+#include "persistent.hpp"
+
+/**
+ *   @file
+ *
+ *   Native work-stealing thread pool.
+ *
+ *   The workers are persistent `std::thread`s, the calling thread takes part in the loop as thread 0. The iteration
+ *   space of a parallel loop is split into one contiguous range per thread (like a static schedule, to keep the
+ *   mapping of iterations to threads stable between calls). Each thread takes iterations from the front of its own
+ *   range; once it is exhausted, it steals iterations from the back of the ranges of the other threads.
+ *
+ *   The number of threads is taken from the environment variable `GT_NUM_THREADS`, the default is the number of
+ *   CPUs the process may run on. See persistent.hpp for nested and concurrent loops.
+ */
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace work_stealing_impl_ {
+            using persistent_impl_::thread_index;
+
+            /**
+             *  Half-open range of iterations, packed into a single atomic word such that the owner (front) and the
+             *  thieves (back) can take iterations with a single CAS.
+             */
+            struct alignas(64) range {
+                std::atomic<std::uint64_t> m_value;
+
+                static std::uint64_t pack(std::uint32_t begin, std::uint32_t end) {
+                    return std::uint64_t(end) << 32 | begin;
+                }
+
+                void set(std::uint32_t begin, std::uint32_t end) {
+                    m_value.store(pack(begin, end), std::memory_order_relaxed);
+                }
+
+                bool pop_front(std::uint32_t &res) {
+                    auto value = m_value.load(std::memory_order_relaxed);
+                    while (true) {
+                        std::uint32_t begin = value, end = value >> 32;
+                        if (begin >= end)
+                            return false;
+                        if (m_value.compare_exchange_weak(value, pack(begin + 1, end), std::memory_order_relaxed)) {
+                            res = begin;
+                            return true;
+                        }
+                    }
+                }
+
+                bool pop_back(std::uint32_t &res) {
+                    auto value = m_value.load(std::memory_order_relaxed);
+                    while (true) {
+                        std::uint32_t begin = value, end = value >> 32;
+                        if (begin >= end)
+                            return false;
+                        if (m_value.compare_exchange_weak(value, pack(begin, end - 1), std::memory_order_relaxed)) {
+                            res = end - 1;
+                            return true;
+                        }
+                    }
+                }
+            };
+
+            class pool {
+                using fun_t = void (*)(void const *, std::uint32_t);
+
+                int m_num_threads;
+                std::unique_ptr<range[]> m_ranges;
+                std::vector<std::thread> m_workers;
+
+                std::mutex m_mutex;
+                std::condition_variable m_cv;
+                std::uint64_t m_generation = 0;
+                bool m_stop = false;
+
+                std::mutex m_loop_mutex;
+                fun_t m_fun = nullptr;
+                void const *m_ctx = nullptr;
+                std::atomic<int> m_running{0};
+
+                void work(int index) {
+                    std::uint32_t i;
+                    while (m_ranges[index].pop_front(i))
+                        m_fun(m_ctx, i);
+                    for (int offset = 1; offset < m_num_threads; ++offset) {
+                        auto &victim = m_ranges[(index + offset) % m_num_threads];
+                        while (victim.pop_back(i))
+                            m_fun(m_ctx, i);
+                    }
+                }
+
+                void worker(int index) {
+                    persistent_impl_::init_worker(index);
+                    std::uint64_t generation = 0;
+                    while (true) {
+                        {
+                            std::unique_lock<std::mutex> lock(m_mutex);
+                            m_cv.wait(lock, [&] { return m_stop || m_generation != generation; });
+                            if (m_stop)
+                                return;
+                            generation = m_generation;
+                        }
+                        work(index);
+                        m_running.fetch_sub(1, std::memory_order_release);
+                    }
+                }
+
+              public:
+                pool(int num_threads) : m_num_threads(num_threads), m_ranges(new range[num_threads]) {
+                    for (int i = 1; i < num_threads; ++i)
+                        m_workers.emplace_back([this, i] { worker(i); });
+                }
+
+                pool(pool const &) = delete;
+                pool &operator=(pool const &) = delete;
+
+                ~pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stop = true;
+                    }
+                    m_cv.notify_all();
+                    for (auto &worker : m_workers)
+                        worker.join();
+                }
+
+                int num_threads() const { return m_num_threads; }
+
+                template <class F>
+                void parallel_for(F const &f, std::uint32_t size) {
+                    if (persistent_impl_::in_loop()) {
+                        // nested loop
+                        for (std::uint32_t i = 0; i < size; ++i)
+                            f(i);
+                        return;
+                    }
+                    std::lock_guard<std::mutex> loop_lock(m_loop_mutex);
+                    persistent_impl_::caller_scope scope;
+                    if (m_num_threads == 1) {
+                        for (std::uint32_t i = 0; i < size; ++i)
+                            f(i);
+                        return;
+                    }
+                    for (int t = 0; t < m_num_threads; ++t)
+                        m_ranges[t].set(std::uint64_t(size) * t / m_num_threads,
+                            std::uint64_t(size) * (t + 1) / m_num_threads);
+                    m_fun = [](void const *ctx, std::uint32_t i) { (*static_cast<F const *>(ctx))(i); };
+                    m_ctx = &f;
+                    m_running.store(m_num_threads - 1, std::memory_order_relaxed);
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        ++m_generation;
+                    }
+                    m_cv.notify_all();
+                    work(0);
+                    while (m_running.load(std::memory_order_acquire))
+                        std::this_thread::yield();
+                }
+            };
+
+            inline pool &get_pool() {
+                static pool instance(persistent_impl_::num_threads_from_env());
+                return instance;
+            }
+        } // namespace work_stealing_impl_
+
+        struct work_stealing {
+            friend int thread_pool_get_thread_num(work_stealing) { return work_stealing_impl_::thread_index(); }
+            friend int thread_pool_get_max_threads(work_stealing) {
+                return work_stealing_impl_::get_pool().num_threads();
+            }
+
+            template <class F, class I, class I_t = to_integral_type_t<I>>
+            friend void thread_pool_parallel_for_loop(work_stealing, F const &f, I lim) {
+                work_stealing_impl_::get_pool().parallel_for([&f](std::uint32_t i) { f(I_t(i)); }, lim);
+            }
+        };
+    } // namespace thread_pool
+} // namespace gridtools
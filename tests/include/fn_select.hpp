@@ -28,6 +28,23 @@
 namespace {
     using fn_backend_t = gridtools::fn::backend::naive;
 }
+#elif defined(GT_FN_CPU)
+#ifndef GT_STENCIL_CPU_KFIRST
+#define GT_STENCIL_CPU_KFIRST
+#endif
+#ifndef GT_STORAGE_CPU_KFIRST
+#define GT_STORAGE_CPU_KFIRST
+#endif
+#ifndef GT_TIMER_OMP
+#define GT_TIMER_OMP
+#endif
+#include <gridtools/fn/backend/cpu.hpp>
+namespace {
+    // with the cpu_kfirst storage, the last dimension is the contiguous one
+    using fn_backend_t = gridtools::fn::backend::cpu<gridtools::meta::list<
+        gridtools::meta::list<gridtools::integral_constant<int, 0>, gridtools::integral_constant<int, 8>>,
+        gridtools::meta::list<gridtools::integral_constant<int, 1>, gridtools::integral_constant<int, 8>>>>;
+}
 #elif defined(GT_FN_GPU)
 #ifndef GT_STENCIL_GPU
 #define GT_STENCIL_GPU
@@ -70,6 +87,20 @@ namespace gridtools::fn::backend {
     } // namespace naive_impl_
     using naive_impl_::naive_with_threadpool;
 
+    namespace cpu_impl_ {
+        template <class, class, class, int>
+        struct cpu;
+        template <class LoopBlockSizes, class UnrollFactors, class ThreadPool, int ColumnWidth>
+        storage::cpu_kfirst backend_storage_traits(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>);
+        template <class LoopBlockSizes, class UnrollFactors, class ThreadPool, int ColumnWidth>
+        timer_omp backend_timer_impl(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth>);
+        template <class LoopBlockSizes, class UnrollFactors, class ThreadPool, int ColumnWidth>
+        inline char const *backend_name(cpu<LoopBlockSizes, UnrollFactors, ThreadPool, ColumnWidth> const &) {
+            return "cpu";
+        }
+    } // namespace cpu_impl_
+    using cpu_impl_::cpu;
+
     namespace gpu_impl_ {
         template <class, class>
         struct gpu;
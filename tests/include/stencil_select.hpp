@@ -41,6 +41,28 @@ namespace {
         gridtools::integral_constant<int, 8>,
         gridtools::thread_pool::hpx>;
 }
+#elif defined(GT_STENCIL_CPU_KFIRST_OMP_DYNAMIC) || defined(GT_STENCIL_CPU_KFIRST_WORK_STEALING) || \
+    defined(GT_STENCIL_CPU_KFIRST_NATIVE)
+#ifndef GT_STORAGE_CPU_KFIRST
+#define GT_STORAGE_CPU_KFIRST
+#endif
+#ifndef GT_TIMER_OMP
+#define GT_TIMER_OMP
+#endif
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/thread_pool/native.hpp>
+#include <gridtools/thread_pool/work_stealing.hpp>
+namespace {
+    using stencil_backend_t = gridtools::stencil::cpu_kfirst<gridtools::integral_constant<int, 8>,
+        gridtools::integral_constant<int, 8>,
+#if defined(GT_STENCIL_CPU_KFIRST_OMP_DYNAMIC)
+        gridtools::thread_pool::omp_dynamic<>>;
+#elif defined(GT_STENCIL_CPU_KFIRST_WORK_STEALING)
+        gridtools::thread_pool::work_stealing>;
+#else
+        gridtools::thread_pool::native>;
+#endif
+}
 #elif defined(GT_STENCIL_NAIVE)
 #ifndef GT_STORAGE_CPU_KFIRST
 #define GT_STORAGE_CPU_KFIRST
@@ -77,6 +99,26 @@ namespace {
 namespace {
     using stencil_backend_t = gridtools::stencil::cpu_ifirst<gridtools::thread_pool::hpx>;
 }
+#elif defined(GT_STENCIL_CPU_IFIRST_OMP_DYNAMIC) || defined(GT_STENCIL_CPU_IFIRST_WORK_STEALING) || \
+    defined(GT_STENCIL_CPU_IFIRST_NATIVE)
+#ifndef GT_STORAGE_CPU_IFIRST
+#define GT_STORAGE_CPU_IFIRST
+#endif
+#ifndef GT_TIMER_OMP
+#define GT_TIMER_OMP
+#endif
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/thread_pool/native.hpp>
+#include <gridtools/thread_pool/work_stealing.hpp>
+namespace {
+#if defined(GT_STENCIL_CPU_IFIRST_OMP_DYNAMIC)
+    using stencil_backend_t = gridtools::stencil::cpu_ifirst<gridtools::thread_pool::omp_dynamic<>>;
+#elif defined(GT_STENCIL_CPU_IFIRST_WORK_STEALING)
+    using stencil_backend_t = gridtools::stencil::cpu_ifirst<gridtools::thread_pool::work_stealing>;
+#else
+    using stencil_backend_t = gridtools::stencil::cpu_ifirst<gridtools::thread_pool::native>;
+#endif
+}
 #elif defined(GT_STENCIL_GPU)
 #ifndef GT_STORAGE_GPU
 #define GT_STORAGE_GPU
@@ -165,24 +207,42 @@ namespace gridtools {
                 hpx_stop();
             }
 #endif
+
+#if defined(GT_STENCIL_CPU_KFIRST_OMP_DYNAMIC) || defined(GT_STENCIL_CPU_KFIRST_WORK_STEALING) || \
+    defined(GT_STENCIL_CPU_KFIRST_NATIVE)
+            template <class I, class J, int Chunk>
+            char const *backend_name(cpu_kfirst<I, J, thread_pool::omp_dynamic<Chunk>> const &) {
+                return "cpu_kfirst_omp_dynamic";
+            }
+
+            template <class I, class J>
+            char const *backend_name(cpu_kfirst<I, J, thread_pool::work_stealing> const &) {
+                return "cpu_kfirst_work_stealing";
+            }
+
+            template <class I, class J>
+            char const *backend_name(cpu_kfirst<I, J, thread_pool::native> const &) {
+                return "cpu_kfirst_native";
+            }
+#endif
         } // namespace cpu_kfirst_backend
 
         namespace cpu_ifirst_backend {
-            template <class>
+            template <class, bool>
             struct cpu_ifirst;
 
-            template <class T>
-            storage::cpu_ifirst backend_storage_traits(cpu_ifirst<T>);
+            template <class T, bool S>
+            storage::cpu_ifirst backend_storage_traits(cpu_ifirst<T, S>);
 
-            template <class T>
-            std::false_type backend_supports_icosahedral(cpu_ifirst<T>);
+            template <class T, bool S>
+            std::false_type backend_supports_icosahedral(cpu_ifirst<T, S>);
 
-            template <class T>
-            timer_omp backend_timer_impl(cpu_ifirst<T>);
+            template <class T, bool S>
+            timer_omp backend_timer_impl(cpu_ifirst<T, S>);
 
-            template <class T>
-            char const *backend_name(cpu_ifirst<T> const &) {
-                return "cpu_ifirst";
+            template <class T, bool S>
+            char const *backend_name(cpu_ifirst<T, S> const &) {
+                return S ? "cpu_ifirst_simd" : "cpu_ifirst";
             }
 
 #if defined(GT_STENCIL_CPU_IFIRST_HPX)
@@ -192,6 +252,20 @@ namespace gridtools {
 
             inline void backend_finalize(cpu_ifirst<thread_pool::hpx>) { hpx_stop(); }
 #endif
+
+#if defined(GT_STENCIL_CPU_IFIRST_OMP_DYNAMIC) || defined(GT_STENCIL_CPU_IFIRST_WORK_STEALING) || \
+    defined(GT_STENCIL_CPU_IFIRST_NATIVE)
+            template <int Chunk>
+            char const *backend_name(cpu_ifirst<thread_pool::omp_dynamic<Chunk>> const &) {
+                return "cpu_ifirst_omp_dynamic";
+            }
+
+            inline char const *backend_name(cpu_ifirst<thread_pool::work_stealing> const &) {
+                return "cpu_ifirst_work_stealing";
+            }
+
+            inline char const *backend_name(cpu_ifirst<thread_pool::native> const &) { return "cpu_ifirst_native"; }
+#endif
         } // namespace cpu_ifirst_backend
 
         namespace gpu_backend {
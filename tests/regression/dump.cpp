@@ -8,7 +8,12 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <map>
+#include <sstream>
+#include <string>
+
 #include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
 
 #include <gridtools/stencil/cartesian.hpp>
 #include <gridtools/stencil/dump.hpp>
@@ -88,3 +93,47 @@ TEST(dump, horizontal_diffusion) {
     halo_descriptor hd(2, 2, 2, 2, 5);
     run(horizontal_diffusion, dump{std::cout << std::setw(1)}, make_grid(hd, hd, 1), fake, fake, fake);
 }
+
+struct copy_function {
+    using out = inout_accessor<0>;
+    using in = in_accessor<1>;
+
+    using param_list = make_param_list<out, in>;
+
+    template <typename Evaluation>
+    GT_FUNCTION static void apply(Evaluation eval) {
+        eval(out()) = eval(in());
+    }
+};
+
+TEST(dump, inlined_temporaries) {
+    double fake[5][5][1];
+    halo_descriptor hd(2, 2, 2, 2, 5);
+    std::ostringstream sink;
+    run(
+        [](auto in, auto out) {
+            GT_DECLARE_TMP(double, a, b);
+            return execute_parallel()
+                .stage(copy_function(), a, in)
+                .stage(copy_function(), b, a)
+                .stage(lap_function(), out, b);
+        },
+        dump{sink},
+        make_grid(hd, hd, 1),
+        fake,
+        fake);
+    auto dumped = nlohmann::json::parse(sink.str());
+    std::map<std::string, bool> inlined;
+    for (auto &&matrix : dumped)
+        for (auto &&row : matrix)
+            for (auto &&cell : row)
+                for (auto &&info : cell["plh_infos"])
+                    if (info["is_tmp"])
+                        inlined[info["plh"]] = info["inlined"];
+    // `a` is consumed at the point where it is computed, `b` is read with offsets by the next stage
+    auto &&fun_calls = dumped[0][0][0]["fun_calls"];
+    ASSERT_EQ(fun_calls.size(), 2);
+    std::string a = fun_calls[0]["args"][0]["plh"];
+    std::string b = fun_calls[1]["args"][0]["plh"];
+    EXPECT_EQ(inlined, (std::map<std::string, bool>{{a, true}, {b, false}}));
+}
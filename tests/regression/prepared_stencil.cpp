@@ -0,0 +1,60 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct lap {
+        using out = inout_accessor<0>;
+        using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+        using param_list = make_param_list<out, in>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = 4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+        }
+    };
+
+    const auto spec = [](auto in, auto out) {
+        GT_DECLARE_TMP(double, tmp);
+        return execute_parallel().stage(lap(), tmp, in).stage(lap(), out, tmp);
+    };
+
+    // the run time on small domains is dominated by the per call setup that `prepare` does only once
+    GT_REGRESSION_TEST(prepared_stencil, test_environment<2>, stencil_backend_t) {
+        auto in = [](int_t i, int_t j, int_t k) { return i * 3 + j * 5 % 7 + k * .5; };
+        auto lap_ref = [](auto f) {
+            return [f](int_t i, int_t j, int_t k) {
+                return 4 * f(i, j, k) - (f(i + 1, j, k) + f(i, j + 1, k) + f(i - 1, j, k) + f(i, j - 1, k));
+            };
+        };
+        auto out = TypeParam::make_storage();
+        auto grid = TypeParam::make_grid();
+        auto in_storage = TypeParam::make_const_storage(in);
+        auto stencil = prepare(spec, stencil_backend_t(), grid, in_storage, out);
+        stencil(in_storage, out);
+        TypeParam::verify(lap_ref(lap_ref(in)), out);
+
+        auto other = TypeParam::make_storage();
+        stencil(in_storage, other);
+        TypeParam::verify(lap_ref(lap_ref(in)), other);
+
+        TypeParam::benchmark("prepared_stencil_run", [&] { run(spec, stencil_backend_t(), grid, in_storage, out); });
+        TypeParam::benchmark("prepared_stencil_prepared", [&] { stencil(in_storage, out); });
+    }
+} // namespace
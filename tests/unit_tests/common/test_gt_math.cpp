@@ -117,6 +117,11 @@ namespace {
         ASSERT_EQ(max, 8);
     }
 
+    TEST(math, test_select) {
+        EXPECT_EQ(math::select(true, 2, 3.5), 2.);
+        EXPECT_EQ(math::select(false, 2, 3.5), 3.5);
+    }
+
     TEST(math, test_fabs) { EXPECT_TRUE(test_fabs()); }
 
     TEST(math, test_abs) { EXPECT_TRUE(test_abs()); }
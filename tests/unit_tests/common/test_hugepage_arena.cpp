@@ -0,0 +1,119 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <gridtools/common/hugepage_arena.hpp>
+
+namespace gridtools {
+    namespace {
+        using hugepage_arena_impl_::bucket_size;
+        using hugepage_arena_impl_::max_allocation_offset;
+
+        std::size_t hugepage() { return hugepage_alloc_impl_::hugepage_size(); }
+
+        TEST(hugepage_arena, bucket_size) {
+            auto cache_line = hugepage_alloc_impl_::cache_line_size();
+            auto offset = max_allocation_offset();
+            EXPECT_EQ(bucket_size(1), cache_line);
+            EXPECT_EQ(bucket_size(cache_line + 1), 2 * cache_line);
+            EXPECT_EQ(bucket_size(hugepage() / 2), hugepage() / 2);
+            EXPECT_EQ(bucket_size(hugepage() / 2 + 1), hugepage() - offset);
+            EXPECT_EQ(bucket_size(hugepage() - offset), hugepage() - offset);
+            EXPECT_EQ(bucket_size(hugepage()), 2 * hugepage() - offset);
+            EXPECT_EQ(bucket_size(5 * hugepage() - offset - 1), 5 * hugepage() - offset);
+        }
+
+        TEST(hugepage_arena, reuse) {
+            hugepage_arena arena;
+            void *first;
+            {
+                auto ptr = arena.allocate(1000);
+                first = ptr.get();
+                ptr[999] = 1;
+                EXPECT_EQ(arena.usage(), 1024);
+            }
+            EXPECT_EQ(arena.usage(), 0);
+            {
+                // same bucket, served by the released block
+                auto ptr = arena.allocate(900);
+                EXPECT_EQ(ptr.get(), first);
+            }
+            EXPECT_EQ(arena.system_allocations(), 1);
+            EXPECT_EQ(arena.reserved(), hugepage());
+        }
+
+        TEST(hugepage_arena, small_blocks_share_hugepages) {
+            hugepage_arena arena;
+            std::vector<hugepage_arena::ptr_t> blocks;
+            for (int i = 0; i < 100; ++i)
+                blocks.push_back(arena.allocate(1000));
+            for (int i = 0; i < 10; ++i)
+                blocks.push_back(arena.allocate(64 * 1024));
+            EXPECT_EQ(arena.system_allocations(), 1);
+            EXPECT_EQ(arena.reserved(), hugepage());
+            EXPECT_EQ(arena.usage(), 100 * 1024 + 10 * (64 * 1024 + hugepage_alloc_impl_::cache_line_size()));
+            for (auto &block : blocks)
+                block[0] = 1;
+        }
+
+        TEST(hugepage_arena, large_blocks_fill_hugepages) {
+            hugepage_arena arena;
+            {
+                auto a = arena.allocate(hugepage() - max_allocation_offset());
+                EXPECT_EQ(arena.reserved(), hugepage());
+                EXPECT_EQ(arena.usage(), hugepage());
+                auto b = arena.allocate(hugepage());
+                EXPECT_EQ(arena.reserved(), 3 * hugepage());
+                EXPECT_EQ(arena.usage(), 3 * hugepage());
+            }
+            EXPECT_EQ(arena.usage(), 0);
+            EXPECT_EQ(arena.peak_usage(), 3 * hugepage());
+            EXPECT_EQ(arena.system_allocations(), 2);
+        }
+
+        TEST(hugepage_arena, peak_usage) {
+            hugepage_arena arena;
+            for (int iteration = 0; iteration < 3; ++iteration) {
+                auto a = arena.allocate(1024);
+                auto b = arena.allocate(1024);
+                auto c = arena.allocate(2048);
+            }
+            EXPECT_EQ(arena.usage(), 0);
+            EXPECT_EQ(arena.peak_usage(), 4096);
+            EXPECT_EQ(arena.system_allocations(), 1);
+
+            arena.reset_peak_usage();
+            EXPECT_EQ(arena.peak_usage(), 0);
+            auto a = arena.allocate(64);
+            EXPECT_EQ(arena.peak_usage(), hugepage_alloc_impl_::cache_line_size());
+        }
+
+        TEST(hugepage_arena, trim) {
+            hugepage_arena arena;
+            auto a = arena.allocate(1024);
+            arena.allocate(2048);
+            arena.allocate(hugepage());
+            EXPECT_EQ(arena.reserved(), 3 * hugepage());
+            arena.trim();
+            // the slab still holds a block in use
+            EXPECT_EQ(arena.reserved(), hugepage());
+            arena.allocate(2048);
+            EXPECT_EQ(arena.system_allocations(), 2);
+            a.reset();
+            arena.trim();
+            EXPECT_EQ(arena.reserved(), 0);
+            arena.allocate(2048);
+            EXPECT_EQ(arena.system_allocations(), 3);
+        }
+    } // namespace
+} // namespace gridtools
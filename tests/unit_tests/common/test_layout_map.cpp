@@ -7,6 +7,8 @@
  * Please, refer to the LICENSE file in the root directory.
  * SPDX-License-Identifier: BSD-3-Clause
  */
+#include <type_traits>
+
 #include <gridtools/common/layout_map.hpp>
 
 using namespace gridtools;
@@ -67,3 +69,9 @@ namespace masked_layout {
     static_assert(layout3::at(2) == 1);
     static_assert(layout3::at(3) == 0);
 } // namespace masked_layout
+
+namespace appended_layout {
+    static_assert(std::is_same_v<append_innermost<layout_map<2, 1, 0>>, layout_map<2, 1, 0, 3>>);
+    static_assert(std::is_same_v<append_innermost<layout_map<1, -1, 0>>, layout_map<1, -1, 0, 2>>);
+    static_assert(std::is_same_v<append_innermost<layout_map<-1>>, layout_map<-1, 0>>);
+} // namespace appended_layout
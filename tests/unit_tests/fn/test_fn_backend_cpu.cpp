@@ -0,0 +1,215 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/fn/backend/cpu.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/fn/column_stage.hpp>
+#include <gridtools/fn/extents.hpp>
+#include <gridtools/fn/stencil_stage.hpp>
+#include <gridtools/sid/composite.hpp>
+#include <gridtools/sid/synthetic.hpp>
+
+namespace gridtools::fn::backend {
+    namespace {
+        using namespace literals;
+        using sid::property;
+
+        template <int I>
+        using int_t = integral_constant<int, I>;
+
+        // blocks that don't divide the domain, unrolling of an outer loop
+        using block_sizes_t = meta::list<meta::list<int_t<0>, int_t<2>>, meta::list<int_t<2>, int_t<2>>>;
+        using unroll_factors_t = meta::list<meta::list<int_t<1>, int_t<3>>>;
+        using backend_t = cpu<block_sizes_t, unroll_factors_t>;
+
+        struct sum_scan : fwd {
+            static GT_FUNCTION constexpr auto body() {
+                return scan_pass(
+                    [](auto acc, auto const &iter) { return tuple(get<0>(acc) + *iter, get<1>(acc) * *iter); },
+                    [](auto acc) { return get<0>(acc); });
+            }
+        };
+
+        struct stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &iter) { return 2 * *iter; };
+            }
+        };
+
+        struct make_iterator_mock {
+            auto operator()() const {
+                return [](auto tag, auto const &ptr, auto const &) { return at_key<decltype(tag)>(ptr); };
+            }
+        };
+
+        auto as_synthetic(int x[5][7][3]) {
+            return sid::synthetic()
+                .set<property::origin>(sid::host_device::simple_ptr_holder(&x[0][0][0]))
+                .set<property::strides>(tuple(21_c, 3_c, 1_c));
+        }
+
+        TEST(backend_cpu, apply_stencil_stage) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(as_synthetic(out), as_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::make_values(5, 7, 3);
+
+            apply_stencil_stage(backend_t(), sizes, stencil_stage<stencil, 0, 1>(), make_iterator_mock(), composite);
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        EXPECT_EQ(out[i][j][k], 2 * in[i][j][k]);
+        }
+
+        TEST(backend_cpu, apply_stencil_stage_on_subdomain) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(as_synthetic(out), as_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<3>, int, int_t<2>>(3_c, 6, 2_c);
+
+            apply_stencil_stage(backend_t(), sizes, stencil_stage<stencil, 0, 1>(), make_iterator_mock(), composite);
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        EXPECT_EQ(out[i][j][k], i < 3 && j < 6 && k < 2 ? 2 * in[i][j][k] : 0);
+        }
+
+        TEST(backend_cpu, apply_column_stage) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(as_synthetic(out), as_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+
+            column_stage<int_t<1>, sum_scan, 0, 1> cs;
+
+            apply_column_stage(backend_t(), sizes, cs, make_iterator_mock(), composite, int_t<1>(), tuple(42, 1));
+
+            for (int i = 0; i < 5; ++i)
+                for (int k = 0; k < 3; ++k) {
+                    int res = 42;
+                    for (int j = 0; j < 7; ++j) {
+                        res += in[i][j][k];
+                        EXPECT_EQ(out[i][j][k], res);
+                    }
+                }
+        }
+
+        // the vertical dimension is the outermost one, the second dimension has unit stride
+        auto as_transposed_synthetic(int x[3][5][7]) {
+            return sid::synthetic()
+                .set<property::origin>(sid::host_device::simple_ptr_holder(&x[0][0][0]))
+                .set<property::strides>(tuple(7_c, 1_c, 35_c));
+        }
+
+        TEST(backend_cpu, apply_column_stage_in_column_groups) {
+            int in[3][5][7], out[3][5][7] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[k][i][j] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(
+                as_transposed_synthetic(out), as_transposed_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::make_values(5, 7, 3);
+
+            // groups of four columns along the second dimension, the last three columns are computed one by one
+            using grouped_backend_t =
+                cpu<meta::list<meta::list<int_t<0>, int_t<2>>>, meta::list<>, cpu_impl_::default_thread_pool, 4>;
+            merged_column_stage<column_stage<int_t<2>, sum_scan, 0, 1>, column_stage<int_t<2>, sum_scan, 0, 1>> cs;
+
+            apply_column_stage(
+                grouped_backend_t(), sizes, cs, make_iterator_mock(), composite, int_t<2>(), tuple(42, 0));
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j) {
+                    int res = 42 + in[0][i][j] + in[1][i][j] + in[2][i][j];
+                    for (int k = 0; k < 3; ++k) {
+                        res += in[k][i][j];
+                        EXPECT_EQ(out[k][i][j], res);
+                    }
+                }
+        }
+
+        TEST(backend_cpu, column_lanes) {
+            auto values = fill_lanes<4>(tuple(1, 2.));
+            values.set(2, tuple(3, 4.));
+            EXPECT_EQ(get<0>(values.get(1)), 1);
+            EXPECT_EQ(get<1>(values.get(1)), 2);
+            EXPECT_EQ(get<0>(values.get(2)), 3);
+            EXPECT_EQ(get<1>(values.get(2)), 4);
+            static_assert(std::is_same_v<decltype(values.m_elements), tuple<lanes<int, 4>, lanes<double, 4>>>);
+
+            static_assert(cpu_impl_::column_width<3, double> == 3);
+            static_assert(cpu_impl_::column_width<0, tuple<float, double>> == 4 * vector_register_bytes / 8);
+        }
+
+        TEST(backend_cpu, global_tmp) {
+            auto alloc = tmp_allocator(backend_t());
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+            auto tmp = allocate_global_tmp(alloc, sizes, data_type<int>());
+            static_assert(sid::is_sid<decltype(tmp)>());
+
+            auto ptr = sid::get_origin(tmp)();
+            auto strides = sid::get_strides(tmp);
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k) {
+                        auto p = ptr;
+                        sid::shift(p, sid::get_stride<int_t<0>>(strides), i);
+                        sid::shift(p, sid::get_stride<int_t<1>>(strides), j);
+                        sid::shift(p, sid::get_stride<int_t<2>>(strides), k);
+                        *p = 21 * i + 3 * j + k;
+                    }
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k) {
+                        auto p = ptr;
+                        sid::shift(p, sid::get_stride<int_t<0>>(strides), i);
+                        sid::shift(p, sid::get_stride<int_t<1>>(strides), j);
+                        sid::shift(p, sid::get_stride<int_t<2>>(strides), k);
+                        EXPECT_EQ(*p, 21 * i + 3 * j + k);
+                    }
+        }
+
+        TEST(backend_cpu, tile_tmp) {
+            auto alloc = tmp_allocator(backend_t());
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::make_values(5, 7, 3);
+            auto tmp = allocate_tile_tmp(alloc, sizes, data_type<int>(), extents<extent<int_t<0>, -1, 1>>());
+            static_assert(sid::is_sid<decltype(tmp)>());
+
+            // one block plus extents per thread
+            auto upper_bounds = sid::get_upper_bounds(tmp);
+            EXPECT_EQ(at_key<int_t<0>>(upper_bounds), 4);
+            EXPECT_EQ(at_key<int_t<1>>(upper_bounds), 7);
+            EXPECT_EQ(at_key<int_t<2>>(upper_bounds), 2);
+            EXPECT_EQ(at_key<cpu_impl_::tile_thread_dim>(upper_bounds),
+                thread_pool::get_max_threads(cpu_impl_::default_thread_pool()));
+        }
+    } // namespace
+} // namespace gridtools::fn::backend
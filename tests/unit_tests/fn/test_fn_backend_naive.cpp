@@ -104,5 +104,22 @@ namespace gridtools::fn::backend {
             }
             sid::shift(ptr, sid::get_stride<int_t<0>>(strides), -5_c);
         }
+
+        TEST(backend_naive, global_tmp_reuse) {
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+            auto run = [&] {
+                auto alloc = tmp_allocator(naive());
+                auto a = allocate_global_tmp(alloc, sizes, data_type<int>());
+                auto b = allocate_global_tmp(alloc, sizes, data_type<double>());
+                return tmp_arena().usage();
+            };
+            auto usage = run();
+            auto system_allocations = tmp_arena().system_allocations();
+            for (int i = 0; i < 3; ++i)
+                EXPECT_EQ(run(), usage);
+            EXPECT_EQ(tmp_arena().system_allocations(), system_allocations);
+            EXPECT_GE(tmp_arena().peak_usage(), usage);
+            EXPECT_GE(usage, 105 * (sizeof(int) + sizeof(double)));
+        }
     } // namespace
 } // namespace gridtools::fn::backend
@@ -28,6 +28,16 @@ namespace gridtools::fn {
             }
         };
 
+        struct pointwise_stencil : stencil {
+            static constexpr bool pointwise = true;
+        };
+
+        struct next_stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &iter) { return *(iter + 1); };
+            }
+        };
+
         struct fwd_sum_scan : fwd {
             static GT_FUNCTION constexpr auto body() {
                 return scan_pass([](auto acc, auto const &iter) { return acc + *iter; }, [](auto acc) { return acc; });
@@ -72,6 +82,57 @@ namespace gridtools::fn {
                 }
         }
 
+        TEST(stencil_executor, fused_stages) {
+            using backend_t = backend::naive;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
+
+            int a[2][3] = {}, b[2][3] = {}, c[2][3];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j)
+                    c[i][j] = 3 * i + j;
+
+            make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                .arg(a)
+                .arg(b)
+                .arg(c)
+                .assign(1_c, stencil(), 2_c)
+                .assign(0_c, pointwise_stencil(), 1_c)
+                .execute();
+
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j) {
+                    EXPECT_EQ(a[i][j], (3 * i + j) * 4);
+                    EXPECT_EQ(b[i][j], (3 * i + j) * 2);
+                }
+        }
+
+        TEST(stencil_executor, shifted_read_of_output) {
+            using backend_t = backend::naive;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 2_c);
+
+            int a[2][3] = {}, b[2][3] = {}, c[2][3];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j)
+                    c[i][j] = 3 * i + j;
+
+            // the last column of b is outside of the domain
+            for (int i = 0; i < 2; ++i)
+                b[i][2] = 2 * c[i][2];
+
+            // the second stage reads the output of the first one at the next point, thus they are not fused
+            make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                .arg(a)
+                .arg(b)
+                .arg(c)
+                .assign(1_c, stencil(), 2_c)
+                .assign(0_c, next_stencil(), 1_c)
+                .execute();
+
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 2; ++j)
+                    EXPECT_EQ(a[i][j], (3 * i + j + 1) * 2);
+        }
+
         TEST(vertical_executor, smoke) {
             using backend_t = backend::naive;
             auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
@@ -16,6 +16,7 @@
 
 #include <gridtools/fn/backend/naive.hpp>
 #include <gridtools/fn/column_stage.hpp>
+#include <gridtools/fn/extents.hpp>
 #include <gridtools/fn/stencil_stage.hpp>
 #include <gridtools/sid/concept.hpp>
 
@@ -33,6 +34,36 @@ namespace gridtools::fn {
             }
         };
 
+        struct pointwise_stencil : stencil {
+            static constexpr bool pointwise = true;
+        };
+
+        template <class Stage, class Extents = extents<>>
+        using with_extents = meta::list<Stage, Extents>;
+
+        using tile_extents_t = extents<extent<int_t<0>, -1, 1>>;
+        using tile_tmps_t = meta::list<meta::list<int_t<1>, tile_extents_t>>;
+
+        // reading an earlier output at an offset
+        static_assert(!is_tiling_safe<meta::list<with_extents<stencil_stage<stencil, 1, 2>>,
+                                          with_extents<stencil_stage<stencil, 0, 1>>>,
+                      meta::list<>>::value);
+        static_assert(is_tiling_safe<meta::list<with_extents<stencil_stage<stencil, 1, 2>>,
+                                         with_extents<stencil_stage<pointwise_stencil, 0, 1>>>,
+            meta::list<>>::value);
+        // the tile temporaries are computed on the extended tile
+        static_assert(is_tiling_safe<meta::list<with_extents<stencil_stage<stencil, 1, 2>, tile_extents_t>,
+                                         with_extents<stencil_stage<stencil, 0, 1>>>,
+            tile_tmps_t>::value);
+        // reading an earlier output outside of the tile, on the extended tile
+        static_assert(!is_tiling_safe<meta::list<with_extents<stencil_stage<stencil, 0, 2>>,
+                                          with_extents<stencil_stage<pointwise_stencil, 1, 0>, tile_extents_t>>,
+                      tile_tmps_t>::value);
+        // overwriting an input that an earlier stage reads at an offset
+        static_assert(!is_tiling_safe<meta::list<with_extents<stencil_stage<stencil, 0, 2>>,
+                                          with_extents<stencil_stage<stencil, 2, 3>>>,
+                      meta::list<>>::value);
+
         struct fwd_sum_scan : fwd {
             static GT_FUNCTION constexpr auto body() {
                 return scan_pass([](auto acc, auto const &iter) { return acc + *iter; }, [](auto acc) { return acc; });
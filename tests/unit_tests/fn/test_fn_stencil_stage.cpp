@@ -28,6 +28,10 @@ namespace gridtools::fn {
             }
         };
 
+        struct pointwise_stencil : stencil {
+            static constexpr bool pointwise = true;
+        };
+
         struct make_iterator_mock {
             GT_FUNCTION auto operator()() const {
                 return [](auto tag, auto const &ptr, auto const & /*strides*/) { return at_key<decltype(tag)>(ptr); };
@@ -59,5 +63,29 @@ namespace gridtools::fn {
             EXPECT_EQ(out[0], 336);
         }
 
+        static_assert(is_pointwise<pointwise_stencil>::value);
+        static_assert(!is_pointwise<stencil>::value);
+
+        namespace fuse {
+            using s0 = stencil_stage<stencil, 1, 0>;
+            using s1 = stencil_stage<stencil, 2, 0>;
+            using s2 = stencil_stage<stencil, 3, 1>;
+            using p2 = stencil_stage<pointwise_stencil, 3, 1, 2>;
+            using w0 = stencil_stage<pointwise_stencil, 0, 3>;
+
+            static_assert(std::is_same_v<fuse_stencil_stages<meta::list<>>, meta::list<>>);
+            static_assert(std::is_same_v<fuse_stencil_stages<meta::list<s0>>, meta::list<s0>>);
+            // independent stages
+            static_assert(std::is_same_v<fuse_stencil_stages<meta::list<s0, s1>>,
+                meta::list<merged_stencil_stage<s0, s1>>>);
+            // reads an output, possibly shifted
+            static_assert(std::is_same_v<fuse_stencil_stages<meta::list<s0, s2>>, meta::list<s0, s2>>);
+            // reads outputs at the current point
+            static_assert(std::is_same_v<fuse_stencil_stages<meta::list<s0, s1, p2>>,
+                meta::list<merged_stencil_stage<s0, s1, p2>>>);
+            // overwrites an input of the group
+            static_assert(std::is_same_v<fuse_stencil_stages<meta::list<s0, p2, w0, s2>>,
+                meta::list<merged_stencil_stage<s0, p2>, w0, s2>>);
+        } // namespace fuse
     } // namespace
 } // namespace gridtools::fn
@@ -0,0 +1,67 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <cstddef>
+#include <type_traits>
+
+#include <gridtools/meta.hpp>
+#include <gridtools/stencil/be_api.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace be_api;
+
+            template <class... PlhInfos>
+            struct pass {
+                using plh_map_t = meta::list<PlhInfos...>;
+            };
+
+            template <class Plh, class IsConst>
+            using plh = plh_info<meta::list<Plh>,
+                std::false_type,
+                double,
+                integral_constant<int, 1>,
+                IsConst,
+                extent<>,
+                meta::list<>>;
+
+            template <class Plh>
+            using in = plh<Plh, std::true_type>;
+
+            template <class Plh>
+            using out = plh<Plh, std::false_type>;
+
+            template <size_t... Is>
+            using indices = meta::list<std::integral_constant<size_t, Is>...>;
+
+            struct a;
+            struct b;
+            struct c;
+            struct d;
+            struct e;
+
+            // two independent tracers that read the same field, the third pass consumes the first tracer
+            using tracers_t = meta::list<pass<in<a>, out<b>>, pass<in<a>, out<c>>, pass<in<b>, out<d>>>;
+            static_assert(
+                std::is_same_v<make_pass_dependencies<tracers_t>, meta::list<indices<>, indices<>, indices<0>>>);
+            static_assert(std::is_same_v<make_pass_groups<tracers_t>, meta::list<indices<1>, indices<0, 2>>>);
+
+            // write after read and write after write are dependencies as well
+            using war_waw_t = meta::list<pass<in<a>, out<b>>, pass<out<a>>, pass<in<c>, out<b>>, pass<in<d>, out<e>>>;
+            static_assert(std::is_same_v<make_pass_dependencies<war_waw_t>,
+                meta::list<indices<>, indices<0>, indices<0>, indices<>>>);
+            static_assert(std::is_same_v<make_pass_groups<war_waw_t>, meta::list<indices<0, 1, 2>, indices<3>>>);
+
+            // a pass that depends on two independent groups merges them
+            using join_t = meta::list<pass<in<a>, out<b>>, pass<in<a>, out<c>>, pass<in<b>, in<c>, out<d>>>;
+            static_assert(std::is_same_v<make_pass_groups<join_t>, meta::list<indices<0, 1, 2>>>);
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,74 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <type_traits>
+
+#include <gridtools/meta.hpp>
+#include <gridtools/stencil/be_api.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace be_api;
+
+            template <class... Plhs>
+            struct stage {
+                using plhs_t = meta::list<Plhs...>;
+            };
+
+            template <class Plh, class Data = double, class Extent = extent<>>
+            using tmp = plh_info<meta::list<Plh>,
+                std::true_type,
+                Data,
+                integral_constant<int, 1>,
+                std::false_type,
+                Extent,
+                meta::list<>>;
+
+            struct a;
+            struct b;
+            struct c;
+            struct d;
+            struct in;
+            struct out;
+
+            template <class... Plhs>
+            using slot_plhs = meta::list<Plhs...>;
+
+            template <class Slot>
+            using get_plhs = typename Slot::plhs_t;
+
+            template <class Slots>
+            using plhs_of = meta::transform<get_plhs, Slots>;
+
+            // a chain: every temporary is dead after the next stage
+            using chain_t = meta::list<stage<in, a>, stage<a, b>, stage<b, c>, stage<c, d>, stage<d, out>>;
+            static_assert(std::is_same_v<plhs_of<make_tmp_slots<chain_t, meta::list<tmp<a>, tmp<b>, tmp<c>, tmp<d>>>>,
+                meta::list<slot_plhs<a, c>, slot_plhs<b, d>>>);
+
+            // the order of the placeholder map doesn't matter
+            static_assert(std::is_same_v<plhs_of<make_tmp_slots<chain_t, meta::list<tmp<d>, tmp<c>, tmp<b>, tmp<a>>>>,
+                meta::list<slot_plhs<a, c>, slot_plhs<b, d>>>);
+
+            // `a` is live until the last stage
+            using long_lived_t = meta::list<stage<in, a>, stage<a, b>, stage<b, c>, stage<a, c, out>>;
+            static_assert(std::is_same_v<plhs_of<make_tmp_slots<long_lived_t, meta::list<tmp<a>, tmp<b>, tmp<c>>>>,
+                meta::list<slot_plhs<a>, slot_plhs<b>, slot_plhs<c>>>);
+
+            // different data types don't share storage, the storage of a slot is allocated with the enclosing extent
+            using mixed_tmps_t =
+                meta::list<tmp<a, double, extent<-1, 1>>, tmp<b>, tmp<c, float>, tmp<d, double, extent<0, 2>>>;
+            using mixed_slots_t = make_tmp_slots<chain_t, mixed_tmps_t>;
+            static_assert(
+                std::is_same_v<plhs_of<mixed_slots_t>, meta::list<slot_plhs<a, d>, slot_plhs<b>, slot_plhs<c>>>);
+            static_assert(std::is_same_v<typename meta::first<mixed_slots_t>::info_t::extent_t, extent<-1, 2>>);
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,70 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_ifirst/execinfo.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/common/extent.hpp>
+#include <gridtools/stencil/cpu_ifirst/ij_cache.hpp>
+#include <gridtools/thread_pool/dummy.hpp>
+
+using namespace gridtools;
+using namespace stencil;
+using namespace cpu_ifirst_backend;
+
+namespace {
+    struct grid_t {
+        int_t i_size() const { return 1000; }
+        int_t j_size() const { return 300; }
+    };
+
+    struct plh_info_t {
+        using data_t = double;
+        using extent_t = extent<-1, 1, -1, 1>;
+    };
+
+    void check_blocks(execinfo const &info) {
+        int_t i_total = 0;
+        for (int_t i = 0; i < info.i_blocks(); ++i)
+            i_total += info.block(i, 0).i_block_size;
+        int_t j_total = 0;
+        for (int_t j = 0; j < info.j_blocks(); ++j)
+            j_total += info.block(0, j).j_block_size;
+        EXPECT_EQ(i_total, grid_t().i_size());
+        EXPECT_EQ(j_total, grid_t().j_size());
+    }
+
+    TEST(execinfo, whole_domain) {
+        execinfo info{thread_pool::dummy(), grid_t()};
+        EXPECT_EQ(info.i_blocks(), 1);
+        EXPECT_EQ(info.j_blocks(), 1);
+        check_blocks(info);
+    }
+
+    TEST(execinfo, fit_tiles) {
+        using tile_bytes_t = ij_cache_impl_::tile_bytes_f<meta::list<plh_info_t, plh_info_t>>;
+        std::size_t max_tile_bytes = 64 * 1024;
+        execinfo info(thread_pool::dummy(), grid_t(), tile_bytes_t(), max_tile_bytes);
+        EXPECT_LE(tile_bytes_t()(info.i_block_size(), info.j_block_size()), max_tile_bytes);
+        EXPECT_GT(info.i_blocks() * info.j_blocks(), 1);
+        EXPECT_GE(info.i_block_size(), info.j_block_size());
+        check_blocks(info);
+    }
+
+    TEST(execinfo, minimal_tiles) {
+        execinfo info(
+            thread_pool::dummy(), grid_t(), [](int_t i, int_t j) -> std::size_t { return i * j; }, 0);
+        EXPECT_EQ(info.i_block_size(), 1);
+        EXPECT_EQ(info.j_block_size(), 1);
+        EXPECT_EQ(info.i_blocks(), grid_t().i_size());
+        EXPECT_EQ(info.j_blocks(), grid_t().j_size());
+    }
+} // namespace
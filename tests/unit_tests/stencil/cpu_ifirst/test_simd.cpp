@@ -0,0 +1,422 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_ifirst/simd.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/hymap.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/global_parameter.hpp>
+#include <gridtools/stencil/naive.hpp>
+#include <gridtools/stencil/positional.hpp>
+#include <gridtools/stencil/reduction_output.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/sid.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_ifirst_backend {
+            namespace {
+                using namespace cartesian;
+                using namespace literals;
+
+                struct a;
+                struct b;
+                struct c;
+
+                template <class... Strides>
+                using strides_t =
+                    hymap::keys<dim::i>::values<typename hymap::keys<a, b, c>::template values<Strides...>>;
+
+                using ptr_t = hymap::keys<a, b, c>::values<double const *, float *, int const *>;
+
+                static_assert(simd_width<ptr_t, strides_t<integral_constant<int_t, 1>, integral_constant<int_t, 1>,
+                                                    integral_constant<int_t, 0>>> == simd_impl_::register_bytes / 8);
+                static_assert(simd_width<ptr_t, strides_t<integral_constant<int_t, 0>, integral_constant<int_t, 1>,
+                                                    integral_constant<int_t, 0>>> == simd_impl_::register_bytes / 4);
+                // runtime stride
+                static_assert(simd_width<ptr_t, strides_t<int_t, integral_constant<int_t, 1>,
+                                                    integral_constant<int_t, 0>>> == 0);
+                // written data with zero stride
+                static_assert(simd_width<ptr_t, strides_t<integral_constant<int_t, 1>, integral_constant<int_t, 0>,
+                                                    integral_constant<int_t, 0>>> == 0);
+                // nothing to vectorize
+                static_assert(simd_width<ptr_t, strides_t<integral_constant<int_t, 0>, integral_constant<int_t, 0>,
+                                                    integral_constant<int_t, 0>>> == 0);
+
+                // accumulation into a reduction output
+                using reduction_ptr_t = reduction_output_impl_::ptr<reduction::plus, double>;
+                static_assert(simd_width<hymap::keys<a, b>::values<double const *, reduction_ptr_t>,
+                                  hymap::keys<dim::i>::values<hymap::keys<a, b>::values<integral_constant<int_t, 1>,
+                                      integral_constant<int_t, 0>>>> == 0);
+
+                // vectors along the members of an ensemble
+                using ensemble_strides_t = hymap::keys<dim::i, dim::e>::values<
+                    typename hymap::keys<a, b, c>::template values<int_t, int_t, integral_constant<int_t, 0>>,
+                    typename hymap::keys<a, b, c>::template values<integral_constant<int_t, 1>,
+                        integral_constant<int_t, 1>,
+                        integral_constant<int_t, 0>>>;
+                static_assert(simd_width<ptr_t, ensemble_strides_t> == 0);
+                static_assert(simd_width<ptr_t, ensemble_strides_t, dim::e> == simd_impl_::register_bytes / 8);
+
+                TEST(simd, vec) {
+                    using vec_t = vec<double, 4>;
+                    double data[4] = {1, -2, 3, -4};
+                    auto x = vec_t::load(data);
+                    auto y = math::max(math::fabs(x) * 2. - 1, vec_t(3));
+                    double expected[4] = {3, 3, 5, 7};
+                    for (int i = 0; i < 4; ++i)
+                        EXPECT_EQ(y[i], expected[i]);
+
+                    simd_ref<double, 4>(data) += 1;
+                    double expected_data[4] = {2, -1, 4, -3};
+                    for (int i = 0; i < 4; ++i)
+                        EXPECT_EQ(data[i], expected_data[i]);
+
+                    // a named `simd_ref` is a local copy
+                    simd_ref<double, 4> ref(data);
+                    ref = 0.;
+                    ref *= 2;
+                    for (int i = 0; i < 4; ++i) {
+                        EXPECT_EQ(ref[i], 0);
+                        EXPECT_EQ(data[i], expected_data[i]);
+                    }
+                }
+
+                static_assert(!std::is_copy_constructible_v<simd_ref<double, 4>>);
+
+                TEST(simd, mask) {
+                    using vec_t = vec<double, 4>;
+                    double data[4] = {1, -2, 3, -4};
+                    auto x = vec_t::load(data);
+                    auto y = math::select((x > 0 && !(x == 3.)) || x < -3, x, 0);
+                    auto z = math::max(x, 0.) + math::min(2, x);
+                    double expected_y[4] = {1, 0, 0, -4};
+                    double expected_z[4] = {2, -2, 5, -4};
+                    for (int i = 0; i < 4; ++i) {
+                        EXPECT_EQ(y[i], expected_y[i]);
+                        EXPECT_EQ(z[i], expected_z[i]);
+                    }
+
+                    simd_ref<double, 4> ref(data);
+                    auto w = math::min(ref, ref) - math::pow(ref, 2);
+                    double expected_w[4] = {0, -6, -6, -20};
+                    for (int i = 0; i < 4; ++i)
+                        EXPECT_EQ(w[i], expected_w[i]);
+                }
+
+                struct lap_function {
+                    using out = inout_accessor<0>;
+                    using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+                    using param_list = make_param_list<out, in>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        eval(out()) =
+                            4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+                    }
+                };
+
+                struct diffusion {
+                    using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+                    using coeff = in_accessor<1>;
+                    using factor = in_accessor<2>;
+                    using out = inout_accessor<3>;
+                    using param_list = make_param_list<in, coeff, factor, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        auto lap = call<lap_function>::with(eval, in());
+                        auto res = eval(in()) - eval(factor()) * eval(coeff()) * lap;
+                        eval(out()) = math::min(math::max(res, eval(in()) - 1), eval(in()) + 1);
+                    }
+                };
+
+                struct limiter {
+                    using in = in_accessor<0>;
+                    using coeff = in_accessor<1>;
+                    using factor = in_accessor<2>;
+                    using out = inout_accessor<3>;
+                    using param_list = make_param_list<in, coeff, factor, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        auto x = eval(in()) - eval(coeff());
+                        auto positive = math::max(x * eval(factor()), .1);
+                        eval(out()) = math::select(x < 0 && eval(in()) > .3, math::min(-x, 1.), positive);
+                    }
+                };
+
+                // not written generically, computed by the scalar code
+                struct typed_local {
+                    static constexpr bool simd = false;
+
+                    using in = in_accessor<0>;
+                    using coeff = in_accessor<1>;
+                    using factor = in_accessor<2>;
+                    using out = inout_accessor<3>;
+                    using param_list = make_param_list<in, coeff, factor, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        double x = eval(in()) - eval(coeff());
+                        if (x < 0)
+                            x *= -eval(factor());
+                        eval(out()) = x;
+                    }
+                };
+
+                // assigns to local copies of a written field
+                struct local_copy {
+                    using in = in_accessor<0>;
+                    using coeff = in_accessor<1>;
+                    using out = inout_accessor<2>;
+                    using param_list = make_param_list<in, coeff, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        auto old = eval(out());
+                        eval(out()) = eval(in());
+                        auto x = eval(out());
+                        x = eval(coeff()) * x;
+                        x += old;
+                        eval(out()) += x;
+                    }
+                };
+
+                static_assert(simd_impl_::is_simd_functor<limiter>::value);
+                static_assert(!simd_impl_::is_simd_functor<typed_local>::value);
+
+                struct twice {
+                    using in = in_accessor<0>;
+                    using out = inout_accessor<1>;
+                    using param_list = make_param_list<in, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        eval(out()) = 2 * eval(in());
+                    }
+                };
+
+                struct with_position {
+                    using in = in_accessor<0>;
+                    using i = in_accessor<1>;
+                    using out = inout_accessor<2>;
+                    using param_list = make_param_list<in, i, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        eval(out()) = eval(in()) + eval(i());
+                    }
+                };
+
+                struct accumulate {
+                    using in = in_accessor<0>;
+                    using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+                    using param_list = make_param_list<in, out>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+                        eval(out()) = eval(in());
+                    }
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+                        eval(out()) = eval(out(0, 0, -1)) + eval(in());
+                    }
+                };
+
+                auto builder = storage::builder<storage::cpu_ifirst>.type<double>().halos(2, 2, 0);
+
+                template <class Storage, class F>
+                void verify(Storage const &actual, F const &expected) {
+                    auto view = actual->const_host_view();
+                    auto &&lengths = actual->lengths();
+                    for (int i = 2; i < lengths[0] - 2; ++i)
+                        for (int j = 2; j < lengths[1] - 2; ++j)
+                            for (int k = 0; k < lengths[2]; ++k)
+                                EXPECT_DOUBLE_EQ(view(i, j, k), expected(i, j, k)) << i << " " << j << " " << k;
+                }
+
+                template <class F>
+                void test_diffusion(F const &spec) {
+                    // odd sizes to exercise the scalar remainder
+                    for (int i_size : {1, 3, 7, 13, 37}) {
+                        auto grid = make_grid(halo_descriptor(2, 2, 2, i_size + 1, i_size + 4),
+                            halo_descriptor(2, 2, 2, 6, 9),
+                            axis<1>(4));
+                        auto b = builder.dimensions(i_size + 4, 9, 4);
+                        auto in =
+                            b.initializer([](int i, int j, int k) { return (i * 7 + j * 3 + k) % 5 * .3; }).build();
+                        auto coeff = b.initializer([](int i, int j, int k) { return .1 + .01 * (i + j + k); }).build();
+                        auto expected = b.build();
+                        auto actual = b.build();
+                        run(spec, cpu_ifirst<>(), grid, in, coeff, global_parameter(.5), expected);
+                        run(spec, cpu_ifirst<thread_pool::omp, true>(), grid, in, coeff, global_parameter(.5), actual);
+                        auto view = expected->const_host_view();
+                        verify(actual, [&](int i, int j, int k) { return view(i, j, k); });
+                    }
+                }
+
+                TEST(simd, parallel) {
+                    test_diffusion([](auto in, auto coeff, auto factor, auto out) {
+                        return execute_parallel().stage(diffusion(), in, coeff, factor, out);
+                    });
+                }
+
+                TEST(simd, parallel_with_temporary) {
+                    test_diffusion([](auto in, auto coeff, auto factor, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel()
+                            .stage(diffusion(), in, coeff, factor, tmp)
+                            .stage(diffusion(), tmp, coeff, factor, out);
+                    });
+                }
+
+                TEST(simd, inlined_temporary) {
+                    test_diffusion([](auto in, auto coeff, auto factor, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel()
+                            .stage(diffusion(), in, coeff, factor, tmp)
+                            .stage(twice(), tmp, out);
+                    });
+                }
+
+                TEST(simd, select) {
+                    test_diffusion([](auto in, auto coeff, auto factor, auto out) {
+                        return execute_parallel().stage(limiter(), in, coeff, factor, out);
+                    });
+                }
+
+                TEST(simd, scalar_functor) {
+                    test_diffusion([](auto in, auto coeff, auto factor, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel()
+                            .stage(typed_local(), in, coeff, factor, tmp)
+                            .stage(limiter(), tmp, coeff, factor, out);
+                    });
+                }
+
+                TEST(simd, local_copy) {
+                    auto grid = make_grid(halo_descriptor(2, 2, 2, 14, 17), halo_descriptor(2, 2, 2, 5, 8), axis<1>(2));
+                    auto b = builder.dimensions(17, 8, 2);
+                    auto in = b.initializer([](int i, int j, int k) { return (i * 7 + j * 3 + k) % 5 * .3; }).build();
+                    auto coeff = b.initializer([](int i, int j, int k) { return .1 + .01 * (i + j + k); }).build();
+                    auto out_init = [](int i, int j, int k) { return i - j * .5 + k; };
+                    auto expected = b.initializer(out_init).build();
+                    auto actual = b.initializer(out_init).build();
+                    run_single_stage(local_copy(), cpu_ifirst<thread_pool::omp, false>(), grid, in, coeff, expected);
+                    run_single_stage(local_copy(), cpu_ifirst<thread_pool::omp, true>(), grid, in, coeff, actual);
+                    auto view = expected->const_host_view();
+                    verify(actual, [&](int i, int j, int k) { return view(i, j, k); });
+                    verify(expected, [&](int i, int j, int k) {
+                        double x = (i * 7 + j * 3 + k) % 5 * .3;
+                        return x + (.1 + .01 * (i + j + k)) * x + out_init(i, j, k);
+                    });
+                }
+
+                TEST(simd, forward_with_k_cache) {
+                    auto grid = make_grid(halo_descriptor(2, 2, 2, 12, 15), halo_descriptor(2, 2, 2, 4, 7), axis<1>(6));
+                    auto b = builder.dimensions(15, 7, 6);
+                    auto in = b.initializer([](int i, int j, int k) { return i + j * .1 + k * .01; }).build();
+                    auto out = b.build();
+                    run(
+                        [](auto in, auto out) {
+                            GT_DECLARE_TMP(double, tmp);
+                            return execute_forward()
+                                .k_cached(cache_io_policy::flush(), tmp)
+                                .stage(accumulate(), in, tmp)
+                                .stage(accumulate(), tmp, out);
+                        },
+                        cpu_ifirst<thread_pool::omp, true>(),
+                        grid,
+                        in,
+                        out);
+                    verify(out, [](int i, int j, int k) {
+                        double res = 0;
+                        for (int kk = 0; kk <= k; ++kk)
+                            res += (k - kk + 1) * (i + j * .1 + kk * .01);
+                        return res;
+                    });
+                }
+
+                TEST(simd, reduction_output) {
+                    auto grid = make_grid(halo_descriptor(2, 2, 2, 11, 15), halo_descriptor(2, 2, 2, 4, 7), axis<1>(3));
+                    auto b = builder.dimensions(15, 7, 3);
+                    auto in = b.initializer([](int i, int j, int k) { return (i * 7 + j * 3 + k) % 5; }).build();
+                    auto coeff = b.value(.25).build();
+                    auto spec = [](auto in, auto coeff, auto factor, auto sum) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel()
+                            .stage(diffusion(), in, coeff, factor, tmp)
+                            .stage(twice(), tmp, sum);
+                    };
+                    reduction_output<double> expected(0);
+                    reduction_output<double> actual(0);
+                    run(spec, cpu_ifirst<>(), grid, in, coeff, global_parameter(.5), expected);
+                    run(spec, cpu_ifirst<thread_pool::omp, true>(), grid, in, coeff, global_parameter(.5), actual);
+                    EXPECT_DOUBLE_EQ(expected.result(), actual.result());
+                }
+
+                TEST(simd, positional_fallback) {
+                    auto grid = make_grid(halo_descriptor(2, 2, 2, 10, 13), halo_descriptor(2, 2, 2, 4, 7), axis<1>(2));
+                    auto b = builder.dimensions(13, 7, 2);
+                    auto in = b.initializer([](int, int j, int k) { return j + k; }).build();
+                    auto out = b.build();
+                    run_single_stage(
+                        with_position(), cpu_ifirst<thread_pool::omp, true>(), grid, in, positional<dim::i>(), out);
+                    verify(out, [](int i, int j, int k) { return i + j + k; });
+                }
+
+                TEST(simd, ensemble) {
+                    auto grid = make_grid(halo_descriptor(2, 2, 2, 6, 9), halo_descriptor(2, 2, 2, 4, 7), axis<1>(5));
+                    auto b = builder.dimensions(9, 7, 5);
+                    auto coeff = b.initializer([](int i, int j, int k) { return .1 + .01 * (i + j + k); }).build();
+                    auto spec = [](auto in, auto coeff, auto factor, auto out) {
+                        GT_DECLARE_TMP(double, tmp, acc);
+                        return multi_pass(execute_parallel().stage(diffusion(), in, coeff, factor, tmp),
+                            execute_forward()
+                                .k_cached(cache_io_policy::flush(), acc)
+                                .stage(accumulate(), tmp, acc)
+                                .stage(twice(), acc, out));
+                    };
+                    // member counts with and without a scalar remainder
+                    for (int members : {1, 3, 8, 13}) {
+                        auto in = b.ensemble(members)
+                                      .initializer([](int i, int j, int k, int m) { return (i * 7 + j + k + m) % 5; })
+                                      .build();
+                        auto expected = b.ensemble(members).build();
+                        auto actual = b.ensemble(members).build();
+                        run_ensemble(spec, naive(), grid, members, in, coeff, global_parameter(.5), expected);
+                        run_ensemble(spec,
+                            cpu_ifirst<thread_pool::omp, true>(),
+                            grid,
+                            members,
+                            in,
+                            coeff,
+                            global_parameter(.5),
+                            actual);
+                        auto expected_view = expected->const_host_view();
+                        auto actual_view = actual->const_host_view();
+                        for (int i = 2; i < 7; ++i)
+                            for (int j = 2; j < 5; ++j)
+                                for (int k = 0; k < 5; ++k)
+                                    for (int m = 0; m < members; ++m)
+                                        EXPECT_DOUBLE_EQ(actual_view(i, j, k, m), expected_view(i, j, k, m))
+                                            << i << " " << j << " " << k << " " << m;
+                    }
+                }
+            } // namespace
+        }     // namespace cpu_ifirst_backend
+    }         // namespace stencil
+} // namespace gridtools
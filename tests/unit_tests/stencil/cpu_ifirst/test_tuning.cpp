@@ -0,0 +1,81 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_ifirst/tuning.hpp>
+
+#include <cstdio>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace gridtools;
+using namespace stencil;
+using namespace cpu_ifirst_backend;
+using namespace tuning_impl_;
+
+namespace {
+    struct tuning : testing::Test {
+        std::string path = testing::TempDir() + "gt_tuning_cache_test.txt";
+
+        void SetUp() override { std::remove(path.c_str()); }
+        void TearDown() override { std::remove(path.c_str()); }
+    };
+
+    TEST_F(tuning, cache_roundtrip) {
+        {
+            tuning_cache cache(path);
+            EXPECT_EQ(cache.find("abc 40 400 80 4"), nullptr);
+            cache.store("abc 40 400 80 4", {40, 8});
+            cache.store("abc 40 400 80 8", {20, 4});
+            cache.store("abc 40 400 80 4", {40, 16});
+        }
+        tuning_cache cache(path);
+        ASSERT_NE(cache.find("abc 40 400 80 4"), nullptr);
+        EXPECT_EQ(*cache.find("abc 40 400 80 4"), block_sizes_t(40, 16));
+        ASSERT_NE(cache.find("abc 40 400 80 8"), nullptr);
+        EXPECT_EQ(*cache.find("abc 40 400 80 8"), block_sizes_t(20, 4));
+    }
+
+    TEST_F(tuning, candidates) {
+        auto res = candidates(40, 400, 4, {40, 100});
+        ASSERT_FALSE(res.empty());
+        EXPECT_EQ(res.front(), block_sizes_t(40, 100));
+        for (auto &&sizes : res) {
+            EXPECT_GE(sizes.first, 8);
+            EXPECT_GE(sizes.second, 1);
+            EXPECT_GE((40 + sizes.first - 1) / sizes.first * ((400 + sizes.second - 1) / sizes.second), 4);
+        }
+    }
+
+    TEST_F(tuning, tuner) {
+        std::string key = "abc 40 400 80 4";
+        {
+            tuner t(path);
+            // the first invocation is not measured
+            auto warm_up = t.next(key, 40, 400, 4, {40, 100});
+            EXPECT_EQ(warm_up.second, -1);
+            EXPECT_EQ(warm_up.first, block_sizes_t(40, 100));
+            auto n = candidates(40, 400, 4, {40, 100}).size();
+            for (std::size_t i = 0; i < n; ++i) {
+                auto next = t.next(key, 40, 400, 4, {40, 100});
+                ASSERT_EQ(next.second, (int)i);
+                // the third candidate is the fastest one
+                t.report(key, next.second, i == 2 ? 1. : 2.);
+            }
+            auto tuned = t.next(key, 40, 400, 4, {40, 100});
+            EXPECT_EQ(tuned.second, -1);
+            EXPECT_EQ(tuned.first, candidates(40, 400, 4, {40, 100})[2]);
+        }
+        tuner t(path);
+        auto tuned = t.next(key, 40, 400, 4, {40, 100});
+        EXPECT_EQ(tuned.second, -1);
+        EXPECT_EQ(tuned.first, candidates(40, 400, 4, {40, 100})[2]);
+    }
+} // namespace
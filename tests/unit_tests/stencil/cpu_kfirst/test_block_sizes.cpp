@@ -0,0 +1,94 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_kfirst/tuning.hpp>
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#define GT_STENCIL_CPU_KFIRST
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace cartesian {
+            namespace {
+                struct lap_function {
+                    using out = inout_accessor<0>;
+                    using in = in_accessor<1, extent<-1, 1, -1, 1>>;
+
+                    using param_list = make_param_list<out, in>;
+
+                    template <class Eval>
+                    GT_FUNCTION static void apply(Eval &&eval) {
+                        eval(out()) =
+                            4 * eval(in()) - (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) + eval(in(0, -1)));
+                    }
+                };
+
+                using env_t = test_environment<2>::apply<stencil_backend_t, double, inlined_params<23, 17, 5>>;
+
+                double in(int i, int j, int k) { return i * i + 3 * j + k; }
+
+                double expected(int i, int j, int k) {
+                    auto lap = [](int i, int j, int k) {
+                        return 4 * in(i, j, k) -
+                               (in(i + 1, j, k) + in(i, j + 1, k) + in(i - 1, j, k) + in(i, j - 1, k));
+                    };
+                    return 4 * lap(i, j, k) -
+                           (lap(i + 1, j, k) + lap(i, j + 1, k) + lap(i - 1, j, k) + lap(i, j - 1, k));
+                }
+
+                template <class Backend>
+                auto run_lap_lap(Backend backend) {
+                    auto out = env_t::make_storage();
+                    auto spec = [](auto in, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel().stage(lap_function(), tmp, in).stage(lap_function(), out, tmp);
+                    };
+                    run(spec, backend, env_t::make_grid(), env_t::make_storage(in), out);
+                    return out;
+                }
+
+                TEST(block_sizes, compile_time) {
+                    using backend_t = cpu_kfirst<integral_constant<int_t, 5>, integral_constant<int_t, 3>>;
+                    env_t::verify(expected, run_lap_lap(backend_t()));
+                }
+
+                TEST(block_sizes, run_time) {
+                    for (int_t i : {1, 4, 8, 100})
+                        for (int_t j : {1, 3, 16})
+                            env_t::verify(expected, run_lap_lap(cpu_kfirst<int_t, int_t>{i, j}));
+                }
+
+                TEST(block_sizes, tuning) {
+                    std::vector<std::pair<int_t, int_t>> candidates = {{4, 4}, {8, 2}, {16, 1}};
+                    int calls = 0;
+                    auto backend = cpu_kfirst_backend::tune_block_sizes(
+                        [&](auto backend) {
+                            ++calls;
+                            env_t::verify(expected, run_lap_lap(backend));
+                        },
+                        candidates,
+                        2);
+                    EXPECT_EQ(calls, 6);
+                    EXPECT_NE(std::find(candidates.begin(),
+                                  candidates.end(),
+                                  std::make_pair(backend.i_block_size, backend.j_block_size)),
+                        candidates.end());
+                }
+            } // namespace
+        }     // namespace cartesian
+    }         // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,172 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/global_parameter.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/sid.hpp>
+
+#include <stencil_select.hpp>
+#include <storage_select.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    constexpr int i_size = 6;
+    constexpr int j_size = 5;
+    constexpr int k_size = 4;
+
+    struct scale {
+        using in = in_accessor<0>;
+        using coeff = in_accessor<1>;
+        using factor = in_accessor<2>;
+        using out = inout_accessor<3>;
+        using param_list = make_param_list<in, coeff, factor, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(factor()) * eval(coeff()) * eval(in());
+        }
+    };
+
+    struct avg {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = .25 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1)));
+        }
+    };
+
+    struct sum_up {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+            eval(out()) = eval(out(0, 0, -1)) + eval(in());
+        }
+    };
+
+    struct sum_down {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using buff = inout_accessor<2, extent<0, 0, 0, 0, 0, 1>>;
+        using param_list = make_param_list<in, out, buff>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::last_level) {
+            eval(buff()) = eval(in());
+            eval(out()) = eval(buff());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<0, -1>) {
+            eval(buff()) = eval(buff(0, 0, 1)) + eval(in());
+            eval(out()) = eval(buff());
+        }
+    };
+
+    double in_value(int i, int j, int k, int m) { return (i * 7 + j * 3 + k * 5 + m * 2) % 11; }
+    double coeff_value(int i, int j, int k) { return 1 + (i + 2 * j + k) % 3; }
+
+    auto make_grid() {
+        return stencil::make_grid(
+            halo_descriptor(1, 1, 1, i_size - 2, i_size), halo_descriptor(1, 1, 1, j_size - 2, j_size), k_size);
+    }
+
+    auto builder = storage::builder<storage_traits_t>.type<double>().dimensions(i_size, j_size, k_size);
+
+    void check_ensemble(int members) {
+        auto in = builder.ensemble(members).initializer(in_value).build();
+        auto out = builder.ensemble(members).build();
+        auto coeff = builder.initializer(coeff_value).build();
+        run_ensemble(
+            [](auto in, auto coeff, auto factor, auto out) {
+                GT_DECLARE_TMP(double, scaled, smoothed);
+                return multi_pass(
+                    execute_parallel().stage(scale(), in, coeff, factor, scaled).stage(avg(), scaled, smoothed),
+                    execute_forward().stage(sum_up(), smoothed, out));
+            },
+            stencil_backend_t(),
+            make_grid(),
+            members,
+            in,
+            coeff,
+            global_parameter(.5),
+            out);
+        auto scaled = [&](int i, int j, int k, int m) { return .5 * coeff_value(i, j, k) * in_value(i, j, k, m); };
+        auto view = out->const_host_view();
+        for (int m = 0; m < members; ++m)
+            for (int i = 1; i < i_size - 1; ++i)
+                for (int j = 1; j < j_size - 1; ++j) {
+                    double sum = 0;
+                    for (int k = 0; k < k_size; ++k) {
+                        sum += .25 * (scaled(i + 1, j, k, m) + scaled(i - 1, j, k, m) + scaled(i, j + 1, k, m) +
+                                         scaled(i, j - 1, k, m));
+                        EXPECT_DOUBLE_EQ(view(i, j, k, m), sum) << i << " " << j << " " << k << " " << m;
+                    }
+                }
+    }
+
+    // more levels than the rewind period of the rolling k-caches of cpu_ifirst
+    constexpr int long_k_size = 20;
+
+    void check_k_cached_ensemble(int members) {
+        auto long_builder = storage::builder<storage_traits_t>.type<double>().dimensions(i_size, j_size, long_k_size);
+        auto in = long_builder.ensemble(members).initializer(in_value).build();
+        auto out = long_builder.ensemble(members).build();
+        run_ensemble(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, tmp);
+                return execute_backward().k_cached(tmp).stage(sum_down(), in, out, tmp);
+            },
+            stencil_backend_t(),
+            stencil::make_grid(halo_descriptor(1, 1, 1, i_size - 2, i_size),
+                halo_descriptor(1, 1, 1, j_size - 2, j_size),
+                long_k_size),
+            members,
+            in,
+            out);
+        auto view = out->const_host_view();
+        for (int m = 0; m < members; ++m)
+            for (int i = 1; i < i_size - 1; ++i)
+                for (int j = 1; j < j_size - 1; ++j) {
+                    double sum = 0;
+                    for (int k = long_k_size - 1; k >= 0; --k) {
+                        sum += in_value(i, j, k, m);
+                        EXPECT_DOUBLE_EQ(view(i, j, k, m), sum) << i << " " << j << " " << k << " " << m;
+                    }
+                }
+    }
+
+    TEST(run_ensemble, single_member) { check_ensemble(1); }
+
+    TEST(run_ensemble, full_vectors) { check_ensemble(16); }
+
+    TEST(run_ensemble, remainder) { check_ensemble(11); }
+
+    TEST(run_ensemble, backward_k_cache) {
+        check_k_cached_ensemble(1);
+        check_k_cached_ensemble(11);
+    }
+} // namespace
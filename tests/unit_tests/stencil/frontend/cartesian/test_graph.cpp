@@ -0,0 +1,121 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct avg {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = .25 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1))) + 1;
+        }
+    };
+
+    struct add {
+        using lhs = in_accessor<0>;
+        using rhs = in_accessor<1>;
+        using out = inout_accessor<2>;
+        using param_list = make_param_list<lhs, rhs, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(lhs()) + eval(rhs());
+        }
+    };
+
+    using env_t = test_environment<2>::apply<stencil_backend_t, double, inlined_params<11, 9, 5>>;
+
+    auto a_init = [](int i, int j, int k) { return (i * 7 + j * 3 + k * 5) % 11; };
+    auto b_init = [](int i, int j, int k) { return (i * 5 + j * 11 + k * 3) % 7 * .5; };
+    auto c_init = [](int i, int j, int k) { return (i + j + k) % 3 * -1.; };
+
+    // the fields including their halos are compared: a graph may not write where the separate runs don't
+    void check(env_t::storage_type const &expected, env_t::storage_type const &actual) {
+        auto expected_view = expected->const_host_view();
+        auto actual_view = actual->const_host_view();
+        auto &&lengths = actual->lengths();
+        for (int i = 0; i < lengths[0]; ++i)
+            for (int j = 0; j < lengths[1]; ++j)
+                for (int k = 0; k < lengths[2]; ++k)
+                    ASSERT_DOUBLE_EQ(actual_view(i, j, k), expected_view(i, j, k)) << i << " " << j << " " << k;
+    }
+
+    template <class Graph>
+    void execute(Graph const &g) {
+        g.execute();
+    }
+
+    template <class Graph, class Comp, class... Comps>
+    void execute(Graph const &g, Comp comp, Comps... comps) {
+        execute(g.run(comp), comps...);
+    }
+
+    template <class... Comps>
+    void test(Comps... comps) {
+        auto a = env_t::make_storage(a_init);
+        auto b = env_t::make_storage(b_init);
+        auto c = env_t::make_storage(c_init);
+        auto d = env_t::make_storage(0.);
+        (run(comps, stencil_backend_t(), env_t::make_grid(), a, b, c, d), ...);
+
+        auto actual_a = env_t::make_storage(a_init);
+        auto actual_b = env_t::make_storage(b_init);
+        auto actual_c = env_t::make_storage(c_init);
+        auto actual_d = env_t::make_storage(0.);
+        execute(make_graph(stencil_backend_t(), env_t::make_grid(), actual_a, actual_b, actual_c, actual_d), comps...);
+        check(a, actual_a);
+        check(b, actual_b);
+        check(c, actual_c);
+        check(d, actual_d);
+    }
+
+    TEST(graph, empty) {
+        auto a = env_t::make_storage(a_init);
+        make_graph(stencil_backend_t(), env_t::make_grid(), a).execute();
+        check(env_t::make_storage(a_init), a);
+    }
+
+    TEST(graph, pointwise_chain) {
+        test([](auto a, auto b, auto c, auto) { return execute_parallel().stage(add(), a, b, c); },
+            [](auto a, auto, auto c, auto d) { return execute_parallel().stage(add(), c, a, d); },
+            [](auto, auto b, auto, auto d) { return execute_parallel().stage(add(), d, d, b); });
+    }
+
+    TEST(graph, read_at_offsets_after_write) {
+        test([](auto a, auto, auto c, auto) { return execute_parallel().stage(avg(), a, c); },
+            [](auto, auto, auto c, auto d) { return execute_parallel().stage(avg(), c, d); });
+    }
+
+    TEST(graph, write_after_read_at_offsets) {
+        test([](auto a, auto, auto, auto d) { return execute_parallel().stage(avg(), a, d); },
+            [](auto a, auto b, auto, auto) { return execute_parallel().stage(add(), b, b, a); });
+    }
+
+    TEST(graph, with_temporaries) {
+        auto comp = [](auto a, auto b, auto c, auto) {
+            GT_DECLARE_TMP(double, tmp);
+            return execute_parallel().stage(avg(), a, tmp).stage(add(), tmp, b, c);
+        };
+        test(comp, [](auto, auto b, auto c, auto d) { return execute_parallel().stage(add(), c, b, d); }, comp);
+    }
+} // namespace
@@ -0,0 +1,125 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct avg {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = .25 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1))) + 1;
+        }
+    };
+
+    struct down {
+        using in = in_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+            eval(out()) = eval(in()) + .5 * eval(in(0, 0, -1));
+        }
+    };
+
+    struct add {
+        using lhs = in_accessor<0>;
+        using rhs = in_accessor<1>;
+        using out = inout_accessor<2>;
+        using param_list = make_param_list<lhs, rhs, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(lhs()) + eval(rhs());
+        }
+    };
+
+    using env_t = test_environment<2>::apply<stencil_backend_t, double, inlined_params<9, 10, 6>>;
+
+    double in1(int i, int j, int k) { return (i * 7 + j * 3 + k * 5) % 11; }
+    double in2(int i, int j, int k) { return (i * 5 + j * 11 + k * 3) % 7; }
+
+    template <class F>
+    auto avg_ref(F f) {
+        return [f](int i, int j, int k) {
+            return .25 * (f(i + 1, j, k) + f(i - 1, j, k) + f(i, j + 1, k) + f(i, j - 1, k)) + 1;
+        };
+    }
+
+    template <class F>
+    auto down_ref(F f) {
+        return [f](int i, int j, int k) { return k == 0 ? f(i, j, k) : f(i, j, k) + .5 * f(i, j, k - 1); };
+    }
+
+    // the first and the second pass are independent tracer updates, the third one depends on the first one only
+    TEST(independent_passes, tracers) {
+        auto out1 = env_t::make_storage();
+        auto out2 = env_t::make_storage();
+        auto out3 = env_t::make_storage();
+        run(
+            [](auto in1, auto in2, auto out1, auto out2, auto out3) {
+                GT_DECLARE_TMP(double, a, b);
+                return multi_pass(execute_forward().stage(down(), in1, a).stage(avg(), a, out1),
+                    execute_forward().stage(down(), in2, b).stage(avg(), b, out2),
+                    execute_parallel().stage(add(), out1, in1, out3));
+            },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            env_t::make_storage(in1),
+            env_t::make_storage(in2),
+            out1,
+            out2,
+            out3);
+        auto out1_ref = avg_ref(down_ref(in1));
+        env_t::verify(out1_ref, out1);
+        env_t::verify(avg_ref(down_ref(in2)), out2);
+        env_t::verify([&](int i, int j, int k) { return out1_ref(i, j, k) + in1(i, j, k); }, out3);
+    }
+
+    // a pass that writes a field that an earlier pass reads is not independent of it
+    TEST(independent_passes, write_after_read) {
+        auto field = env_t::make_storage(in1);
+        auto out1 = env_t::make_storage();
+        auto out2 = env_t::make_storage();
+        run(
+            [](auto field, auto in2, auto out1, auto out2) {
+                return multi_pass(execute_parallel().stage(add(), field, field, out1),
+                    execute_parallel().stage(add(), in2, in2, field),
+                    execute_parallel().stage(avg(), in2, out2));
+            },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            field,
+            env_t::make_storage(in2),
+            out1,
+            out2);
+        env_t::verify([](int i, int j, int k) { return 2 * in1(i, j, k); }, out1);
+        env_t::verify([](int i, int j, int k) { return 2 * in2(i, j, k); }, field);
+        env_t::verify(avg_ref(in2), out2);
+    }
+} // namespace
@@ -0,0 +1,112 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct scale {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = 2 * eval(in()) + 1;
+        }
+    };
+
+    struct diff {
+        using in = in_accessor<0, extent<-1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in(1, 0)) - eval(in(-1, 0)) + eval(in());
+        }
+    };
+
+    struct accumulate {
+        using in = in_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+            eval(out()) = eval(in()) + eval(in(0, 0, -1));
+        }
+    };
+
+    using env_t = test_environment<2>::apply<stencil_backend_t, double, inlined_params<13, 9, 7>>;
+
+    double in(int i, int j, int k) { return (i * 5 + j * 3 + k * 7) % 13; }
+
+    auto scale_ref = [](auto f) { return [f](int i, int j, int k) { return 2 * f(i, j, k) + 1; }; };
+
+    auto diff_ref = [](auto f) {
+        return [f](int i, int j, int k) { return f(i + 1, j, k) - f(i - 1, j, k) + f(i, j, k); };
+    };
+
+    // `a` is produced and consumed at the same point within the same fused stage, `b` is read with an offset
+    TEST(inlined_tmp, parallel) {
+        auto out = env_t::make_storage();
+        run(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, a, b);
+                return execute_parallel().stage(scale(), in, a).stage(scale(), a, b).stage(diff(), b, out);
+            },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            env_t::make_storage(in),
+            out);
+        env_t::verify(diff_ref(scale_ref(scale_ref(in))), out);
+    }
+
+    // the chain of inlined temporaries is consumed with a vertical offset
+    TEST(inlined_tmp, forward) {
+        auto out = env_t::make_storage();
+        run(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, a, b, c);
+                return execute_forward()
+                    .stage(scale(), in, a)
+                    .stage(scale(), a, b)
+                    .stage(accumulate(), b, c)
+                    .stage(scale(), c, out);
+            },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            env_t::make_storage(in),
+            out);
+        auto b = scale_ref(scale_ref(in));
+        env_t::verify(
+            [&](int i, int j, int k) {
+                double c = 0;
+                for (int kk = 0; kk <= k; ++kk)
+                    c = kk == 0 ? b(i, j, kk) : b(i, j, kk) + b(i, j, kk - 1);
+                return 2 * c + 1;
+            },
+            out);
+    }
+} // namespace
@@ -0,0 +1,183 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    using axis_t = axis<2>;
+    using kfull = axis_t::full_interval;
+
+    double in(int i, int j, int k) { return i + 10 * j + 100 * k + 1; }
+
+    // a narrow horizontal domain: the k-axis has to be split to keep the threads busy
+    GT_ENVIRONMENT_TEST_SUITE(test_kblocked,
+        (vertical_test_environment<0, axis_t>),
+        stencil_backend_t,
+        (double, inlined_params<3, 2, 7, 12>));
+
+    struct copy {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis_t::get_interval<0>) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis_t::get_interval<1>) {
+            eval(out()) = 2 * eval(in());
+        }
+    };
+
+    struct smooth {
+        using in = in_accessor<0, extent<0, 0, 0, 0, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+            eval(out()) = eval(in()) + eval(in(0, 0, 1));
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, -1>) {
+            eval(out()) = eval(in(0, 0, -1)) + eval(in()) + eval(in(0, 0, 1));
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::last_level) {
+            eval(out()) = eval(in(0, 0, -1)) + eval(in());
+        }
+    };
+
+    struct accumulate {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+            eval(out()) = eval(out(0, 0, -1)) + eval(in());
+        }
+    };
+
+    struct add {
+        using lhs = in_accessor<0>;
+        using rhs = in_accessor<1>;
+        using out = inout_accessor<2>;
+        using param_list = make_param_list<lhs, rhs, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(lhs()) + eval(rhs());
+        }
+    };
+
+    template <class Env>
+    auto smoothed(int i, int j, int k) {
+        auto tmp = [&](int k) { return (k < 7 ? 1 : 2) * in(i, j, k); };
+        double res = tmp(k);
+        if (k > 0)
+            res += tmp(k - 1);
+        if (k < Env::k_size() - 1)
+            res += tmp(k + 1);
+        return res;
+    }
+
+    GT_ENVIRONMENT_TYPED_TEST(test_kblocked, temporary_at_k_offsets) {
+        auto out = TypeParam::make_storage();
+        run(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, tmp);
+                return multi_pass(
+                    execute_parallel().stage(copy(), in, tmp), execute_parallel().stage(smooth(), tmp, out));
+            },
+            stencil_backend_t(),
+            TypeParam::make_grid(),
+            TypeParam::make_storage(in),
+            out);
+        TypeParam::verify(smoothed<TypeParam>, out);
+    }
+
+    GT_ENVIRONMENT_TYPED_TEST(test_kblocked, chained_temporaries) {
+        auto out = TypeParam::make_storage();
+        run(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, tmp1);
+                GT_DECLARE_TMP(double, tmp2);
+                return multi_pass(execute_parallel().stage(copy(), in, tmp1),
+                    execute_parallel().stage(smooth(), tmp1, tmp2),
+                    execute_parallel().stage(smooth(), tmp2, out));
+            },
+            stencil_backend_t(),
+            TypeParam::make_grid(),
+            TypeParam::make_storage(in),
+            out);
+        auto ref = TypeParam::make_storage();
+        auto refv = ref->host_view();
+        for (int i = 0; i < TypeParam::d(0); ++i)
+            for (int j = 0; j < TypeParam::d(1); ++j)
+                for (int k = 0; k < TypeParam::k_size(); ++k) {
+                    refv(i, j, k) = smoothed<TypeParam>(i, j, k);
+                    if (k > 0)
+                        refv(i, j, k) += smoothed<TypeParam>(i, j, k - 1);
+                    if (k < TypeParam::k_size() - 1)
+                        refv(i, j, k) += smoothed<TypeParam>(i, j, k + 1);
+                }
+        TypeParam::verify(ref, out);
+    }
+
+    GT_ENVIRONMENT_TYPED_TEST(test_kblocked, parallel_and_forward_passes) {
+        auto mid = TypeParam::make_storage();
+        auto acc = TypeParam::make_storage();
+        auto out = TypeParam::make_storage();
+        run(
+            [](auto in, auto mid, auto acc, auto out) {
+                GT_DECLARE_TMP(double, tmp);
+                return multi_pass(execute_parallel().stage(copy(), in, tmp),
+                    execute_parallel().stage(smooth(), tmp, mid),
+                    execute_forward().stage(accumulate(), mid, acc),
+                    execute_parallel().stage(add(), acc, mid, out));
+            },
+            stencil_backend_t(),
+            TypeParam::make_grid(),
+            TypeParam::make_storage(in),
+            mid,
+            acc,
+            out);
+        auto ref = TypeParam::make_storage();
+        auto refv = ref->host_view();
+        for (int i = 0; i < TypeParam::d(0); ++i)
+            for (int j = 0; j < TypeParam::d(1); ++j) {
+                double sum = 0;
+                for (int k = 0; k < TypeParam::k_size(); ++k) {
+                    sum += smoothed<TypeParam>(i, j, k);
+                    refv(i, j, k) = sum + smoothed<TypeParam>(i, j, k);
+                }
+            }
+        TypeParam::verify(ref, out);
+    }
+} // namespace
@@ -0,0 +1,174 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/reduction/functions.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/reduction_output.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/sid.hpp>
+
+#include <stencil_select.hpp>
+#include <storage_select.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    constexpr int i_size = 13;
+    constexpr int j_size = 9;
+    constexpr int k_size = 7;
+
+    struct square {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in()) * eval(in());
+        }
+    };
+
+    struct lap {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = 4 * eval(in()) - (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1)));
+        }
+    };
+
+    struct copy {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in());
+        }
+    };
+
+    struct average {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1))) / 4;
+        }
+    };
+
+    double in_value(int i, int j, int k) { return (i * 7 + j * 3 + k * 5) % 11 - 5; }
+
+    double lap_value(int i, int j, int k) {
+        return 4 * in_value(i, j, k) -
+               (in_value(i + 1, j, k) + in_value(i - 1, j, k) + in_value(i, j + 1, k) + in_value(i, j - 1, k));
+    }
+
+    auto make_grid() {
+        return stencil::make_grid(
+            halo_descriptor(1, 1, 1, i_size - 2, i_size), halo_descriptor(1, 1, 1, j_size - 2, j_size), k_size);
+    }
+
+    auto make_in() {
+        return storage::builder<storage_traits_t>.type<double>().dimensions(i_size, j_size, k_size).initializer(
+            in_value)();
+    }
+
+    template <class F>
+    double reference(double res, F f) {
+        for (int i = 1; i < i_size - 1; ++i)
+            for (int j = 1; j < j_size - 1; ++j)
+                for (int k = 0; k < k_size; ++k)
+                    res = f(res, i, j, k);
+        return res;
+    }
+
+    TEST(reduction_output, sum) {
+        reduction_output<double> sum(0);
+        run(
+            [](auto in, auto sum) { return execute_parallel().stage(square(), in, sum); },
+            stencil_backend_t(),
+            make_grid(),
+            make_in(),
+            sum);
+        double expected =
+            reference(0, [](double acc, int i, int j, int k) { return acc + in_value(i, j, k) * in_value(i, j, k); });
+        EXPECT_DOUBLE_EQ(expected, sum.result());
+    }
+
+    TEST(reduction_output, max_of_temporary) {
+        reduction_output max(-1e10, reduction::max());
+        auto out = storage::builder<storage_traits_t>.type<double>().dimensions(i_size, j_size, k_size)();
+        run(
+            [](auto in, auto out, auto max) {
+                GT_DECLARE_TMP(double, tmp);
+                return execute_parallel().stage(lap(), in, tmp).stage(copy(), tmp, out).stage(copy(), tmp, max);
+            },
+            stencil_backend_t(),
+            make_grid(),
+            make_in(),
+            out,
+            max);
+        double expected = reference(-1e10, [](double acc, int i, int j, int k) {
+            return std::max(acc, lap_value(i, j, k));
+        });
+        EXPECT_EQ(expected, max.result());
+        auto view = out->const_host_view();
+        for (int i = 1; i < i_size - 1; ++i)
+            for (int j = 1; j < j_size - 1; ++j)
+                for (int k = 0; k < k_size; ++k)
+                    EXPECT_EQ(view(i, j, k), lap_value(i, j, k));
+    }
+
+    TEST(reduction_output, accumulate_and_reset) {
+        reduction_output<int, reduction::plus> count(0);
+        auto comp = [](auto in, auto count) { return execute_forward().stage(copy(), in, count); };
+        auto ones = storage::builder<storage_traits_t>.type<int>().dimensions(i_size, j_size, k_size).value(1)();
+        run(comp, stencil_backend_t(), make_grid(), ones, count);
+        run(comp, stencil_backend_t(), make_grid(), ones, count);
+        EXPECT_EQ(2 * (i_size - 2) * (j_size - 2) * k_size, count.result());
+        count.reset();
+        EXPECT_EQ(0, count.result());
+        run(comp, stencil_backend_t(), make_grid(), ones, count);
+        EXPECT_EQ((i_size - 2) * (j_size - 2) * k_size, count.result());
+    }
+
+    // the stages in front of the one that writes the reduction output run on the halo and on the overlap of the blocks
+    TEST(reduction_output, count_after_stages_with_extent) {
+        constexpr int ni = 52;
+        constexpr int nj = 41;
+        reduction_output<int, reduction::plus> count(0);
+        auto ones = storage::builder<storage_traits_t>.type<int>().dimensions(ni, nj, k_size).value(1)();
+        run(
+            [](auto in, auto count) {
+                GT_DECLARE_TMP(int, tmp, avg);
+                return execute_parallel()
+                    .stage(copy(), in, tmp)
+                    .stage(average(), tmp, avg)
+                    .stage(copy(), avg, count);
+            },
+            stencil_backend_t(),
+            stencil::make_grid(halo_descriptor(2, 2, 2, ni - 3, ni), halo_descriptor(2, 2, 2, nj - 3, nj), k_size),
+            ones,
+            count);
+        EXPECT_EQ((ni - 4) * (nj - 4) * k_size, count.result());
+    }
+} // namespace
@@ -0,0 +1,122 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/sid.hpp>
+
+#include <stencil_select.hpp>
+#include <storage_select.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct copy {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in());
+        }
+    };
+
+    struct avg {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = .25 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1)));
+        }
+    };
+
+    struct sum_up {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+            eval(out()) = eval(out(0, 0, -1)) + eval(in());
+        }
+    };
+
+    auto in_value(int m) {
+        return [m](int i, int j, int k) { return (i * 7 + j * 3 + k * 5 + m) % 11; };
+    }
+
+    auto make_storage(int i_size, int j_size, int k_size) {
+        return storage::builder<storage_traits_t>.type<double>().dimensions(i_size, j_size, k_size);
+    }
+
+    auto make_member(int m) {
+        int i_size = 5 + m % 4;
+        int j_size = 4 + m % 3;
+        int k_size = 3 + m % 5;
+        auto builder = make_storage(i_size, j_size, k_size);
+        return std::make_tuple(make_grid(halo_descriptor(1, 1, 1, i_size - 2, i_size),
+                                   halo_descriptor(1, 1, 1, j_size - 2, j_size),
+                                   k_size),
+            builder.initializer(in_value(m)).build(),
+            builder.build());
+    }
+
+    auto comp = [](auto in, auto out) {
+        GT_DECLARE_TMP(double, tmp, smoothed);
+        return multi_pass(execute_parallel().stage(copy(), in, tmp).stage(avg(), tmp, smoothed),
+            execute_forward().stage(sum_up(), smoothed, out));
+    };
+
+    template <class Member>
+    void verify(int m, Member const &member) {
+        auto const &out = std::get<2>(member);
+        auto view = out->const_host_view();
+        auto f = in_value(m);
+        auto &&lengths = out->lengths();
+        for (int i = 1; i < lengths[0] - 1; ++i)
+            for (int j = 1; j < lengths[1] - 1; ++j) {
+                double sum = 0;
+                for (int k = 0; k < lengths[2]; ++k) {
+                    sum += .25 * (f(i + 1, j, k) + f(i - 1, j, k) + f(i, j + 1, k) + f(i, j - 1, k));
+                    EXPECT_DOUBLE_EQ(view(i, j, k), sum) << "member " << m << " at " << i << " " << j << " " << k;
+                }
+            }
+    }
+
+    void run_members(int n) {
+        std::vector<decltype(make_member(0))> members;
+        for (int m = 0; m < n; ++m)
+            members.push_back(make_member(m));
+        run_batch(comp, stencil_backend_t(), members);
+        for (int m = 0; m < n; ++m)
+            verify(m, members[m]);
+    }
+
+    TEST(run_batch, few_members) { run_members(2); }
+
+    TEST(run_batch, many_members) { run_members(37); }
+
+    TEST(run_batch, empty) { run_members(0); }
+} // namespace
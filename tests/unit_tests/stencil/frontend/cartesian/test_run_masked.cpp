@@ -0,0 +1,140 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/sid.hpp>
+
+#include <stencil_select.hpp>
+#include <storage_select.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    constexpr int halo = 1;
+    constexpr int i_size = 100;
+    constexpr int j_size = 40;
+    constexpr int k_size = 3;
+
+    struct copy {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in());
+        }
+    };
+
+    struct avg {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = .25 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1)));
+        }
+    };
+
+    double in_value(int i, int j, int k) { return (i * 7 + j * 3 + k * 5) % 11; }
+
+    double expected(int i, int j, int k) {
+        return .25 * (in_value(i + 1, j, k) + in_value(i - 1, j, k) + in_value(i, j + 1, k) + in_value(i, j - 1, k));
+    }
+
+    auto make_grid() {
+        return stencil::make_grid(halo_descriptor(halo, halo, halo, i_size - halo - 1, i_size),
+            halo_descriptor(halo, halo, halo, j_size - halo - 1, j_size),
+            k_size);
+    }
+
+    constexpr int ni = i_size - 2 * halo;
+    constexpr int nj = j_size - 2 * halo;
+
+    auto builder = storage::builder<storage_traits_t>.type<double>().dimensions(i_size, j_size, k_size);
+
+    template <class Active>
+    auto run_with_mask(activity_mask const &mask) {
+        auto out = builder.value(-1).build();
+        run_masked(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, tmp);
+                return execute_parallel().stage(copy(), in, tmp).stage(avg(), tmp, out);
+            },
+            stencil_backend_t(),
+            make_grid(),
+            mask,
+            builder.initializer(in_value).build(),
+            out);
+        auto view = out->const_host_view();
+        for (int i = 0; i < ni; ++i)
+            for (int j = 0; j < nj; ++j)
+                if (Active()(i, j)) {
+                    for (int k = 0; k < k_size; ++k)
+                        EXPECT_EQ(view(i + halo, j + halo, k), expected(i + halo, j + halo, k)) << i << " " << j;
+                }
+        return out;
+    }
+
+    struct ocean {
+        bool operator()(int i, int j) const { return (i - 20) * (i - 20) + (j - 19) * (j - 19) < 100; }
+    };
+
+    struct strip {
+        bool operator()(int i, int) const { return i < 3; }
+    };
+
+    struct none {
+        bool operator()(int, int) const { return false; }
+    };
+
+    TEST(activity_mask, count) {
+        activity_mask mask(10, 6, {{2, 5, 1, 3}, {4, 7, 2, 4}});
+        EXPECT_EQ(mask.count({0, 10, 0, 6}), 6 + 6 - 1);
+        EXPECT_EQ(mask.count({4, 5, 2, 3}), 1);
+        EXPECT_EQ(mask.count({-3, 3, -3, 2}), 1);
+        EXPECT_TRUE(mask.any({6, 20, 3, 20}));
+        EXPECT_FALSE(mask.any({7, 20, 0, 20}));
+        EXPECT_FALSE(mask.any({0, 10, 4, 6}));
+    }
+
+    TEST(run_masked, predicate) { run_with_mask<ocean>(activity_mask(ni, nj, ocean())); }
+
+    TEST(run_masked, regions) {
+        auto out = run_with_mask<strip>(activity_mask(ni, nj, {{0, 3, 0, nj}}));
+#if defined(GT_STENCIL_CPU_KFIRST) || defined(GT_STENCIL_CPU_IFIRST)
+        // the blocks far from the strip are skipped
+        auto view = out->const_host_view();
+        for (int i = 64; i < ni; ++i)
+            for (int j = 0; j < nj; ++j)
+                for (int k = 0; k < k_size; ++k)
+                    EXPECT_EQ(view(i + halo, j + halo, k), -1) << i << " " << j;
+#endif
+    }
+
+    TEST(run_masked, empty) {
+        auto out = run_with_mask<none>(activity_mask(ni, nj, none()));
+#if defined(GT_STENCIL_CPU_KFIRST) || defined(GT_STENCIL_CPU_IFIRST)
+        auto view = out->const_host_view();
+        for (int i = 0; i < ni; ++i)
+            for (int j = 0; j < nj; ++j)
+                for (int k = 0; k < k_size; ++k)
+                    EXPECT_EQ(view(i + halo, j + halo, k), -1) << i << " " << j;
+#endif
+    }
+} // namespace
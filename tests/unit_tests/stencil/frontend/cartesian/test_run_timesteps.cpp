@@ -0,0 +1,135 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/global_parameter.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    struct smooth {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using weight = in_accessor<2>;
+        using param_list = make_param_list<in, out, weight>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in()) + eval(weight()) * (eval(in(1, 0)) + eval(in(0, 1)) + eval(in(-1, 0)) +
+                                                            eval(in(0, -1)) - 4 * eval(in()));
+        }
+    };
+
+    struct advect {
+        using in = in_accessor<0, extent<0, 1, -1, 0, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+            eval(out()) = .5 * eval(in(1, 0, 0)) + .25 * eval(in(0, -1, 0)) + .25 * eval(in(0, 0, 1));
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, -1>) {
+            eval(out()) = .5 * eval(in(1, 0, 0)) + .25 * eval(in(0, -1, 0)) +
+                          .125 * (eval(in(0, 0, 1)) + eval(in(0, 0, -1)));
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::last_level) {
+            eval(out()) = .5 * eval(in(1, 0, 0)) + .25 * eval(in(0, -1, 0)) + .25 * eval(in(0, 0, -1));
+        }
+    };
+
+    using env_t = test_environment<3>::apply<stencil_backend_t, double, inlined_params<13, 11, 5>>;
+
+    template <class Comp, class... Params>
+    void test(Comp comp, Params... params) {
+        auto init_current = [](int i, int j, int k) { return (i * 7 + j * 5 + k * 3) % 11 * .1; };
+        auto init_next = [](int i, int j, int k) { return (i * 3 + j * 7 + k) % 13 * -.1; };
+        temporal_blocking blockings[] = {{}, {3, 4, 3}, {5, 5, 2}, {4, 1, 1}, {7, 2, 6}};
+        for (int steps : {0, 1, 2, 3, 4, 5, 8}) {
+            auto expected_current = env_t::make_storage(init_current);
+            auto expected_next = env_t::make_storage(init_next);
+            for (int step = 0; step != steps; ++step) {
+                if (step % 2)
+                    run(comp, stencil_backend_t(), env_t::make_grid(), expected_next, expected_current, params...);
+                else
+                    run(comp, stencil_backend_t(), env_t::make_grid(), expected_current, expected_next, params...);
+            }
+            for (auto &&blocking : blockings) {
+                auto current = env_t::make_storage(init_current);
+                auto next = env_t::make_storage(init_next);
+                run_timesteps(blocking, steps, comp, stencil_backend_t(), env_t::make_grid(), current, next, params...);
+                auto check = [](auto const &expected, auto const &actual) {
+                    auto expected_view = expected->const_host_view();
+                    auto actual_view = actual->const_host_view();
+                    auto &&lengths = actual->lengths();
+                    for (int i = 0; i < lengths[0]; ++i)
+                        for (int j = 0; j < lengths[1]; ++j)
+                            for (int k = 0; k < lengths[2]; ++k)
+                                ASSERT_DOUBLE_EQ(actual_view(i, j, k), expected_view(i, j, k))
+                                    << i << " " << j << " " << k;
+                };
+                check(expected_current, current);
+                check(expected_next, next);
+            }
+        }
+    }
+
+    TEST(run_timesteps, smooth) {
+        test([](auto in, auto out, auto weight) { return execute_parallel().stage(smooth(), in, out, weight); },
+            global_parameter(.1));
+    }
+
+    TEST(run_timesteps, with_temporary) {
+        test(
+            [](auto in, auto out, auto weight) {
+                GT_DECLARE_TMP(double, tmp);
+                return execute_parallel().stage(smooth(), in, tmp, weight).stage(smooth(), tmp, out, weight);
+            },
+            global_parameter(.2));
+    }
+
+    TEST(run_timesteps, asymmetric_extent) {
+        test([](auto in, auto out) { return execute_parallel().stage(advect(), in, out); });
+    }
+
+    TEST(run_timesteps, default_blocking) {
+        auto init = [](int i, int j, int k) { return i + j * .1 + k * .01; };
+        auto expected_current = env_t::make_storage(init);
+        auto expected_next = env_t::make_storage(0.);
+        for (int step = 0; step != 9; ++step) {
+            if (step % 2)
+                run_single_stage(advect(), stencil_backend_t(), env_t::make_grid(), expected_next, expected_current);
+            else
+                run_single_stage(advect(), stencil_backend_t(), env_t::make_grid(), expected_current, expected_next);
+        }
+        auto current = env_t::make_storage(init);
+        auto next = env_t::make_storage(0.);
+        run_timesteps(
+            9,
+            [](auto in, auto out) { return execute_parallel().stage(advect(), in, out); },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            current,
+            next);
+        env_t::verify(expected_next, next);
+        env_t::verify(expected_current, current);
+    }
+} // namespace
@@ -0,0 +1,102 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+
+#include <stencil_select.hpp>
+#include <test_environment.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    // the temporaries of the chains below are dead after the next stage, thus they share storage in the backends
+    // that alias temporaries
+    struct avg {
+        using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = .25 * (eval(in(1, 0)) + eval(in(-1, 0)) + eval(in(0, 1)) + eval(in(0, -1))) + 1;
+        }
+    };
+
+    struct down {
+        using in = in_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+            eval(out()) = eval(in()) + .5 * eval(in(0, 0, -1));
+        }
+    };
+
+    using env_t = test_environment<4>::apply<stencil_backend_t, double, inlined_params<9, 10, 6>>;
+
+    double in(int i, int j, int k) { return (i * 7 + j * 3 + k * 5) % 11; }
+
+    template <class F>
+    auto avg_ref(F f) {
+        return [f](int i, int j, int k) {
+            return .25 * (f(i + 1, j, k) + f(i - 1, j, k) + f(i, j + 1, k) + f(i, j - 1, k)) + 1;
+        };
+    }
+
+    template <class F>
+    auto down_ref(F f) {
+        return [f](int i, int j, int k) { return k == 0 ? f(i, j, k) : f(i, j, k) + .5 * f(i, j, k - 1); };
+    }
+
+    TEST(tmp_aliasing, parallel_chain) {
+        auto out = env_t::make_storage();
+        run(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, a, b, c);
+                return execute_parallel()
+                    .stage(avg(), in, a)
+                    .stage(avg(), a, b)
+                    .stage(avg(), b, c)
+                    .stage(avg(), c, out);
+            },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            env_t::make_storage(in),
+            out);
+        env_t::verify(avg_ref(avg_ref(avg_ref(avg_ref(in)))), out);
+    }
+
+    TEST(tmp_aliasing, forward_chain) {
+        auto out = env_t::make_storage();
+        run(
+            [](auto in, auto out) {
+                GT_DECLARE_TMP(double, a, b, c, d);
+                return multi_pass(execute_forward().stage(down(), in, a).stage(down(), a, b),
+                    execute_parallel().stage(avg(), b, c),
+                    execute_forward().stage(down(), c, d),
+                    execute_backward().stage(avg(), d, out));
+            },
+            stencil_backend_t(),
+            env_t::make_grid(),
+            env_t::make_storage(in),
+            out);
+        env_t::verify(avg_ref(down_ref(avg_ref(down_ref(down_ref(in))))), out);
+    }
+} // namespace
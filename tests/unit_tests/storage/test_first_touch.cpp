@@ -0,0 +1,86 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/storage/first_touch.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cpu_ifirst/execinfo.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/thread_pool/omp.hpp>
+
+namespace gridtools {
+    namespace storage {
+        namespace {
+            struct grid {
+                int_t m_i_size, m_j_size;
+                int_t i_size() const { return m_i_size; }
+                int_t j_size() const { return m_j_size; }
+            };
+
+            class first_touch : public testing::TestWithParam<int> {
+#ifdef _OPENMP
+                int m_threads;
+
+              protected:
+                void SetUp() override {
+                    m_threads = omp_get_max_threads();
+                    omp_set_num_threads(GetParam());
+                }
+                void TearDown() override { omp_set_num_threads(m_threads); }
+#endif
+            };
+
+            TEST_P(first_touch, matches_cpu_ifirst_blocks) {
+                int i_halo = 3, j_halo = 2;
+                auto ds = builder<cpu_ifirst>.type<int>().dimensions(37, 23, 5).halos(i_halo, j_halo, 0).build();
+                using layout_t = typename std::remove_reference_t<decltype(*ds)>::layout_t;
+                auto &&info = ds->info();
+
+                std::vector<std::atomic<int>> visits(info.length());
+                std::vector<int> threads(info.length(), -1);
+                blocked_for_each(layout_t(), info, array<int, 3>{i_halo, j_halo, 0}, [&](auto const &indices) {
+                    auto index = info.index_from_tuple(indices);
+                    ++visits[index];
+                    threads[index] = thread_pool::get_thread_num(thread_pool::omp());
+                });
+
+                grid compute_domain = {37 - 2 * i_halo, 23 - 2 * j_halo};
+                stencil::cpu_ifirst_backend::execinfo execinfo{thread_pool::omp(), compute_domain};
+                std::vector<int> block_threads(execinfo.i_blocks() * execinfo.j_blocks());
+                thread_pool::parallel_for_loop(
+                    thread_pool::omp(),
+                    [&](auto i, auto j) {
+                        block_threads[i + execinfo.i_blocks() * j] = thread_pool::get_thread_num(thread_pool::omp());
+                    },
+                    execinfo.i_blocks(),
+                    execinfo.j_blocks());
+
+                for (int i = 0; i < 37; ++i)
+                    for (int j = 0; j < 23; ++j)
+                        for (int k = 0; k < 5; ++k) {
+                            auto index = info.index(i, j, k);
+                            EXPECT_EQ(visits[index], 1);
+                            int i_block =
+                                std::clamp((i - i_halo) / execinfo.i_block_size(), 0, execinfo.i_blocks() - 1);
+                            int j_block =
+                                std::clamp((j - j_halo) / execinfo.j_block_size(), 0, execinfo.j_blocks() - 1);
+                            EXPECT_EQ(threads[index], block_threads[i_block + execinfo.i_blocks() * j_block]);
+                        }
+            }
+
+            INSTANTIATE_TEST_SUITE_P(threads, first_touch, testing::Values(1, 3, 4, 16));
+        } // namespace
+    }     // namespace storage
+} // namespace gridtools
@@ -64,6 +64,24 @@ TEST(StorageFacility, ViewTests) {
                 EXPECT_EQ(hrv(i, j, k), 2 * z++);
 }
 
+TEST(StorageFacility, Ensemble) {
+    auto ds = builder.dimensions(3, 4, 5)
+                  .ensemble(6)
+                  .initializer([](int i, int j, int k, int m) { return i + 10 * j + 100 * k + 1000 * m; })
+                  .build();
+    using layout_t = typename decltype(ds)::element_type::layout_t;
+    static_assert(std::is_same_v<layout_t, append_innermost<storage::traits::layout_type<storage_traits_t, 3>>>);
+    EXPECT_EQ(ds->lengths()[3], 6);
+    EXPECT_EQ(ds->strides()[3], 1);
+
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 4; ++j)
+            for (int k = 0; k < 5; ++k)
+                for (int m = 0; m < 6; ++m)
+                    EXPECT_EQ(view(i, j, k, m), i + 10 * j + 100 * k + 1000 * m);
+}
+
 template <int... Args>
 static constexpr bool expect_layout =
     std::is_same_v<typename decltype(builder.dimensions(Args...)())::element_type::layout_t, layout_map<Args...>>;
@@ -82,6 +100,14 @@ static_assert(expect_custom_layout<2, 1, 0>);
 static_assert(expect_custom_layout<1, 0>);
 static_assert(expect_custom_layout<2, -1, 1, 0>);
 
+template <class Layout, int... Args>
+static constexpr bool expect_ensemble_layout = std::is_same_v<
+    typename decltype(builder.layout<Args...>().dimensions(Args...).ensemble(3)())::element_type::layout_t,
+    Layout>;
+
+static_assert(expect_ensemble_layout<layout_map<0, 1, 2, 3>, 0, 1, 2>);
+static_assert(expect_ensemble_layout<layout_map<2, -1, 1, 0, 3>, 2, -1, 1, 0>);
+
 #if defined(GT_STORAGE_CPU_KFIRST)
 
 static_assert(expect_layout<0>);
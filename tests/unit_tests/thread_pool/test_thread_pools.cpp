@@ -0,0 +1,152 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2023, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/thread_pool/concept.hpp>
+#include <gridtools/thread_pool/dummy.hpp>
+#include <gridtools/thread_pool/native.hpp>
+#include <gridtools/thread_pool/omp.hpp>
+#include <gridtools/thread_pool/work_stealing.hpp>
+
+namespace gridtools {
+    namespace thread_pool {
+        namespace {
+            template <class ThreadPool>
+            struct thread_pools : testing::Test {};
+
+            using pools_t = testing::Types<dummy,
+#ifdef _OPENMP
+                omp,
+                omp_dynamic<>,
+                omp_dynamic<3>,
+#endif
+                work_stealing,
+                native>;
+
+            TYPED_TEST_SUITE(thread_pools, pools_t);
+
+            template <class ThreadPool>
+            void check_thread_num() {
+                auto thread_num = get_thread_num(ThreadPool());
+                EXPECT_GE(thread_num, 0);
+                EXPECT_LT(thread_num, get_max_threads(ThreadPool()));
+            }
+
+            TYPED_TEST(thread_pools, loop_1d) {
+                std::vector<std::atomic<int>> visited(1001);
+                parallel_for_loop(
+                    TypeParam(),
+                    [&](auto i) {
+                        check_thread_num<TypeParam>();
+                        ++visited[i];
+                    },
+                    1001);
+                for (auto &&v : visited)
+                    EXPECT_EQ(v, 1);
+            }
+
+            TYPED_TEST(thread_pools, loop_2d) {
+                std::vector<std::atomic<int>> visited(13 * 11);
+                parallel_for_loop(
+                    TypeParam(),
+                    [&](auto i, auto j) {
+                        check_thread_num<TypeParam>();
+                        ++visited[i + 13 * j];
+                    },
+                    13,
+                    11);
+                for (auto &&v : visited)
+                    EXPECT_EQ(v, 1);
+            }
+
+            TYPED_TEST(thread_pools, loop_3d) {
+                std::vector<std::atomic<int>> visited(7 * 5 * 3);
+                parallel_for_loop(
+                    TypeParam(),
+                    [&](auto i, auto j, auto k) {
+                        check_thread_num<TypeParam>();
+                        ++visited[i + 7 * (j + 5 * k)];
+                    },
+                    7,
+                    5,
+                    3);
+                for (auto &&v : visited)
+                    EXPECT_EQ(v, 1);
+            }
+
+            TYPED_TEST(thread_pools, repeated_and_empty_loops) {
+                std::atomic<int> count(0);
+                for (int n = 0; n < 100; ++n)
+                    parallel_for_loop(
+                        TypeParam(), [&](auto) { ++count; }, n % 7);
+                int expected = 0;
+                for (int n = 0; n < 100; ++n)
+                    expected += n % 7;
+                EXPECT_EQ(count, expected);
+            }
+
+            TYPED_TEST(thread_pools, nested_loops) {
+                std::atomic<int> count(0);
+                parallel_for_loop(
+                    TypeParam(),
+                    [&](auto) {
+                        parallel_for_loop(
+                            TypeParam(), [&](auto) { ++count; }, 10);
+                    },
+                    10);
+                EXPECT_EQ(count, 100);
+            }
+
+            template <class ThreadPool>
+            struct persistent_thread_pools : testing::Test {};
+
+            using persistent_pools_t = testing::Types<work_stealing, native>;
+
+            TYPED_TEST_SUITE(persistent_thread_pools, persistent_pools_t);
+
+            TYPED_TEST(persistent_thread_pools, concurrent_callers_get_distinct_indices) {
+                std::vector<std::atomic<int>> busy(get_max_threads(TypeParam()));
+                auto loop = [&] {
+                    for (int n = 0; n < 20; ++n)
+                        parallel_for_loop(
+                            TypeParam(),
+                            [&](auto) {
+                                int t = get_thread_num(TypeParam());
+                                EXPECT_EQ(busy[t].fetch_add(1), 0);
+                                std::this_thread::yield();
+                                --busy[t];
+                            },
+                            50);
+                };
+                std::vector<std::thread> callers;
+                for (int n = 0; n < 4; ++n)
+                    callers.emplace_back(loop);
+                for (auto &caller : callers)
+                    caller.join();
+            }
+
+            TYPED_TEST(persistent_thread_pools, nested_loops_keep_index) {
+                parallel_for_loop(
+                    TypeParam(),
+                    [&](auto) {
+                        int t = get_thread_num(TypeParam());
+                        parallel_for_loop(
+                            TypeParam(), [&](auto) { EXPECT_EQ(get_thread_num(TypeParam()), t); }, 10);
+                    },
+                    10);
+            }
+        } // namespace
+    }     // namespace thread_pool
+} // namespace gridtools